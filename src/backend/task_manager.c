@@ -1,16 +1,391 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <dirent.h>
 #include <ctype.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/statvfs.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/file.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <linux/taskstats.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/tcp.h>
 
-#define TABLE_SIZE 1024
-#define MAX_PROCESSES 1024
+#define TABLE_INITIAL_SIZE 1024                      // must be a power of two
+#define ARENA_INITIAL_SIZE 4096
 #define MAX_GPUS 8
+#define MAX_GPU_PROCESSES 256                        // per GPU, per sample
+#define MAX_CPUS 1024
 #define PATH_SIZE 256
 #define NAME_SIZE 256
 #define LINE_SIZE 512
+#define STAT_BUF_SIZE 1024
+#define NAME_DICT_INITIAL_SIZE 1024                  // must be a power of two
+#define NAME_DICT_RESET_MIN 4096                     // names before the dictionary may be cleared on a keyframe
+#define CGROUP_DICT_COMPACT_MIN 1024                 // cgroup paths before dead ones are dropped
+#define MAX_QUEUED_BLOCKS 16                         // writer backlog before samplers wait
+#define DEFAULT_INTERVAL_MS 2000                     // process sampler period
+#define DEFAULT_GPU_INTERVAL_MS 2000                 // GPU sampler period
+#define DEFAULT_SYSTEM_INTERVAL_MS 1000              // system-wide CPU / memory / disk / network period
+#define DISK_SECTOR_SIZE 512                         // /proc/diskstats always counts 512-byte sectors
+#define NETLINK_BUF_SIZE 8192
+#define SOCK_DIAG_BUF_SIZE 32768                     // one recv of a TCP socket dump
+#define MAX_WINDOWS 1024                             // _NET_CLIENT_LIST entries read
+#define DEFAULT_LISTEN_TOP 20                        // --listen: processes with their own series
+#define LISTEN_BACKLOG 16
+#define LISTEN_TIMEOUT_S 5                           // per scrape, so a stuck client cannot hold the endpoint
+#define LISTEN_REQUEST_SIZE 2048                     // request line and headers; the rest is ignored
+
+// History file (--history FILE): fixed-size rings of system metrics at two
+// resolutions, mmap'd so it survives restarts and the GUI reads it directly.
+// Mirrored in src/ui/utils/history_store.py.
+#define HISTORY_MAGIC 0x31484d54u                    // "TMH1"
+#define HISTORY_VERSION 1
+#define HISTORY_TIERS 2                              // see history_tier_config
+#define HISTORY_CPU 0                                // %, all CPUs
+#define HISTORY_MEMORY 1                             // % of MemTotal not available
+#define HISTORY_DISK_READ 2                          // bytes/s
+#define HISTORY_DISK_WRITTEN 3
+#define HISTORY_NET_RECEIVED 4
+#define HISTORY_NET_SENT 5
+#define HISTORY_METRICS 6
+
+// Binary frame protocol (--format=binary). All integers are host byte order;
+// the reader is always on the same machine. Mirrored in src/ui/utils/backend_protocol.py.
+#define FRAME_MAGIC 0x31464d54u                      // "TMF1"
+#define FRAME_NAMES 1                                // name dictionary additions
+#define FRAME_PROCESSES 2                            // one full process snapshot
+#define FRAME_GPU 3                                  // GPU samples
+#define FRAME_PROCESS_DELTA 4                        // NEW / UPDATE / EXIT records since the last frame
+#define FRAME_GPU_PROCESSES 5                        // per-process GPU memory (NVML only)
+#define FRAME_TICK 6                                 // starts every sampler block: when it was sampled
+#define FRAME_SYSTEM 7                               // one system_record
+#define FRAME_CPU_CORES 8                            // per-core usage, one record per logical CPU
+#define FRAME_PROCESS_TOTALS 9                       // one process_totals_record, after every process frame
+#define FRAME_WINDOW_PIDS 10                         // int32 pids owning a top-level window, sent when they change
+#define FRAME_SHM_PROCESSES 11                       // one shm_notice_record: a snapshot is in the --shm-fd region
+#define FRAME_CGROUPS 12                             // --cgroups: one cgroup_record per cgroup holding a process
+#define FRAME_SAMPLER_STATS 13                       // ends every sampler block: what producing it cost
+#define FRAME_KILL_RESULTS 14                        // --commands: one kill_result_record per target of a KILL
+
+// frame_header.flags
+#define FRAME_FLAG_NAMES_RESET 1                     // FRAME_NAMES: forget every earlier id before adding these
+
+// Snapshot region (--shm-fd FD): full process snapshots are written to shared
+// memory instead of the pipe, which only carries the names and a notice.
+// Mirrored in src/ui/utils/backend_protocol.py.
+#define SHM_MAGIC 0x31534d54u                        // "TMS1"
+#define SHM_VERSION 1
+#define SHM_INITIAL_CAPACITY (1024 * sizeof(proc_record))   // per buffer; doubles when a snapshot does not fit
+
+// tick_record.sampler
+#define SAMPLER_PROCESS 1
+#define SAMPLER_GPU 2
+#define SAMPLER_SYSTEM 3
+
+// proc_record.kind in FRAME_PROCESS_DELTA (always RECORD_UPDATE in FRAME_PROCESSES)
+#define RECORD_UPDATE 0
+#define RECORD_NEW 1
+#define RECORD_EXIT 2                                // only pid is meaningful
+
+// Delta thresholds: smaller changes are not worth a record (the UI rounds to 0.1)
+#define DELTA_CPU_THRESHOLD 0.05f                    // percentage points
+#define DELTA_MEMORY_THRESHOLD 100                   // kB
+#define DELTA_IO_THRESHOLD (0.05f * 1024 * 1024)     // bytes/s (the UI shows 0.1 MB/s)
+#define DEFAULT_KEYFRAME_INTERVAL 30                 // frames between full snapshots
+
+// --pss: smaps_rollup walks every mapping of the process under its mmap
+// lock, so it is read adaptively instead of for every PID on every scan
+#define PSS_BUDGET_NS 20000000ULL                    // smaps_rollup reading per scan
+#define PSS_REFRESH_SCANS 10                         // small, steady processes are read this often
+#define PSS_LARGE_KB (256 * 1024)                    // RSS from which a process is read every scan
+#define PSS_RSS_CHANGE_DIVISOR 16                    // ...as is one whose RSS moved by 1/16 since its read
+#define SMAPS_BUF_SIZE 4096
+
+// --process-net: finding who owns a new socket means reading fd symlinks, so
+// the walk starts with the likeliest owners and stops once every socket is found
+#define SOCKET_OWNER_BUDGET_NS 20000000ULL           // fd walking per scan
+
+// --cgroups: counters of the cgroup v2 groups the scan found processes in
+#define CGROUP_FS "/sys/fs/cgroup"
+#define CGROUP_BUF_SIZE 4096                         // io.stat has a line per device
+
+// uid and cgroup are read on first sight and exec; re-read this often anyway,
+// since launchers move a new process into its app-*.scope after it starts
+#define IDENTITY_REFRESH_SCANS 15
+
+// --commands
+#define COMMAND_LINE_SIZE 65536                      // longest command: a KILL of a few thousand PIDs
+#define KILL_ESCALATE_WAIT_MS 2000                   // after escalating to SIGKILL, how long to wait for exits
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
+// kill_result_record.outcome
+#define KILL_EXITED 0                                // exited after the requested signal
+#define KILL_KILLED 1                                // outlived the timeout, exited after SIGKILL
+#define KILL_GONE 2                                  // not running, or its PID reused, when the command arrived
+#define KILL_FAILED 3                                // could not be signalled: error holds the errno
+#define KILL_RUNNING 4                               // still running when the wait ended
+
+// --bench
+#define BENCH_FIXTURE_FANOUT 8                       // --bench-pids: children of every synthetic parent
+#define BENCH_FIXTURE_CGROUPS 64                     // ...spread over this many services
+
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_BINARY,
+    FORMAT_JSONL,                       // one JSON object per line
+    FORMAT_NONE                         // --listen without --format: nothing on stdout
+} output_format;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t flags;
+    uint32_t count;                     // number of records in the payload
+    uint32_t length;                    // payload bytes following this header
+} frame_header;
+
+// FRAME_NAMES payload: count x { uint32 id; uint16 len; char name[len]; }
+// Ids stay valid until a FRAME_NAMES with FRAME_FLAG_NAMES_RESET, which only
+// comes right before a full process snapshot.
+
+typedef struct {
+    uint64_t memory;                    // kB
+    int32_t pid;
+    uint32_t name_id;
+    float cpu_usage;
+    int32_t threads;
+    int32_t ppid;
+    int32_t session;                    // session id, 0 for kernel threads
+    uint32_t uid;                       // real uid
+    uint32_t cgroup_id;                 // name id of the cgroup path, 0 if unknown
+    float disk_read;                    // bytes/s from /proc/<pid>/io, 0 if not readable
+    float disk_written;
+    float net_received;                 // bytes/s of TCP payload, --process-net only
+    float net_sent;
+    uint32_t pss;                       // kB, --pss only, 0 until first measured
+    uint32_t uss;                       // kB, private pages only
+    uint64_t start_time;                // ms after boot; a parent is never younger than its child
+    uint64_t subtree_memory;            // kB, this process and all its descendants (PSS where measured)
+    float subtree_cpu;                  // the same sums for CPU, disk (read + written) and network
+    float subtree_disk;
+    float subtree_net;
+    char state;
+    uint8_t kind;                       // RECORD_*
+    char pad[2];
+} proc_record;
+
+typedef struct {
+    uint64_t mem_used;                  // MB
+    uint64_t mem_total;                 // MB
+    int32_t index;
+    uint32_t name_id;
+    int32_t utilization;
+    int32_t temperature;
+    int32_t power_usage;
+    int32_t power_limit;
+} gpu_record;
+
+typedef struct {
+    uint64_t mem_used;                  // MB
+    int32_t gpu_index;
+    int32_t pid;
+} gpu_process_record;
+
+typedef struct {
+    uint64_t timestamp_ns;              // CLOCK_MONOTONIC when sampling started
+    uint64_t delta_ns;                  // since this sampler's previous sample, 0 on the first
+    uint32_t sampler;                   // SAMPLER_*
+    uint32_t missed;                    // periods skipped because sampling overran
+} tick_record;
+
+// System-wide counters. Cumulative byte counts are sent as-is; the reader
+// turns them into rates with the TICK delta.
+typedef struct {
+    uint64_t mem_total;                 // kB, /proc/meminfo
+    uint64_t mem_free;
+    uint64_t mem_available;
+    uint64_t mem_cached;                // Cached + SReclaimable
+    uint64_t mem_buffers;
+    uint64_t disk_read;                 // bytes since boot, whole disks only
+    uint64_t disk_written;
+    uint64_t fs_total;                  // bytes, filesystem mounted at /
+    uint64_t fs_free;
+    uint64_t fs_avail;                  // free space usable without root
+    uint64_t net_received;              // bytes since boot, every interface but lo
+    uint64_t net_sent;
+    uint64_t uptime;                    // seconds
+    float cpu_usage;                    // %, all CPUs, since the previous sample
+    float cpu_user;                     // % breakdown of the same interval (user includes nice,
+    float cpu_system;                   //   irq includes softirq); usage excludes iowait
+    float cpu_iowait;
+    float cpu_irq;
+    float cpu_steal;                    // time the hypervisor ran someone else
+    uint32_t cpu_freq;                  // MHz, average over online CPUs, 0 if unknown
+    int32_t temperature;                // millidegrees C from hwmon, 0 if no sensor
+} system_record;
+
+// One logical CPU, % of the interval since the previous sample
+typedef struct {
+    float usage;                        // everything but idle and iowait
+    float user;                         // user + nice
+    float system;
+    float iowait;
+    float irq;                          // irq + softirq
+    float steal;
+} cpu_core_record;
+
+_Static_assert(sizeof(frame_header) == 16, "frame_header layout");
+_Static_assert(sizeof(proc_record) == 96, "proc_record layout");
+_Static_assert(sizeof(gpu_record) == 40, "gpu_record layout");
+_Static_assert(sizeof(gpu_process_record) == 16, "gpu_process_record layout");
+_Static_assert(sizeof(tick_record) == 24, "tick_record layout");
+_Static_assert(sizeof(system_record) == 136, "system_record layout");
+_Static_assert(sizeof(cpu_core_record) == 24, "cpu_core_record layout");
+
+// Exact counts for the whole scan, independent of --top and --delta
+typedef struct {
+    uint32_t processes;                 // thread group leaders that were sampled
+    uint32_t threads;                   // sum of their num_threads
+    uint32_t running;                   // /proc/stat procs_running (tasks, not processes)
+    uint32_t blocked;                   // /proc/stat procs_blocked, waiting on I/O
+} process_totals_record;
+
+_Static_assert(sizeof(process_totals_record) == 16, "process_totals_record layout");
+
+// Start of the --shm-fd region, followed by two buffers of capacity bytes,
+// each holding count proc_records. seq is a seqlock over both: odd while the
+// writer fills the buffer that is not current, even once it is published.
+// The snapshot with sequence s is in buffer (s / 2) % 2 and stays intact
+// until seq passes s + 2. Growing the buffers moves both, so it adds 4.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t record_size;               // sizeof(proc_record)
+    uint64_t size;                      // bytes in the region; readers remap when it grows
+    uint64_t capacity;                  // bytes per buffer; buffer i starts at sizeof(shm_header) + i * capacity
+    uint32_t count[2];                  // records in each buffer
+    char pad[24];
+} shm_header;
+
+// FRAME_SHM_PROCESSES payload: the process frame that was not sent
+typedef struct {
+    uint32_t seq;                       // shm_header.seq of the snapshot
+    uint32_t count;                     // records in it
+} shm_notice_record;
+
+// FRAME_CGROUPS: the kernel's own totals for a cgroup, so a service or
+// container is not the sum of thousands of per-process records
+typedef struct {
+    uint64_t memory;                    // memory.current, bytes (page cache included)
+    uint32_t name_id;                   // the cgroup path
+    uint32_t processes;                 // of this scan inside it
+    float cpu;                          // cpu.stat usage_usec, % of all CPUs
+    float disk_read;                    // io.stat rbytes / wbytes over all devices, bytes/s
+    float disk_written;
+    float cpu_pressure;                 // PSI "some" avg10: % of time a task waited for a CPU
+    float memory_pressure;              // ... waited for memory
+    uint32_t pad;
+} cgroup_record;
+
+_Static_assert(sizeof(cgroup_record) == 40, "cgroup_record layout");
+
+// FRAME_SAMPLER_STATS: what the sampler thread spent on this block. It ends
+// the block, so serialize_ns covers every frame before it.
+typedef struct {
+    uint64_t sample_ns;                 // wall time of the sample
+    uint64_t serialize_ns;              // wall time writing the block's frames
+    uint64_t cpu_ns;                    // thread CPU time (user + system) of the whole tick
+    uint64_t scan_ns;                   // process sampler only: /proc/stat and the per-PID reads
+    uint64_t sort_ns;                   // process sampler only: sort_processes()
+    uint32_t sampler;                   // SAMPLER_*
+    uint32_t opens;                     // files the sample opened
+    uint32_t syscalls;                  // read and write calls since the previous block (syscr + syscw)
+    uint32_t pad;
+} sampler_stats_record;
+
+_Static_assert(sizeof(sampler_stats_record) == 56, "sampler_stats_record layout");
+
+// FRAME_KILL_RESULTS: how one target of a KILL command ended. The frame is
+// sent once every target of the command has an outcome.
+typedef struct {
+    uint32_t request;                   // id given in the command
+    int32_t pid;
+    uint32_t outcome;                   // KILL_*
+    int32_t error;                      // errno for KILL_FAILED, else 0
+} kill_result_record;
+
+_Static_assert(sizeof(kill_result_record) == 16, "kill_result_record layout");
+
+_Static_assert(sizeof(shm_header) == 64, "shm_header layout");
+_Static_assert(sizeof(shm_notice_record) == 8, "shm_notice_record layout");
+
+// One slot of a history ring: every sample that fell into its interval.
+// Slots no sample reached hold NaN.
+typedef struct {
+    float min;
+    float max;
+    float avg;
+} history_slot;
+
+typedef struct {
+    uint32_t step_s;                    // seconds per slot
+    uint32_t slots;                     // ring capacity
+    uint32_t head;                      // index of the newest slot
+    uint32_t head_samples;              // samples merged into the newest slot so far
+    uint64_t head_time;                 // unix time the newest slot starts at, 0 if empty
+    uint64_t offset;                    // file offset of this tier: HISTORY_METRICS rings of slots entries
+} history_tier;
+
+// The file starts with this header. seq is a seqlock: odd while the system
+// sampler updates the rings, so a reader retries if it changed under it.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t metrics;                   // HISTORY_METRICS
+    uint32_t tier_count;                // HISTORY_TIERS
+    uint32_t pad;
+    history_tier tiers[HISTORY_TIERS];
+} history_header;
+
+_Static_assert(sizeof(history_slot) == 12, "history_slot layout");
+_Static_assert(sizeof(history_tier) == 32, "history_tier layout");
+_Static_assert(sizeof(history_header) == 24 + HISTORY_TIERS * 32, "history_header layout");
+
+// One cpu line of /proc/stat, in USER_HZ ticks
+typedef struct {
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+} cpu_times;
 
 typedef struct {
     int index;
@@ -24,50 +399,494 @@ typedef struct {
 } gpu_info;
 
 typedef struct {
+    int gpu_index;
     int pid;
+    unsigned long mem_used;             // MB
+} gpu_process_info;
+
+// Minimal NVML ABI, so the backend builds without the CUDA headers and runs
+// on machines without the driver (libnvidia-ml.so is dlopen'ed at startup)
+typedef void *nvml_device;
+typedef struct { unsigned int gpu; unsigned int memory; } nvml_utilization;
+typedef struct { unsigned long long total; unsigned long long free; unsigned long long used; } nvml_memory;
+typedef struct {
+    unsigned int pid;
+    unsigned long long used_gpu_memory; // bytes
+    unsigned int gpu_instance_id;
+    unsigned int compute_instance_id;
+} nvml_process_info;                    // nvmlProcessInfo_v2_t, used by the _v2 and _v3 calls
+
+#define NVML_SUCCESS 0
+#define NVML_TEMPERATURE_GPU 0
+#define NVML_DEVICE_NAME_SIZE 96
+
+typedef struct {
+    void *lib;
+    int (*init)(void);
+    int (*device_count)(unsigned int *);
+    int (*device_handle)(unsigned int, nvml_device *);
+    int (*device_name)(nvml_device, char *, unsigned int);
+    int (*utilization)(nvml_device, nvml_utilization *);
+    int (*memory_info)(nvml_device, nvml_memory *);
+    int (*temperature)(nvml_device, int, unsigned int *);
+    int (*power_usage)(nvml_device, unsigned int *);             // mW
+    int (*power_limit)(nvml_device, unsigned int *);             // mW
+    int (*running_processes[2])(nvml_device, unsigned int *, nvml_process_info *);   // compute, graphics
+    unsigned int count;
+    nvml_device devices[MAX_GPUS];
+    char names[MAX_GPUS][NVML_DEVICE_NAME_SIZE];
+} nvml_api;
+
+// Minimal Xlib ABI, dlopen'ed like NVML: no X headers at build time, and a
+// headless machine just runs without window tracking
+typedef unsigned long x_window;
+typedef unsigned long x_atom;
+typedef struct {
+    int type;
+    void *display;
+    unsigned long resourceid;
+    unsigned long serial;
+    unsigned char error_code;
+    unsigned char request_code;
+    unsigned char minor_code;
+} x_error_event;
+typedef union {
+    int type;
+    struct {
+        int type;
+        unsigned long serial;
+        int send_event;
+        void *display;
+        x_window window;
+        x_atom atom;
+        unsigned long time;
+        int state;
+    } xproperty;
+    long pad[24];                               // sizeof(XEvent)
+} x_event;
+
+#define X_SUCCESS 0
+#define X_PROPERTY_NOTIFY 28
+#define X_PROPERTY_CHANGE_MASK (1L << 22)
+#define X_ATOM_CARDINAL 6
+#define X_ATOM_WINDOW 33
+
+typedef struct {
+    void *lib;
+    void *display;                              // used by the window thread only
+    x_window root;
+    x_atom client_list;                         // _NET_CLIENT_LIST
+    x_atom wm_pid;                              // _NET_WM_PID
+    void *(*open_display)(const char *);
+    x_window (*default_root)(void *);
+    x_atom (*intern_atom)(void *, const char *, int);
+    int (*select_input)(void *, x_window, long);
+    int (*get_window_property)(void *, x_window, x_atom, long, long, int, x_atom,
+                               x_atom *, int *, unsigned long *, unsigned long *, unsigned char **);
+    int (*free)(void *);
+    int (*next_event)(void *, x_event *);
+    int (*pending)(void *);
+    void *(*set_error_handler)(int (*)(void *, x_error_event *));
+} x11_api;
+
+typedef struct {
+    int pid;                                    // 0 marks an empty slot
+    unsigned long long start_time;              // catches reused PIDs
     unsigned long long last_cpu_time;           //stores last cpu time of each process
+    unsigned int generation;                    // scan pass that last saw this PID
+    unsigned int identity_scan;                 // scan pass that last read uid and cgroup, 0 = never
+    uint32_t name_hash;                         // comm at that read, to notice exec
+    uint32_t uid;
+    uint32_t cgroup;                            // cgroup_intern() handle
+    unsigned long long last_read_bytes;         // /proc/<pid>/io at io_ns
+    unsigned long long last_written_bytes;
+    uint64_t io_ns;                             // scan that read them, 0 = never
+    unsigned char io_denied;                    // /proc/<pid>/io refused us: not opened again until exec
+    uint64_t net_received;                      // --process-net: TCP bytes of its sockets this scan
+    uint64_t net_sent;
+    uint32_t pss;                               // --pss: smaps_rollup at pss_scan, kB
+    uint32_t uss;
+    unsigned long pss_rss;                      // RSS at that read, to notice fast changers
+    unsigned int pss_scan;                      // scan pass that read them, 0 = never
+    unsigned int pss_due;                       // scan pass from which the read is stale
+    unsigned char pss_denied;                   // smaps_rollup refused us: not opened again until exec
+    unsigned int fd_scan;                       // --process-net: scan pass that last walked its fds, 0 = never
+    unsigned int socket_scan;                   // ...and that last found it owning a socket
+    int index;                                  // its process_info in plist, valid when generation is current
+    // --delta: what the client currently holds for this PID
+    unsigned char in_client;
+    char sent_state;
+    int sent_threads;
+    int sent_ppid;
+    uint32_t sent_uid;
+    uint32_t sent_cgroup;
+    float sent_cpu;
+    unsigned long sent_memory;
+    float sent_disk_read;
+    float sent_disk_written;
+    float sent_net_received;
+    float sent_net_sent;
+    uint32_t sent_pss;
+    uint32_t sent_uss;
+    float sent_subtree_cpu;
+    unsigned long sent_subtree_memory;
+    float sent_subtree_disk;
+    float sent_subtree_net;
+    unsigned int sent_frame;                    // output frame that last included this PID
 } cpu_record_time;
 
+// --proc-events: process lifecycle from the kernel instead of a /proc rescan
+#define EVENT_NEW 1                                  // fork or exec of a thread group leader
+#define EVENT_EXITED 2                               // taskstats of an exited process
+
+// Queued by the event thread, drained by the process sampler every tick
 typedef struct {
     int pid;
+    int kind;                           // EVENT_*
+    int group;                          // EVENT_EXITED: stats cover every thread of the process
+    int ppid;                           // EVENT_EXITED
+    uint32_t uid;                       // EVENT_EXITED
+    unsigned long long cpu_us;          // EVENT_EXITED: lifetime user + system time
+    unsigned long long elapsed_us;      // EVENT_EXITED: lifetime wall time
+    unsigned long long start_time;      // EVENT_EXITED: clock ticks after boot, the exit less elapsed_us
+    unsigned long long rss_kb;          // EVENT_EXITED: peak RSS
+    char comm[TS_COMM_LEN];
+} proc_event_entry;
+
+// Fields taken from a single read of /proc/<pid>/stat
+typedef struct {
     char name[NAME_SIZE];
+    size_t name_len;
+    char state;
+    int ppid;                           // field 4
+    int session;                        // field 6
+    unsigned long long utime;           // field 14, clock ticks
+    unsigned long long stime;           // field 15, clock ticks
+    int threads;                        // field 20
+    unsigned long long start_time;      // field 22, clock ticks since boot
+    unsigned long rss_pages;            // field 24
+} proc_stat_sample;
+
+typedef struct {
+    int pid;
+    unsigned int name_off;              // offset of the name in name_arena
     char state;
     float cpu_usage;
     int threads;
     unsigned long memory;
+    int ppid;
+    int session;
+    uint32_t uid;
+    uint32_t cgroup;                    // cgroup_intern() handle, 0 if unknown
+    float disk_read;                    // bytes/s since the previous scan
+    float disk_written;
+    float net_received;
+    float net_sent;
+    uint32_t pss;                       // kB, --pss: possibly from an earlier scan, 0 = not measured
+    uint32_t uss;
+    unsigned long long start_time;      // clock ticks after boot
+    // Filled by sum_process_subtrees() once the scan is complete
+    int parent;                         // index in plist, -1 for a root
+    int pending;                        // children not yet added to the sums below
+    float subtree_cpu;
+    unsigned long subtree_memory;
+    float subtree_disk;
+    float subtree_net;
 } process_info;
 
+// --process-net: one TCP socket from a sock_diag dump
+typedef struct {
+    uint32_t inode;
+    int pid;                            // owner, 0 = not looked up yet, -1 = none we can see
+    uint64_t received;                  // tcpi_bytes_received
+    uint64_t sent;                      // tcpi_bytes_acked
+} socket_entry;
+
+// --pss: a process due for a smaps_rollup read, in the order they are read
+typedef struct {
+    unsigned int urgency;               // 0 never read, 1 large or changing fast, 2 just stale
+    unsigned int pss_scan;              // older reads first within a class
+    int index;                          // into plist
+} pss_candidate;
+
+// --process-net: a process whose fds may hold a socket nobody owns yet
+typedef struct {
+    unsigned int urgency;               // 0 owned sockets last dump, 1 never walked, 2 the rest
+    unsigned int fd_scan;               // least recently walked first within a class
+    int index;                          // into plist
+} owner_candidate;
+
+// --cgroups: one cgroup with processes in it, and the counters behind its rates
+typedef struct {
+    uint32_t cgroup;                    // cgroup_intern() handle
+    uint32_t processes;
+    uint64_t usage_usec;                // cpu.stat
+    uint64_t read_bytes;                // io.stat
+    uint64_t written_bytes;
+    uint64_t sampled_ns;                // when the counters were read, 0 = not readable
+    uint64_t memory;
+    float cpu;
+    float disk_read;
+    float disk_written;
+    float cpu_pressure;
+    float memory_pressure;
+} cgroup_entry;
+
+// Assigns a stable id to every distinct name sent in binary frames, so each
+// name crosses the pipe once
+typedef struct {
+    uint32_t hash;
+    uint32_t id;                        // 0 marks an empty slot
+    uint32_t off;                       // offset of the name in name_dict_strings
+} name_slot;
+
+// Bump allocator that grows on demand; reset (not freed) between ticks.
+// Contents may move when it grows, so callers keep offsets, not pointers.
+typedef struct {
+    char *data;
+    size_t used;
+    size_t cap;
+} arena;
+
+// Everything one sampler tick serializes. It is queued to the writer thread
+// whole, so blocks from different samplers never interleave on stdout.
+typedef struct {
+    arena buf;                          // finished frames (binary) or lines (text)
+    arena frame;                        // binary frame being serialized
+} output_block;
+
+typedef struct queued_block {
+    struct queued_block *next;
+    size_t size;
+    char data[];
+} queued_block;
+
+// One process of a KILL command, held through a pidfd so a reused PID is never signalled
+typedef struct {
+    int pid;
+    int fd;                             // pidfd, -1 once the target has an outcome
+    uint32_t outcome;                   // KILL_*
+    int error;
+} kill_target;
+
+typedef struct kill_batch {
+    struct kill_batch *next;
+    uint32_t request;
+    int signal;
+    int escalated;                      // SIGKILL sent to the targets still running
+    uint64_t deadline_ns;               // escalate, or stop waiting, at this CLOCK_MONOTONIC time
+    int count;
+    int pending;                        // targets without an outcome
+    kill_target targets[];
+} kill_batch;
+
+// A data source with its own thread and period. sample() collects without
+// holding any lock; serialize() runs under output_lock. With --listen,
+// export_metrics() renders the same sample for the metrics endpoint.
+typedef struct {
+    const char *name;
+    uint32_t id;                        // SAMPLER_*
+    int *interval_ms;
+    void (*sample)(void);
+    void (*serialize)(output_block *out);
+    void (*export_metrics)(output_block *out);
+    output_block out;
+    output_block metrics;               // section being rendered, swapped into metrics_published
+} sampler;
+
 
 unsigned long long last_total_cpu_time = 0;          //stores last total cpu time
-cpu_record_time cpu_table[TABLE_SIZE];               //stores pid and last total cpu time of each process
-process_info plist[MAX_PROCESSES];                   // stores information of all processes
+cpu_record_time *cpu_table = NULL;                   // open-addressing hash table keyed by pid
+size_t cpu_table_size = 0;                           // number of slots (power of two)
+size_t cpu_table_used = 0;                           // number of occupied slots
+unsigned int scan_generation = 0;                    // incremented on every read_process_info() pass
+arena process_arena = {0};                           // process_info records of the current snapshot
+arena name_arena = {0};                              // NUL-terminated process names of the current snapshot
+process_info *plist = NULL;                          // view of process_arena, valid after read_process_info()
 int p_count = 0;
-int process_count = 0;
+process_totals_record proc_totals = {0};             // counts for FRAME_PROCESS_TOTALS, filled by read_process_info()
+arena order_arena = {0};                             // process_info pointers in output order
+process_info **porder = NULL;                        // view of order_arena, valid after read_process_info()
+int order_count = 0;                                 // p_count, or top_k when --top is given
+int top_k = 0;                                       // --top N: only sort and send the N busiest processes
+output_format format = FORMAT_TEXT;                  // --format
+name_slot *name_dict = NULL;                         // open-addressing table of names already sent
+size_t name_dict_size = 0;
+uint32_t name_dict_count = 0;
+arena name_dict_strings = {0};                       // persistent storage for dictionary names
+arena pending_names = {0};                           // FRAME_NAMES payload for this tick
+uint32_t name_dict_reset_at = NAME_DICT_RESET_MIN;   // names from which the next keyframe clears the dictionary
+int name_dict_cleared = 0;                           // the next FRAME_NAMES carries FRAME_FLAG_NAMES_RESET
+name_slot *cgroup_dict = NULL;                       // cgroup paths seen by the process sampler
+size_t cgroup_dict_size = 0;
+uint32_t cgroup_dict_count = 0;
+uint32_t cgroup_compact_at = CGROUP_DICT_COMPACT_MIN;    // paths from which the next scan drops dead ones
+arena cgroup_strings = {0};                          // their NUL-terminated text; handle = offset + 1
+arena identity_buf = {0};                            // read_process_identity(): the whole /proc/<pid>/cgroup
+uint32_t pending_name_count = 0;
+arena record_arena = {0};                            // proc_record / cgroup_record staging for their frames
+int delta_mode = 0;                                  // --delta: send FRAME_PROCESS_DELTA between keyframes
+int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;   // --keyframe-interval
+unsigned int output_frame = 0;                       // number of process frames written
+arena exited_pids = {0};                             // int32 pids the client holds that have exited
+int shm_fd = -1;                                     // --shm-fd
+shm_header *shm = NULL;                              // mapped by shm_open_region(), NULL = snapshots go down the pipe
+nvml_api nvml = {0};                                 // loaded once by nvml_open(); nvml.lib == NULL means use nvidia-smi
+gpu_process_info gpu_procs[MAX_GPUS * MAX_GPU_PROCESSES];   // per-process GPU memory from the last sample
+int gpu_proc_count = 0;
+gpu_info gpus[MAX_GPUS];                             // GPU sampler's last sample
+int gpu_count = 0;
+int interval_ms = DEFAULT_INTERVAL_MS;               // --interval-ms
+int gpu_interval_ms = DEFAULT_GPU_INTERVAL_MS;       // --gpu-interval-ms
+int system_interval_ms = DEFAULT_SYSTEM_INTERVAL_MS; // --system-interval-ms
+system_record sys_sample = {0};                      // system sampler's last sample
+cpu_core_record sys_cores[MAX_CPUS];
+int sys_core_count = 0;
+cpu_times sys_last_cpu = {0};                        // previous /proc/stat, for the system sampler's deltas
+cpu_times sys_last_cores[MAX_CPUS];
+uint64_t sys_last_ns = 0;                            // when sys_sample was taken, for the history rates
+// {seconds per slot, slots}: 1 s for 10 minutes, 10 s for 24 hours (~650 kB in all)
+const uint32_t history_tier_config[HISTORY_TIERS][2] = { {1, 600}, {10, 8640} };
+const char *history_path = NULL;                     // --history
+history_header *history = NULL;                      // mmap'd by history_open(), NULL = no history
+char cpu_temp_path[PATH_SIZE + NAME_SIZE] = "";      // hwmon input chosen by probe_cpu_temp()
+int cpu_temp_probed = 0;
+int proc_events = 0;                                 // --proc-events
+int track_windows = 0;                               // --windows
+x11_api x11 = {0};                                   // loaded by x11_open() when --windows is given
+output_block window_out = {0};                       // window thread's output
+int command_mode = 0;                                // --commands
+output_block command_out = {0};                      // command thread's output
+int proc_events_active = 0;                          // event thread running; otherwise rescan /proc every tick
+int cn_fd = -1;                                      // proc connector socket (fork/exec events)
+int taskstats_fd = -1;                               // taskstats socket (exit accounting), optional
+uint16_t taskstats_family = 0;                       // generic netlink id of TASKSTATS
+pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+arena event_queue = {0};                             // proc_event_entry, appended by the event thread
+arena event_batch = {0};                             // event_queue swapped out by the sampler
+int events_lost = 1;                                 // rescan /proc on the next tick (start, netlink overflow)
+arena candidate_pids = {0};                          // int pids to sample when not rescanning
+int process_net = 0;                                 // --process-net
+int pss_mode = 0;                                    // --pss
+arena pss_candidates = {0};                          // pss_candidate, due for a smaps_rollup read this scan
+arena tree_queue = {0};                              // sum_process_subtrees(): plist indices whose subtree is complete
+int cgroup_mode = 0;                                 // --cgroups
+int cgroup_fs_fd = -1;                               // CGROUP_FS, opened by cgroup_fs_open()
+long cgroup_cpus = 1;                                // online CPUs: usage_usec is summed over them
+arena cgroups = {0};                                 // cgroup_entry of this scan, sorted by handle
+arena last_cgroups = {0};                            // the previous scan's, for the rates
+int sock_diag_fd = -1;                               // NETLINK_SOCK_DIAG, opened by sock_diag_open()
+arena sockets = {0};                                 // socket_entry of this scan, sorted by inode
+arena last_sockets = {0};                            // the previous scan's, for the byte deltas
+uint64_t sockets_ns = 0;                             // when last_sockets was dumped, 0 = never
+arena owner_candidates = {0};                        // owner_candidate, in the order their fds are walked
+uint64_t last_scan_ns = 0;
+uint64_t process_scan_ns = 0;                        // phases of the last read_process_info(), for FRAME_SAMPLER_STATS
+uint64_t process_sort_ns = 0;
+__thread uint32_t thread_opens = 0;                  // files this thread opened through counted_openat() / counted_fopen()
+const char *proc_root = "/proc";                     // --proc-root, for --bench against a fixture
+int bench_scans = 0;                                 // --bench N
+int bench_pids = 0;                                  // --bench-pids N
+const char *listen_addr = NULL;                      // --listen [HOST:]PORT
+int listen_top = DEFAULT_LISTEN_TOP;                 // --listen-top
+int listen_fd = -1;
+pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+arena metrics_published[SAMPLER_SYSTEM + 1];         // latest exposition text, indexed by SAMPLER_*
+// Held while a sampler serializes and queues its block: guards the name
+// dictionary and keeps FRAME_NAMES ahead of the first frame using an id
+pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+queued_block *queue_head = NULL;                     // blocks waiting for the writer thread
+queued_block *queue_tail = NULL;
+int queue_len = 0;
+DIR *proc_dir = NULL;                                // kept open for the lifetime of the backend
+int proc_fd = -1;                                    // dirfd of proc_dir, base for openat()
+unsigned long page_size_kb = 4;
+long clock_ticks = 100;                              // sysconf(_SC_CLK_TCK), read once by open_proc_dir()
 
 
-unsigned long long get_total_cpu_time(unsigned long long *delta);
-int get_process_name(int pid, char *name, size_t size);
-int get_process_state_and_times(int pid, char *state, unsigned long long *utime, unsigned long long *stime);
-int get_process_threads(int pid);
-float calculate_cpu_usage(int pid, unsigned long long cpu_time_per_process, unsigned long long delta_total_cpu_time);
-unsigned long get_process_memory(int pid);
+unsigned long long get_total_cpu_time(unsigned long long *delta, process_totals_record *totals);
+void *arena_alloc(arena *a, size_t size);
+void arena_reset(arena *a);
+const char *process_name(const process_info *p);
+int open_proc_dir(void);
+int counted_openat(int dirfd, const char *path, int flags);
+FILE *counted_fopen(const char *path);
+int parse_process_stat(char *buf, proc_stat_sample *out);
+int read_process_stat(int pid, proc_stat_sample *out);
+cpu_record_time *cpu_table_lookup(int pid, int *found);
+cpu_record_time *cpu_table_find(int pid);
+void cpu_table_evict_stale(void);
+float calculate_cpu_usage(int pid, unsigned long long start_time, unsigned long long cpu_time_per_process,
+                          unsigned long long delta_total_cpu_time);
 
+int compare_cpu_desc(const void *a, const void *b);
+void select_top_k(process_info **items, int n, int k);
+int sort_processes(void);
 void read_process_info(void);
+int proc_connector_open(void);
+int taskstats_open(void);
+int proc_events_start(void);
+int sock_diag_open(void);
+void sample_process_net(uint64_t now);
+void sample_process_pss(void);
+void sum_process_subtrees(void);
+int cgroup_fs_open(void);
+void sample_cgroups(uint64_t now);
+void cgroup_dict_compact(void);
+int x11_open(void);
+int window_tracking_start(void);
+int command_start(void);
+uint64_t monotonic_ns(void);
+int run_bench(int scans, int fixture_pids);
+int nvml_open(void);
+int get_gpu_info_nvml(gpu_info *gpus, int max_gpus);
+int get_gpu_info_smi(gpu_info *gpus, int max_gpus);
+int get_gpu_info(gpu_info *gpus, int max_gpus);
+void sample_gpu_info(void);
+int read_cpu_stat(cpu_times *total, cpu_times *cores, int max_cores, process_totals_record *totals);
+unsigned long long cpu_times_sum(const cpu_times *t);
+int history_open(const char *path);
+void history_add(const float *values, uint64_t now);
+void sample_system_info(void);
+void output_system_info(output_block *out);
+void output_gpu_info(output_block *out);
+uint32_t name_dict_id(const char *name, size_t len);
+uint32_t cgroup_intern(const char *path, size_t len);
+const char *cgroup_path(uint32_t handle);
+int read_process_identity(int pid, uint32_t *uid, uint32_t *cgroup);
+void block_printf(output_block *out, const char *fmt, ...);
+void block_write(output_block *out, const char *data, size_t len);
+void block_escaped(output_block *out, const char *s, int json);
+void block_line_end(output_block *out, const char *s);
+void frame_begin(output_block *out, uint16_t type);
+int frame_append(output_block *out, const void *data, size_t size);
+void frame_end(output_block *out, uint32_t count);
+void flush_pending_names(output_block *out);
+int shm_open_region(int fd);
+proc_record *shm_begin(size_t count);
+uint32_t shm_end(size_t count);
+void output_process_info(output_block *out);
+void submit_block(output_block *out);
+void export_process_metrics(output_block *out);
+void export_gpu_metrics(output_block *out);
+void export_system_metrics(output_block *out);
+int listen_open(const char *spec);
 void clear_screen(void);
 
-// Get total CPU time and calculate delta
-unsigned long long get_total_cpu_time(unsigned long long *delta) {
-    FILE *fp = fopen("/proc/stat", "r");
-    if (fp == NULL) {
+// Get total CPU time and calculate delta. Every field counts (iowait, irq,
+// softirq and steal included), so per-process shares are of real elapsed time.
+// The running / blocked task counts come from the same read of /proc/stat.
+unsigned long long get_total_cpu_time(unsigned long long *delta, process_totals_record *totals) {
+    cpu_times t;
+    if (read_cpu_stat(&t, NULL, 0, totals) < 0) {
         *delta = 0;
         return 0;
     }
     
-    unsigned long long user, nice, system, idle, total_cpu;
-    fscanf(fp, "%*s %llu %llu %llu %llu", &user, &nice, &system, &idle);
-    fclose(fp);
-    
-    total_cpu = user + nice + system + idle;
+    unsigned long long total_cpu = cpu_times_sum(&t);
     
     if (last_total_cpu_time == 0) {
         last_total_cpu_time = total_cpu;
@@ -80,118 +899,396 @@ unsigned long long get_total_cpu_time(unsigned long long *delta) {
     return total_cpu;
 }
 
-// Read process name from /proc/<pid>/comm
+// Reserve size bytes at the end of the arena, doubling its capacity if needed
+void *arena_alloc(arena *a, size_t size) {
+    if (a->used + size > a->cap) {
+        size_t new_cap = a->cap ? a->cap : ARENA_INITIAL_SIZE;
+        while (a->used + size > new_cap) new_cap *= 2;
 
-int get_process_name(int pid, char *name, size_t size) {
-    char path[PATH_SIZE];
-    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (fp == NULL) return -1;
-    
-    if (fgets(name, size, fp) == NULL) {
-        fclose(fp);
-        return -1;
+        char *data = realloc(a->data, new_cap);
+        if (data == NULL) return NULL;
+
+        a->data = data;
+        a->cap = new_cap;
     }
-    fclose(fp);
-    
-    name[strcspn(name, "\n")] = '\0';
+
+    void *p = a->data + a->used;
+    a->used += size;
+    return p;
+}
+
+void arena_reset(arena *a) {
+    a->used = 0;
+}
+
+const char *process_name(const process_info *p) {
+    return name_arena.data + p->name_off;
+}
+
+// Open /proc once and keep the fd; per-process files are opened relative to it
+int open_proc_dir(void) {
+    if (proc_dir != NULL) return 0;
+
+    proc_dir = opendir(proc_root);
+    if (proc_dir == NULL) return -1;
+    proc_fd = dirfd(proc_dir);
+
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) page_size_kb = page_size / 1024;
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) clock_ticks = ticks;
+
     return 0;
 }
 
-// Read process state and CPU times from /proc/<pid>/stat
+// Files read every tick are opened through these, so FRAME_SAMPLER_STATS
+// can say how many a sample took
+int counted_openat(int dirfd, const char *path, int flags) {
+    thread_opens++;
+    return openat(dirfd, path, flags);
+}
+
+FILE *counted_fopen(const char *path) {
+    thread_opens++;
+    return fopen(path, "r");
+}
+
+// Parse an unsigned decimal field and step past the following space
+static unsigned long long next_field(char **p) {
+    unsigned long long value = 0;
+    char *c = *p;
+
+    if (*c == '-') c++;                 // only skipped fields can be negative
+    while (*c >= '0' && *c <= '9') {
+        value = value * 10 + (unsigned long long)(*c - '0');
+        c++;
+    }
+    while (*c == ' ') c++;
+
+    *p = c;
+    return value;
+}
+
+// Tokenize a /proc/<pid>/stat line in place. comm is delimited by the first
+// '(' and the LAST ')', since the name itself may contain spaces or parens.
+int parse_process_stat(char *buf, proc_stat_sample *out) {
+    char *open = strchr(buf, '(');
+    char *close = strrchr(buf, ')');
+    if (open == NULL || close == NULL || close < open || close[1] != ' ') return -1;
+
+    size_t len = (size_t)(close - open - 1);
+    if (len >= NAME_SIZE) len = NAME_SIZE - 1;
+    memcpy(out->name, open + 1, len);
+    out->name[len] = '\0';
+    out->name_len = len;
+
+    char *p = close + 2;
+    out->state = *p;
+    if (out->state == '\0' || p[1] != ' ') return -1;
+    p += 2;
+
+    // p now points at field 4 (ppid)
+    for (int field = 4; field <= 24; field++) {
+        if (*p == '\0' || *p == '\n') return -1;
+        unsigned long long value = next_field(&p);
+        switch (field) {
+            case 4: out->ppid = (int)value; break;
+            case 6: out->session = (int)value; break;
+            case 14: out->utime = value; break;
+            case 15: out->stime = value; break;
+            case 20: out->threads = (int)value; break;
+            case 22: out->start_time = value; break;
+            case 24: out->rss_pages = (unsigned long)value; break;
+        }
+    }
 
-int get_process_state_and_times(int pid, char *state, unsigned long long *utime, unsigned long long *stime) {
-    char path[PATH_SIZE];
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (fp == NULL) return -1;
-    
-    fscanf(fp, "%*d %*s %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
-           state, utime, stime);
-    fclose(fp);
-    
     return 0;
 }
 
-// Read thread count from /proc/<pid>/status
-int get_process_threads(int pid) {
-    char path[PATH_SIZE];
-    char line[LINE_SIZE];
-    int threads = 0;
-    
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (fp == NULL) return 0;
-    
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "Threads:", 8) == 0) {
-            sscanf(line, "Threads: %d", &threads);
+// Read /proc/<pid>/stat with a single openat + read into a stack buffer
+int read_process_stat(int pid, proc_stat_sample *out) {
+    char path[32];
+    char buf[STAT_BUF_SIZE];
+
+    snprintf(path, sizeof(path), "%d/stat", pid);
+
+    int fd = counted_openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+
+    return parse_process_stat(buf, out);
+}
+
+static size_t cpu_table_hash(int pid) {
+    // Knuth multiplicative hash; consecutive PIDs spread across the table
+    return ((unsigned int)pid * 2654435761u) & (cpu_table_size - 1);
+}
+
+// Grow the table so the load factor stays at or below 1/2
+static int cpu_table_reserve(void) {
+    if (cpu_table != NULL && (cpu_table_used + 1) * 2 <= cpu_table_size) {
+        return 0;
+    }
+
+    size_t old_size = cpu_table_size;
+    cpu_record_time *old_table = cpu_table;
+    size_t new_size = old_size ? old_size * 2 : TABLE_INITIAL_SIZE;
+
+    cpu_record_time *new_table = calloc(new_size, sizeof(cpu_record_time));
+    if (new_table == NULL) return -1;
+
+    cpu_table = new_table;
+    cpu_table_size = new_size;
+
+    for (size_t i = 0; i < old_size; i++) {
+        if (old_table[i].pid == 0) continue;
+        size_t slot = cpu_table_hash(old_table[i].pid);
+        while (cpu_table[slot].pid != 0) {
+            slot = (slot + 1) & (cpu_table_size - 1);
+        }
+        cpu_table[slot] = old_table[i];
+    }
+    free(old_table);
+
+    return 0;
+}
+
+// Find the slot for pid, or the empty slot where it should be inserted.
+// Returns NULL only if the table could not be allocated.
+cpu_record_time *cpu_table_lookup(int pid, int *found) {
+    *found = 0;
+    if (cpu_table_reserve() != 0) return NULL;
+
+    size_t slot = cpu_table_hash(pid);
+    while (cpu_table[slot].pid != 0) {
+        if (cpu_table[slot].pid == pid) {
+            *found = 1;
             break;
         }
+        slot = (slot + 1) & (cpu_table_size - 1);
     }
-    fclose(fp);
-    
-    return threads;
+
+    return &cpu_table[slot];
 }
 
-// Calculate CPU usage for a process
-float calculate_cpu_usage(int pid, unsigned long long cpu_time_per_process,
-                         unsigned long long delta_total_cpu_time) {
-    if (delta_total_cpu_time == 0 || process_count >= TABLE_SIZE) {
-        return 0.0;
+// Find the record for pid without inserting; NULL if it is not tracked
+cpu_record_time *cpu_table_find(int pid) {
+    if (cpu_table == NULL) return NULL;
+
+    size_t slot = cpu_table_hash(pid);
+    while (cpu_table[slot].pid != 0) {
+        if (cpu_table[slot].pid == pid) return &cpu_table[slot];
+        slot = (slot + 1) & (cpu_table_size - 1);
     }
-    
-    int i;
-    for (i = 0; i < process_count; i++) {
-        if (cpu_table[i].pid == pid) {
-            break;
+
+    return NULL;
+}
+
+// Remove every PID the current scan did not see. Uses backward-shift deletion
+// so linear probing never needs tombstones.
+void cpu_table_evict_stale(void) {
+    if (cpu_table == NULL) return;
+
+    size_t mask = cpu_table_size - 1;
+
+    // Start right after an empty slot so no cluster wraps around the start
+    size_t start = 0;
+    while (start < cpu_table_size && cpu_table[start].pid != 0) start++;
+    if (start == cpu_table_size) return;   // cannot happen at load <= 1/2
+
+    for (size_t n = 1; n <= cpu_table_size; n++) {
+        size_t i = (start + n) & mask;
+        if (cpu_table[i].pid == 0 || cpu_table[i].generation == scan_generation) continue;
+
+        // The client still shows this PID; tell it in the next delta frame
+        if (cpu_table[i].in_client) {
+            int32_t *pid = arena_alloc(&exited_pids, sizeof(int32_t));
+            if (pid != NULL) *pid = cpu_table[i].pid;
+        }
+
+        // Delete slot i, then pull back later cluster members that probed past it
+        size_t hole = i;
+        size_t j = i;
+        while (1) {
+            j = (j + 1) & mask;
+            if (cpu_table[j].pid == 0) break;
+            size_t home = cpu_table_hash(cpu_table[j].pid);
+            // Entry at j may fill the hole only if its home is not in (hole, j]
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                cpu_table[hole] = cpu_table[j];
+                hole = j;
+            }
         }
+        cpu_table[hole].pid = 0;
+        cpu_table_used--;
+
+        // Slot i now holds a shifted entry (or is empty); examine it again
+        n--;
     }
-    
-    // if process not in process_list
-    if (i == process_count) {
-        cpu_table[process_count].pid = pid;
-        cpu_table[process_count].last_cpu_time = cpu_time_per_process;
-        process_count++;
+}
+
+// Calculate CPU usage for a process
+float calculate_cpu_usage(int pid, unsigned long long start_time, unsigned long long cpu_time_per_process,
+                          unsigned long long delta_total_cpu_time) {
+    int found;
+    cpu_record_time *rec = cpu_table_lookup(pid, &found);
+    if (rec == NULL) return 0.0;
+
+    // if process not in table, or the pid was reused by a new process
+    if (!found || rec->start_time != start_time) {
+        if (!found) cpu_table_used++;
+        // A reused pid goes out as RECORD_NEW, which replaces the client's stale row
+        *rec = (cpu_record_time){
+            .pid = pid,
+            .start_time = start_time,
+            .last_cpu_time = cpu_time_per_process,
+            .generation = scan_generation
+        };
+        return 0.0;
+    }
+
+    rec->generation = scan_generation;
+
+    if (delta_total_cpu_time == 0) {
+        rec->last_cpu_time = cpu_time_per_process;
         return 0.0;
     }
     
+    unsigned long long delta_cpu_per_process = cpu_time_per_process - rec->last_cpu_time;
+    // delta_total_cpu_time already spans every CPU, so this is a share of the whole machine
+    float cpu_usage = (delta_cpu_per_process * 100.0) / delta_total_cpu_time;
     
-    unsigned long long delta_cpu_per_process = cpu_time_per_process - cpu_table[i].last_cpu_time;
-    int cores = sysconf(_SC_NPROCESSORS_ONLN);
-    float cpu_usage = (delta_cpu_per_process * 100.0) / (delta_total_cpu_time * cores);
-    
-    cpu_table[i].last_cpu_time = cpu_time_per_process;
+    rec->last_cpu_time = cpu_time_per_process;
     
     return cpu_usage;
 }
 
-unsigned long get_process_memory(int pid){
-    char path[PATH_SIZE];
-    char line[LINE_SIZE];
-    snprintf(path,sizeof(path),"/proc/%d/status",pid);
+// Load NVML and cache device handles. Returns 0 if NVML is usable.
+int nvml_open(void) {
+    void *lib = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL) lib = dlopen("libnvidia-ml.so", RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL) return -1;
 
-    FILE *fp = fopen(path,"r");
-    if(fp==NULL)return 0;
+    nvml_api api = { .lib = lib };
+    *(void **)&api.init = dlsym(lib, "nvmlInit_v2");
+    *(void **)&api.device_count = dlsym(lib, "nvmlDeviceGetCount_v2");
+    *(void **)&api.device_handle = dlsym(lib, "nvmlDeviceGetHandleByIndex_v2");
+    *(void **)&api.device_name = dlsym(lib, "nvmlDeviceGetName");
+    *(void **)&api.utilization = dlsym(lib, "nvmlDeviceGetUtilizationRates");
+    *(void **)&api.memory_info = dlsym(lib, "nvmlDeviceGetMemoryInfo");
+    *(void **)&api.temperature = dlsym(lib, "nvmlDeviceGetTemperature");
+    *(void **)&api.power_usage = dlsym(lib, "nvmlDeviceGetPowerUsage");
+    *(void **)&api.power_limit = dlsym(lib, "nvmlDeviceGetEnforcedPowerLimit");
 
-    unsigned long memory=0;
+    // Per-process memory is optional; older drivers only have the _v2 entry points
+    *(void **)&api.running_processes[0] = dlsym(lib, "nvmlDeviceGetComputeRunningProcesses_v3");
+    if (api.running_processes[0] == NULL)
+        *(void **)&api.running_processes[0] = dlsym(lib, "nvmlDeviceGetComputeRunningProcesses_v2");
+    *(void **)&api.running_processes[1] = dlsym(lib, "nvmlDeviceGetGraphicsRunningProcesses_v3");
+    if (api.running_processes[1] == NULL)
+        *(void **)&api.running_processes[1] = dlsym(lib, "nvmlDeviceGetGraphicsRunningProcesses_v2");
 
-    while(fgets(line,sizeof(line),fp)){
-        if(strncmp(line,"VmRSS:",6)==0){
-            sscanf(line,"VmRSS: %lu",&memory);              //memory value in kb
+    if (api.init == NULL || api.device_count == NULL || api.device_handle == NULL ||
+        api.utilization == NULL || api.memory_info == NULL || api.init() != NVML_SUCCESS ||
+        api.device_count(&api.count) != NVML_SUCCESS || api.count == 0) {
+        dlclose(lib);
+        return -1;
+    }
+
+    if (api.count > MAX_GPUS) api.count = MAX_GPUS;
+    for (unsigned int i = 0; i < api.count; i++) {
+        if (api.device_handle(i, &api.devices[i]) != NVML_SUCCESS) {
+            api.count = i;
             break;
         }
+        if (api.device_name == NULL ||
+            api.device_name(api.devices[i], api.names[i], NVML_DEVICE_NAME_SIZE) != NVML_SUCCESS) {
+            snprintf(api.names[i], NVML_DEVICE_NAME_SIZE, "GPU %u", i);
+        }
     }
-    fclose(fp);
-        return memory;
+    if (api.count == 0) {
+        dlclose(lib);
+        return -1;
+    }
+
+    nvml = api;
+    return 0;
+}
+
+// Collect per-process GPU memory for one device into gpu_procs
+static void nvml_sample_processes(int index) {
+    for (int kind = 0; kind < 2; kind++) {
+        if (nvml.running_processes[kind] == NULL) continue;
+
+        nvml_process_info infos[MAX_GPU_PROCESSES];
+        unsigned int n = MAX_GPU_PROCESSES;
+        if (nvml.running_processes[kind](nvml.devices[index], &n, infos) != NVML_SUCCESS) continue;
+
+        for (unsigned int i = 0; i < n && gpu_proc_count < MAX_GPUS * MAX_GPU_PROCESSES; i++) {
+            // A process using both compute and graphics is reported twice with the same total
+            int duplicate = 0;
+            for (int j = gpu_proc_count - 1; j >= 0 && gpu_procs[j].gpu_index == index; j--) {
+                if (gpu_procs[j].pid == (int)infos[i].pid) {
+                    duplicate = 1;
+                    break;
+                }
+            }
+            if (duplicate) continue;
+
+            gpu_procs[gpu_proc_count++] = (gpu_process_info){
+                .gpu_index = index,
+                .pid = (int)infos[i].pid,
+                .mem_used = (unsigned long)(infos[i].used_gpu_memory / (1024 * 1024))
+            };
+        }
+    }
+}
+
+// Get NVIDIA GPU information through NVML (no fork, driver stays initialized)
+int get_gpu_info_nvml(gpu_info *gpus, int max_gpus) {
+    int gpu_count = 0;
+    gpu_proc_count = 0;
+
+    for (unsigned int i = 0; i < nvml.count && gpu_count < max_gpus; i++) {
+        gpu_info *g = &gpus[gpu_count];
+        nvml_device dev = nvml.devices[i];
+        nvml_utilization util = {0};
+        nvml_memory mem = {0};
+        unsigned int temp = 0, power = 0, limit = 0;
+
+        if (nvml.utilization(dev, &util) != NVML_SUCCESS) continue;
+        nvml.memory_info(dev, &mem);
+        if (nvml.temperature) nvml.temperature(dev, NVML_TEMPERATURE_GPU, &temp);
+        if (nvml.power_usage) nvml.power_usage(dev, &power);
+        if (nvml.power_limit) nvml.power_limit(dev, &limit);
+
+        g->index = (int)i;
+        snprintf(g->name, NAME_SIZE, "%s", nvml.names[i]);
+        g->utilization = (int)util.gpu;
+        g->mem_used = (unsigned long)(mem.used / (1024 * 1024));
+        g->mem_total = (unsigned long)(mem.total / (1024 * 1024));
+        g->temperature = (int)temp;
+        g->power_usage = (int)(power / 1000);
+        g->power_limit = (int)(limit / 1000);
 
+        nvml_sample_processes((int)i);
+        gpu_count++;
+    }
+
+    return gpu_count;
 }
 
-// Get NVIDIA GPU information using nvidia-smi
 int get_gpu_info(gpu_info *gpus, int max_gpus) {
+    if (nvml.lib != NULL) return get_gpu_info_nvml(gpus, max_gpus);
+    return get_gpu_info_smi(gpus, max_gpus);
+}
+
+// Get NVIDIA GPU information using nvidia-smi (fallback when NVML cannot be loaded)
+int get_gpu_info_smi(gpu_info *gpus, int max_gpus) {
     FILE *fp = popen("nvidia-smi --query-gpu=index,name,utilization.gpu,memory.used,memory.total,temperature.gpu,power.draw,power.limit --format=csv,noheader,nounits 2>/dev/null", "r");
     if (fp == NULL) {
         return 0;
@@ -249,119 +1346,3564 @@ int get_gpu_info(gpu_info *gpus, int max_gpus) {
     return gpu_count;
 }
 
+// GPU sampler: may block for a long time in nvidia-smi, which only delays GPU updates
+void sample_gpu_info(void) {
+    gpu_count = get_gpu_info(gpus, MAX_GPUS);
+}
+
 // Output GPU information
-void output_gpu_info(void) {
-    gpu_info gpus[MAX_GPUS];
-    int gpu_count = get_gpu_info(gpus, MAX_GPUS);
+void output_gpu_info(output_block *out) {
+    if (gpu_count > 0 && format == FORMAT_BINARY) {
+        gpu_record records[MAX_GPUS];
+        for (int i = 0; i < gpu_count; i++) {
+            records[i] = (gpu_record){
+                .mem_used = gpus[i].mem_used,
+                .mem_total = gpus[i].mem_total,
+                .index = gpus[i].index,
+                .name_id = name_dict_id(gpus[i].name, strlen(gpus[i].name)),
+                .utilization = gpus[i].utilization,
+                .temperature = gpus[i].temperature,
+                .power_usage = gpus[i].power_usage,
+                .power_limit = gpus[i].power_limit
+            };
+        }
+        flush_pending_names(out);
+        frame_begin(out, FRAME_GPU);
+        frame_append(out, records, gpu_count * sizeof(gpu_record));
+        frame_end(out, gpu_count);
 
-    if (gpu_count > 0) {
-        printf("GPU_START\n");
+        if (nvml.lib != NULL) {
+            frame_begin(out, FRAME_GPU_PROCESSES);
+            for (int i = 0; i < gpu_proc_count; i++) {
+                gpu_process_record r = {
+                    .mem_used = gpu_procs[i].mem_used,
+                    .gpu_index = gpu_procs[i].gpu_index,
+                    .pid = gpu_procs[i].pid
+                };
+                frame_append(out, &r, sizeof(r));
+            }
+            frame_end(out, gpu_proc_count);
+        }
+    } else if (gpu_count > 0 && format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"gpu\",\"gpus\":[");
         for (int i = 0; i < gpu_count; i++) {
-            printf("GPU|%d|%s|%d|%lu|%lu|%d|%d|%d\n",
-                   gpus[i].index,
-                   gpus[i].name,
-                   gpus[i].utilization,
-                   gpus[i].mem_used,
-                   gpus[i].mem_total,
-                   gpus[i].temperature,
-                   gpus[i].power_usage,
-                   gpus[i].power_limit);
+            block_printf(out, "%s{\"index\":%d,\"name\":\"", i ? "," : "", gpus[i].index);
+            block_escaped(out, gpus[i].name, 1);
+            block_printf(out, "\",\"utilization\":%d,\"mem_used_mb\":%lu,\"mem_total_mb\":%lu,"
+                         "\"temperature\":%d,\"power_w\":%d,\"power_limit_w\":%d}",
+                         gpus[i].utilization, gpus[i].mem_used, gpus[i].mem_total,
+                         gpus[i].temperature, gpus[i].power_usage, gpus[i].power_limit);
+        }
+        block_printf(out, "],\"processes\":[");
+        for (int i = 0; i < gpu_proc_count; i++) {
+            block_printf(out, "%s{\"gpu\":%d,\"pid\":%d,\"mem_used_mb\":%lu}", i ? "," : "",
+                         gpu_procs[i].gpu_index, gpu_procs[i].pid, gpu_procs[i].mem_used);
+        }
+        block_printf(out, "]}\n");
+    } else if (gpu_count > 0) {
+        block_printf(out, "GPU_START\n");
+        for (int i = 0; i < gpu_count; i++) {
+            block_printf(out, "GPU|%d|%s|%d|%lu|%lu|%d|%d|%d\n",
+                         gpus[i].index,
+                         gpus[i].name,
+                         gpus[i].utilization,
+                         gpus[i].mem_used,
+                         gpus[i].mem_total,
+                         gpus[i].temperature,
+                         gpus[i].power_usage,
+                         gpus[i].power_limit);
+        }
+        for (int i = 0; i < gpu_proc_count; i++) {
+            block_printf(out, "GPU_PROC|%d|%d|%lu\n", gpu_procs[i].gpu_index, gpu_procs[i].pid, gpu_procs[i].mem_used);
         }
-        printf("GPU_END\n");
-        fflush(stdout);
+        block_printf(out, "GPU_END\n");
     }
 }
 
 
-void read_process_info(void) {
-    DIR *dir = opendir("/proc");
-    if (dir == NULL) {
-        printf("Error: Cannot open /proc directory\n");
-        return;
+// Read the aggregate and per-CPU lines of /proc/stat in one pass. Returns the
+// number of CPU lines (at most max_cores are stored in cores, which may be
+// NULL), or -1 if /proc/stat cannot be read. If totals is not NULL, reading
+// continues to the procs_running / procs_blocked lines near the end.
+int read_cpu_stat(cpu_times *total, cpu_times *cores, int max_cores, process_totals_record *totals) {
+    char path[PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/stat", proc_root);
+    FILE *fp = counted_fopen(path);
+    if (fp == NULL) return -1;
+
+    char line[LINE_SIZE];
+    int count = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (strncmp(line, "cpu", 3) != 0) {
+            // The cpu lines come first; without totals nothing after them is needed.
+            // Long lines (intr) arrive in pieces, none of which start with "procs_".
+            if (totals == NULL) break;
+            unsigned int value;
+            if (sscanf(line, "procs_running %u", &value) == 1) totals->running = value;
+            else if (sscanf(line, "procs_blocked %u", &value) == 1) {
+                totals->blocked = value;
+                break;
+            }
+            continue;
+        }
+
+        cpu_times t = {0};
+        int cpu = -1;
+        if (isdigit((unsigned char)line[3])) {
+            sscanf(line + 3, "%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu,
+                   &t.user, &t.nice, &t.system, &t.idle, &t.iowait, &t.irq, &t.softirq, &t.steal);
+            if (cores != NULL && count < max_cores) cores[count] = t;
+            count++;
+        } else {
+            sscanf(line + 3, "%llu %llu %llu %llu %llu %llu %llu %llu",
+                   &t.user, &t.nice, &t.system, &t.idle, &t.iowait, &t.irq, &t.softirq, &t.steal);
+            *total = t;
+        }
     }
-    
-    unsigned long long delta_total_cpu;
-    get_total_cpu_time(&delta_total_cpu);
-    
-    p_count = 0;
-    struct dirent *entry;
-    
+
+    fclose(fp);
+    return count;
+}
+
+unsigned long long cpu_times_sum(const cpu_times *t) {
+    return t->user + t->nice + t->system + t->idle + t->iowait + t->irq + t->softirq + t->steal;
+}
+
+// Share of each kind of time between two samples; iowait counts as idle in usage
+static void cpu_breakdown(const cpu_times *now, const cpu_times *last, cpu_core_record *out) {
+    *out = (cpu_core_record){0};
+    unsigned long long total = cpu_times_sum(now) - cpu_times_sum(last);
+    unsigned long long idle = (now->idle + now->iowait) - (last->idle + last->iowait);
+    if (total == 0 || idle > total) return;     // no time passed, or the CPU went offline
+
+    double scale = 100.0 / total;
+    out->usage = (float)((total - idle) * scale);
+    out->user = (float)(((now->user + now->nice) - (last->user + last->nice)) * scale);
+    out->system = (float)((now->system - last->system) * scale);
+    out->iowait = (float)((now->iowait - last->iowait) * scale);
+    out->irq = (float)(((now->irq + now->softirq) - (last->irq + last->softirq)) * scale);
+    out->steal = (float)((now->steal - last->steal) * scale);
+}
+
+static void read_meminfo(system_record *r) {
+    FILE *fp = counted_fopen("/proc/meminfo");
+    if (fp == NULL) return;
+
+    char line[LINE_SIZE];
+    unsigned long long cached = 0, reclaimable = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long long kb;
+        char key[64];
+        if (sscanf(line, "%63[^:]: %llu", key, &kb) != 2) continue;
+
+        if (strcmp(key, "MemTotal") == 0) r->mem_total = kb;
+        else if (strcmp(key, "MemFree") == 0) r->mem_free = kb;
+        else if (strcmp(key, "MemAvailable") == 0) r->mem_available = kb;
+        else if (strcmp(key, "Buffers") == 0) r->mem_buffers = kb;
+        else if (strcmp(key, "Cached") == 0) cached = kb;
+        else if (strcmp(key, "SReclaimable") == 0) reclaimable = kb;
+    }
+    r->mem_cached = cached + reclaimable;
+    fclose(fp);
+}
+
+// Sum whole disks only: partitions and device-mapper volumes would count the same I/O twice
+static void read_diskstats(system_record *r) {
+    FILE *fp = counted_fopen("/proc/diskstats");
+    if (fp == NULL) return;
+
+    char line[LINE_SIZE];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char name[64], path[PATH_SIZE];
+        unsigned long long sectors_read, sectors_written;
+        if (sscanf(line, "%*u %*u %63s %*u %*u %llu %*u %*u %*u %llu",
+                   name, &sectors_read, &sectors_written) != 3) continue;
+        if (strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0 || strncmp(name, "dm-", 3) == 0) continue;
+
+        snprintf(path, sizeof(path), "/sys/block/%s", name);
+        if (access(path, F_OK) != 0) continue;     // a partition
+
+        r->disk_read += sectors_read * DISK_SECTOR_SIZE;
+        r->disk_written += sectors_written * DISK_SECTOR_SIZE;
+    }
+    fclose(fp);
+}
+
+static void read_net_dev(system_record *r) {
+    FILE *fp = counted_fopen("/proc/net/dev");
+    if (fp == NULL) return;
+
+    char line[LINE_SIZE];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *colon = strchr(line, ':');
+        if (colon == NULL) continue;               // the two header lines
+        *colon = '\0';
+
+        char *iface = line;
+        while (*iface == ' ') iface++;
+        if (strcmp(iface, "lo") == 0) continue;
+
+        unsigned long long received, sent;
+        if (sscanf(colon + 1, "%llu %*u %*u %*u %*u %*u %*u %*u %llu", &received, &sent) != 2) continue;
+        r->net_received += received;
+        r->net_sent += sent;
+    }
+    fclose(fp);
+}
+
+static int read_sysfs_long(const char *path, long *out) {
+    int fd = counted_openat(AT_FDCWD, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    char buf[32];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    *out = strtol(buf, NULL, 10);
+    return 0;
+}
+
+// Pick the CPU package sensor once: CPU drivers first, then any hwmon temp1
+static void probe_cpu_temp(void) {
+    static const char *const preferred[] = { "coretemp", "k10temp", "zenpower", "cpu_thermal", "acpitz" };
+    int best = -1;
+    cpu_temp_probed = 1;
+
+    DIR *dir = opendir("/sys/class/hwmon");
+    if (dir == NULL) return;
+
+    struct dirent *entry;
     while ((entry = readdir(dir)) != NULL) {
-        if (!isdigit(entry->d_name[0])) continue;
-        if (p_count >= MAX_PROCESSES) break;
-        
-        int pid = atoi(entry->d_name);
-        
-        // process_name
-        
-        char name[NAME_SIZE];
-        if (get_process_name(pid, name, sizeof(name)) != 0) continue;
-        
-        // process state and time
-        
-        char state;
-        unsigned long long utime, stime;
-        if (get_process_state_and_times(pid, &state, &utime, &stime) != 0) continue;
-        
-        // cpu usage
-        
-        float cpu_usage = calculate_cpu_usage(pid, utime + stime, delta_total_cpu);
-        
-        // thread_count
-        
-        int threads = get_process_threads(pid);
-        
-        unsigned long memory = get_process_memory(pid);
-        
-        // Store process information
-        plist[p_count] = (process_info){
-            .pid = pid,
-            .state = state,
-            .cpu_usage = cpu_usage,
-            .threads = threads,
-            .memory = memory
+        if (entry->d_name[0] == '.') continue;
+
+        char path[PATH_SIZE + NAME_SIZE], name[64] = "";
+        snprintf(path, sizeof(path), "/sys/class/hwmon/%s/name", entry->d_name);
+        FILE *fp = fopen(path, "r");
+        if (fp == NULL) continue;
+        if (fgets(name, sizeof(name), fp) != NULL) name[strcspn(name, "\n")] = '\0';
+        fclose(fp);
+
+        snprintf(path, sizeof(path), "/sys/class/hwmon/%s/temp1_input", entry->d_name);
+        if (access(path, R_OK) != 0) continue;
+
+        int rank = (int)(sizeof(preferred) / sizeof(preferred[0]));
+        for (int i = 0; i < rank; i++) {
+            if (strcmp(name, preferred[i]) == 0) {
+                rank = i;
+                break;
+            }
+        }
+        if (best < 0 || rank < best) {
+            best = rank;
+            snprintf(cpu_temp_path, sizeof(cpu_temp_path), "%s", path);
+        }
+    }
+    closedir(dir);
+}
+
+// Average current frequency over the CPUs that expose cpufreq, in MHz
+static uint32_t read_cpu_freq(int cpus) {
+    unsigned long long sum = 0;
+    int n = 0;
+    for (int i = 0; i < cpus; i++) {
+        char path[PATH_SIZE];
+        long khz;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", i);
+        if (read_sysfs_long(path, &khz) != 0) continue;
+        sum += khz;
+        n++;
+    }
+    return n ? (uint32_t)(sum / n / 1000) : 0;
+}
+
+// Map the history file, laying it out afresh if it is new or its layout differs.
+// The file stays locked while the backend runs, so a second instance cannot
+// interleave its samples.
+int history_open(const char *path) {
+    history_header want = {
+        .magic = HISTORY_MAGIC,
+        .version = HISTORY_VERSION,
+        .metrics = HISTORY_METRICS,
+        .tier_count = HISTORY_TIERS
+    };
+    size_t size = sizeof(history_header);
+    for (int t = 0; t < HISTORY_TIERS; t++) {
+        want.tiers[t] = (history_tier){
+            .step_s = history_tier_config[t][0],
+            .slots = history_tier_config[t][1],
+            .offset = size
+        };
+        size += (size_t)HISTORY_METRICS * history_tier_config[t][1] * sizeof(history_slot);
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct stat st;
+    int fresh = fstat(fd, &st) != 0 || (size_t)st.st_size != size;
+    if (fresh && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    history_header *h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (h == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    // fd is left open: it holds the lock for the lifetime of the backend
+
+    if (!fresh) {
+        fresh = h->magic != want.magic || h->version != want.version ||
+                h->metrics != want.metrics || h->tier_count != want.tier_count;
+        for (int t = 0; t < HISTORY_TIERS && !fresh; t++) {
+            fresh = h->tiers[t].step_s != want.tiers[t].step_s || h->tiers[t].slots != want.tiers[t].slots ||
+                    h->tiers[t].offset != want.tiers[t].offset ||
+                    h->tiers[t].head >= h->tiers[t].slots;
+        }
+    }
+    if (fresh) {
+        history_slot gap = { NAN, NAN, NAN };
+        history_slot *slots = (history_slot *)(h + 1);
+        size_t count = (size - sizeof(history_header)) / sizeof(history_slot);
+        for (size_t i = 0; i < count; i++) slots[i] = gap;
+        want.seq = h->seq + (h->seq & 1);       // stay even and moving for readers of the old layout
+        *h = want;
+    }
+
+    history = h;
+    return 0;
+}
+
+// Merge one sample of every metric into the slot covering now (unix seconds)
+// in each tier. Intervals no sample reached, e.g. while the backend was not
+// running, are left as gaps.
+void history_add(const float *values, uint64_t now) {
+    if (history == NULL) return;
+
+    uint32_t seq = history->seq;
+    __atomic_store_n(&history->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    history_slot gap = { NAN, NAN, NAN };
+    for (int t = 0; t < HISTORY_TIERS; t++) {
+        history_tier *tier = &history->tiers[t];
+        history_slot *rings = (history_slot *)((char *)history + tier->offset);
+        uint64_t slot_time = now - now % tier->step_s;
+
+        // A clock stepping backwards merges into the newest slot
+        if (tier->head_time == 0 || slot_time > tier->head_time) {
+            uint64_t advance = tier->head_time == 0 ? 1 : (slot_time - tier->head_time) / tier->step_s;
+            if (advance > tier->slots) advance = tier->slots;
+            for (uint64_t i = 1; i < advance; i++) {
+                uint32_t index = (uint32_t)((tier->head + i) % tier->slots);
+                for (int m = 0; m < HISTORY_METRICS; m++) rings[(size_t)m * tier->slots + index] = gap;
+            }
+            tier->head = (uint32_t)((tier->head + advance) % tier->slots);
+            tier->head_time = slot_time;
+            tier->head_samples = 0;
+        }
+
+        uint32_t n = ++tier->head_samples;
+        for (int m = 0; m < HISTORY_METRICS; m++) {
+            history_slot *slot = &rings[(size_t)m * tier->slots + tier->head];
+            float v = values[m];
+            if (n == 1) {
+                *slot = (history_slot){ v, v, v };
+            } else {
+                if (v < slot->min) slot->min = v;
+                if (v > slot->max) slot->max = v;
+                slot->avg += (v - slot->avg) / (float)n;
+            }
+        }
+    }
+
+    __atomic_store_n(&history->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Counter growth per second; a counter that went backwards (device removed) counts as 0
+static float counter_rate(uint64_t now, uint64_t last, double elapsed) {
+    return now > last ? (float)((now - last) / elapsed) : 0.0f;
+}
+
+// System sampler: everything PerformanceView used to poll through psutil
+void sample_system_info(void) {
+    system_record r = {0};
+
+    cpu_times total, cores[MAX_CPUS];
+    int n = read_cpu_stat(&total, cores, MAX_CPUS, NULL);
+    if (n > MAX_CPUS) n = MAX_CPUS;
+    if (n >= 0) {
+        int first = cpu_times_sum(&sys_last_cpu) == 0;
+        cpu_core_record all = {0};
+        if (!first) cpu_breakdown(&total, &sys_last_cpu, &all);
+        r.cpu_usage = all.usage;
+        r.cpu_user = all.user;
+        r.cpu_system = all.system;
+        r.cpu_iowait = all.iowait;
+        r.cpu_irq = all.irq;
+        r.cpu_steal = all.steal;
+
+        for (int i = 0; i < n; i++) {
+            // A CPU that just came online has no previous sample
+            if (first || i >= sys_core_count) sys_cores[i] = (cpu_core_record){0};
+            else cpu_breakdown(&cores[i], &sys_last_cores[i], &sys_cores[i]);
+            sys_last_cores[i] = cores[i];
+        }
+        sys_last_cpu = total;
+        sys_core_count = n;
+    }
+
+    read_meminfo(&r);
+    read_diskstats(&r);
+    read_net_dev(&r);
+
+    struct statvfs fs;
+    if (statvfs("/", &fs) == 0) {
+        r.fs_total = (uint64_t)fs.f_blocks * fs.f_frsize;
+        r.fs_free = (uint64_t)fs.f_bfree * fs.f_frsize;
+        r.fs_avail = (uint64_t)fs.f_bavail * fs.f_frsize;
+    }
+
+    FILE *fp = counted_fopen("/proc/uptime");
+    if (fp != NULL) {
+        double uptime;
+        if (fscanf(fp, "%lf", &uptime) == 1) r.uptime = (uint64_t)uptime;
+        fclose(fp);
+    }
+
+    if (!cpu_temp_probed) probe_cpu_temp();
+    long millideg;
+    if (cpu_temp_path[0] != '\0' && read_sysfs_long(cpu_temp_path, &millideg) == 0) r.temperature = (int32_t)millideg;
+
+    r.cpu_freq = read_cpu_freq(sys_core_count);
+
+    // History needs a previous sample for the CPU share and the rates
+    uint64_t now_ns = monotonic_ns();
+    if (history != NULL && sys_last_ns != 0 && r.mem_total != 0) {
+        double elapsed = (now_ns - sys_last_ns) / 1e9;
+        float values[HISTORY_METRICS] = {
+            [HISTORY_CPU] = r.cpu_usage,
+            [HISTORY_MEMORY] = (float)((r.mem_total - r.mem_available) * 100.0 / r.mem_total),
+            [HISTORY_DISK_READ] = counter_rate(r.disk_read, sys_sample.disk_read, elapsed),
+            [HISTORY_DISK_WRITTEN] = counter_rate(r.disk_written, sys_sample.disk_written, elapsed),
+            [HISTORY_NET_RECEIVED] = counter_rate(r.net_received, sys_sample.net_received, elapsed),
+            [HISTORY_NET_SENT] = counter_rate(r.net_sent, sys_sample.net_sent, elapsed),
         };
-        strncpy(plist[p_count].name, name, NAME_SIZE - 1);
-        plist[p_count].name[NAME_SIZE - 1] = '\0';
+        history_add(values, (uint64_t)time(NULL));
+    }
+    sys_last_ns = now_ns;
+    sys_sample = r;
+}
+
+void output_system_info(output_block *out) {
+    const system_record *r = &sys_sample;
+
+    if (format == FORMAT_BINARY) {
+        frame_begin(out, FRAME_SYSTEM);
+        frame_append(out, r, sizeof(*r));
+        frame_end(out, 1);
+
+        frame_begin(out, FRAME_CPU_CORES);
+        frame_append(out, sys_cores, (size_t)sys_core_count * sizeof(cpu_core_record));
+        frame_end(out, (uint32_t)sys_core_count);
+    } else if (format == FORMAT_JSONL) {
+        // Same names as the text protocol's SYSTEM_FIELDS
+        block_printf(out, "{\"type\":\"system\",\"mem_total\":%llu,\"mem_free\":%llu,\"mem_available\":%llu,"
+                     "\"mem_cached\":%llu,\"mem_buffers\":%llu,",
+                     (unsigned long long)r->mem_total, (unsigned long long)r->mem_free,
+                     (unsigned long long)r->mem_available, (unsigned long long)r->mem_cached,
+                     (unsigned long long)r->mem_buffers);
+        block_printf(out, "\"disk_read\":%llu,\"disk_written\":%llu,\"fs_total\":%llu,\"fs_free\":%llu,"
+                     "\"fs_avail\":%llu,\"net_received\":%llu,\"net_sent\":%llu,\"uptime\":%llu,",
+                     (unsigned long long)r->disk_read, (unsigned long long)r->disk_written,
+                     (unsigned long long)r->fs_total, (unsigned long long)r->fs_free,
+                     (unsigned long long)r->fs_avail,
+                     (unsigned long long)r->net_received, (unsigned long long)r->net_sent,
+                     (unsigned long long)r->uptime);
+        block_printf(out, "\"cpu_usage\":%.2f,\"cpu_user\":%.2f,\"cpu_system\":%.2f,\"cpu_iowait\":%.2f,"
+                     "\"cpu_irq\":%.2f,\"cpu_steal\":%.2f,\"cpu_freq\":%u,\"temperature\":%d,\"cores\":[",
+                     r->cpu_usage, r->cpu_user, r->cpu_system, r->cpu_iowait, r->cpu_irq, r->cpu_steal,
+                     r->cpu_freq, r->temperature);
+        for (int i = 0; i < sys_core_count; i++) {
+            const cpu_core_record *c = &sys_cores[i];
+            block_printf(out, "%s{\"usage\":%.2f,\"user\":%.2f,\"system\":%.2f,\"iowait\":%.2f,"
+                         "\"irq\":%.2f,\"steal\":%.2f}",
+                         i ? "," : "", c->usage, c->user, c->system, c->iowait, c->irq, c->steal);
+        }
+        block_printf(out, "]}\n");
+    } else {
+        // Same field order as system_record
+        block_printf(out, "SYSTEM|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu"
+                     "|%.2f|%.2f|%.2f|%.2f|%.2f|%.2f|%u|%d\n",
+                     (unsigned long long)r->mem_total, (unsigned long long)r->mem_free,
+                     (unsigned long long)r->mem_available, (unsigned long long)r->mem_cached,
+                     (unsigned long long)r->mem_buffers,
+                     (unsigned long long)r->disk_read, (unsigned long long)r->disk_written,
+                     (unsigned long long)r->fs_total, (unsigned long long)r->fs_free,
+                     (unsigned long long)r->fs_avail,
+                     (unsigned long long)r->net_received, (unsigned long long)r->net_sent,
+                     (unsigned long long)r->uptime,
+                     r->cpu_usage, r->cpu_user, r->cpu_system, r->cpu_iowait, r->cpu_irq, r->cpu_steal,
+                     r->cpu_freq, r->temperature);
+        block_printf(out, "CPU_CORES");
+        for (int i = 0; i < sys_core_count; i++) {
+            const cpu_core_record *c = &sys_cores[i];
+            block_printf(out, "|%.2f,%.2f,%.2f,%.2f,%.2f,%.2f", c->usage, c->user, c->system, c->iowait, c->irq, c->steal);
+        }
+        block_printf(out, "\n");
+    }
+}
+
+// Busiest first; ties broken by pid so the order is stable between ticks
+int compare_cpu_desc(const void *a, const void *b) {
+    const process_info *pa = *(process_info *const *)a;
+    const process_info *pb = *(process_info *const *)b;
+
+    if (pa->cpu_usage != pb->cpu_usage) return pa->cpu_usage < pb->cpu_usage ? 1 : -1;
+    return (pa->pid > pb->pid) - (pa->pid < pb->pid);
+}
+
+// Quickselect: move the k highest-ranked items to items[0..k), unordered. O(n) on average.
+void select_top_k(process_info **items, int n, int k) {
+    int lo = 0, hi = n - 1;
+
+    while (lo < hi) {
+        // Median-of-three pivot keeps already-sorted input from going quadratic
+        int mid = lo + (hi - lo) / 2;
+        if (compare_cpu_desc(&items[mid], &items[lo]) < 0) { process_info *t = items[mid]; items[mid] = items[lo]; items[lo] = t; }
+        if (compare_cpu_desc(&items[hi], &items[lo]) < 0) { process_info *t = items[hi]; items[hi] = items[lo]; items[lo] = t; }
+        if (compare_cpu_desc(&items[hi], &items[mid]) < 0) { process_info *t = items[hi]; items[hi] = items[mid]; items[mid] = t; }
+        process_info *pivot = items[mid];
+
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (compare_cpu_desc(&items[i], &pivot) < 0) i++;
+            while (compare_cpu_desc(&items[j], &pivot) > 0) j--;
+            if (i <= j) {
+                process_info *t = items[i]; items[i] = items[j]; items[j] = t;
+                i++;
+                j--;
+            }
+        }
+
+        // items[lo..j] rank before items[i..hi]; keep only the side holding position k
+        if (k - 1 <= j) hi = j;
+        else if (k - 1 >= i) lo = i;
+        else break;
+    }
+}
+
+// Order the snapshot through a pointer array instead of moving the records
+int sort_processes(void) {
+    arena_reset(&order_arena);
+    porder = arena_alloc(&order_arena, (size_t)p_count * sizeof(process_info *));
+    if (porder == NULL && p_count > 0) return -1;
+
+    for (int i = 0; i < p_count; i++) porder[i] = &plist[i];
+
+    order_count = p_count;
+    if (top_k > 0 && top_k < p_count) {
+        select_top_k(porder, p_count, top_k);
+        order_count = top_k;
+    }
+    qsort(porder, order_count, sizeof(process_info *), compare_cpu_desc);
+
+    return 0;
+}
+
+static uint32_t hash_name(const char *name, size_t len) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Double a name_slot table (the name dictionary or cgroup_dict)
+static int name_table_grow(name_slot **dict, size_t *dict_size) {
+    size_t new_size = *dict_size ? *dict_size * 2 : NAME_DICT_INITIAL_SIZE;
+    name_slot *table = calloc(new_size, sizeof(name_slot));
+    if (table == NULL) return -1;
+
+    for (size_t i = 0; i < *dict_size; i++) {
+        if ((*dict)[i].id == 0) continue;
+        size_t slot = (*dict)[i].hash & (new_size - 1);
+        while (table[slot].id != 0) slot = (slot + 1) & (new_size - 1);
+        table[slot] = (*dict)[i];
+    }
+
+    free(*dict);
+    *dict = table;
+    *dict_size = new_size;
+    return 0;
+}
+
+// Return the dictionary id for name, queueing a FRAME_NAMES entry the first
+// time it is seen. Returns 0 if the name could not be stored.
+uint32_t name_dict_id(const char *name, size_t len) {
+    if ((name_dict_count + 1) * 2 > name_dict_size && name_table_grow(&name_dict, &name_dict_size) != 0) return 0;
+    if (len > UINT16_MAX) len = UINT16_MAX;
+
+    uint32_t h = hash_name(name, len);
+    size_t slot = h & (name_dict_size - 1);
+    while (name_dict[slot].id != 0) {
+        const char *existing = name_dict_strings.data + name_dict[slot].off;
+        if (name_dict[slot].hash == h && strncmp(existing, name, len) == 0 && existing[len] == '\0') {
+            return name_dict[slot].id;
+        }
+        slot = (slot + 1) & (name_dict_size - 1);
+    }
+
+    char *stored = arena_alloc(&name_dict_strings, len + 1);
+    char *entry = arena_alloc(&pending_names, sizeof(uint32_t) + sizeof(uint16_t) + len);
+    if (stored == NULL || entry == NULL) return 0;
+    memcpy(stored, name, len);
+    stored[len] = '\0';
+
+    uint32_t id = ++name_dict_count;
+    uint16_t len16 = (uint16_t)len;
+    memcpy(entry, &id, sizeof(id));
+    memcpy(entry + sizeof(id), &len16, sizeof(len16));
+    memcpy(entry + sizeof(id) + sizeof(len16), name, len);
+    pending_name_count++;
+
+    name_dict[slot] = (name_slot){
+        .hash = h,
+        .id = id,
+        .off = (uint32_t)(stored - name_dict_strings.data)
+    };
+    return id;
+}
+
+// Forget every name, so ids sent before are reused. Names of processes that
+// have exited would otherwise stay in the dictionary (and the client's) for
+// good. Only before a full snapshot: delta and GPU / cgroup frames look their
+// ids up again on every frame, and the client drops its map on the flag.
+static void name_dict_expire(void) {
+    if (name_dict_count < name_dict_reset_at) return;
+    memset(name_dict, 0, name_dict_size * sizeof(name_slot));
+    name_dict_count = 0;
+    arena_reset(&name_dict_strings);
+    arena_reset(&pending_names);
+    pending_name_count = 0;
+    name_dict_cleared = 1;
+}
+
+// Return a stable handle for a cgroup path, storing it the first time.
+// Process sampler only; the path goes out through name_dict_id() when sent.
+// Returns 0 if it could not be stored.
+uint32_t cgroup_intern(const char *path, size_t len) {
+    if ((cgroup_dict_count + 1) * 2 > cgroup_dict_size && name_table_grow(&cgroup_dict, &cgroup_dict_size) != 0) return 0;
+
+    uint32_t h = hash_name(path, len);
+    size_t slot = h & (cgroup_dict_size - 1);
+    while (cgroup_dict[slot].id != 0) {
+        const char *existing = cgroup_strings.data + cgroup_dict[slot].off;
+        if (cgroup_dict[slot].hash == h && strncmp(existing, path, len) == 0 && existing[len] == '\0') {
+            return cgroup_dict[slot].id;
+        }
+        slot = (slot + 1) & (cgroup_dict_size - 1);
+    }
+
+    char *stored = arena_alloc(&cgroup_strings, len + 1);
+    if (stored == NULL) return 0;
+    memcpy(stored, path, len);
+    stored[len] = '\0';
+
+    uint32_t off = (uint32_t)(stored - cgroup_strings.data);
+    cgroup_dict[slot] = (name_slot){ .hash = h, .id = off + 1, .off = off };
+    cgroup_dict_count++;
+    return off + 1;
+}
+
+const char *cgroup_path(uint32_t handle) {
+    return handle ? cgroup_strings.data + handle - 1 : "";
+}
+
+// Append a text-protocol line to the block
+void block_printf(output_block *out, const char *fmt, ...) {
+    char line[LINE_SIZE + NAME_SIZE];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (len < 0) return;
+    if ((size_t)len >= sizeof(line)) len = sizeof(line) - 1;
+
+    char *dst = arena_alloc(&out->buf, len);
+    if (dst != NULL) memcpy(dst, line, len);
+}
+
+void block_write(output_block *out, const char *data, size_t len) {
+    char *dst = arena_alloc(&out->buf, len);
+    if (dst != NULL) memcpy(dst, data, len);
+}
+
+// Finish a text line with s, which may be longer than block_printf can format
+// (a cgroup path runs up to PATH_MAX)
+void block_line_end(output_block *out, const char *s) {
+    block_write(out, s, strlen(s));
+    block_write(out, "\n", 1);
+}
+
+// Length of the well-formed UTF-8 sequence starting at s, 0 if there is none
+// (comm is cut at 15 bytes, often in the middle of a character)
+static int utf8_sequence(const unsigned char *s) {
+    int n;
+    if (s[0] < 0x80) return 1;
+    else if (s[0] >= 0xc2 && s[0] <= 0xdf) n = 2;
+    else if (s[0] >= 0xe0 && s[0] <= 0xef) n = 3;
+    else if (s[0] >= 0xf0 && s[0] <= 0xf4) n = 4;
+    else return 0;
+
+    // No overlong forms, surrogates or code points past U+10FFFF
+    if ((s[0] == 0xe0 && s[1] < 0xa0) || (s[0] == 0xed && s[1] >= 0xa0) ||
+        (s[0] == 0xf0 && s[1] < 0x90) || (s[0] == 0xf4 && s[1] >= 0x90)) return 0;
+    for (int i = 1; i < n; i++) {
+        if ((s[i] & 0xc0) != 0x80) return 0;
+    }
+    return n;
+}
+
+// Append s as the inside of a JSON string (json) or a Prometheus label value.
+// Bytes that are not valid UTF-8 become U+FFFD, as both formats require UTF-8.
+void block_escaped(output_block *out, const char *s, int json) {
+    const unsigned char *p = (const unsigned char *)s;
+    const unsigned char *run = p;                // start of bytes copied as-is
+
+    while (*p) {
+        int n = utf8_sequence(p);
+        const char *esc = NULL;
+        char code[8];
+        if (n == 0) esc = "\xef\xbf\xbd";
+        else if (*p == '"') esc = "\\\"";
+        else if (*p == '\\') esc = "\\\\";
+        else if (*p == '\n') esc = "\\n";
+        else if (json && *p < 0x20) {
+            snprintf(code, sizeof(code), "\\u%04x", *p);
+            esc = code;
+        }
+
+        if (esc == NULL) {
+            p += n;
+            continue;
+        }
+        block_write(out, (const char *)run, (size_t)(p - run));
+        block_write(out, esc, strlen(esc));
+        p += n ? n : 1;
+        run = p;
+    }
+    block_write(out, (const char *)run, (size_t)(p - run));
+}
+
+// Start a frame in out->frame; the header is patched in frame_end()
+void frame_begin(output_block *out, uint16_t type) {
+    arena_reset(&out->frame);
+    frame_header *hdr = arena_alloc(&out->frame, sizeof(frame_header));
+    if (hdr == NULL) return;
+    *hdr = (frame_header){ .magic = FRAME_MAGIC, .type = type };
+}
+
+int frame_append(output_block *out, const void *data, size_t size) {
+    if (out->frame.used == 0) return -1;   // header allocation failed
+    void *dst = arena_alloc(&out->frame, size);
+    if (dst == NULL) return -1;
+    memcpy(dst, data, size);
+    return 0;
+}
+
+// Finish the frame and append it to the block
+void frame_end(output_block *out, uint32_t count) {
+    if (out->frame.used == 0) return;
+
+    frame_header *hdr = (frame_header *)out->frame.data;
+    hdr->count = count;
+    hdr->length = (uint32_t)(out->frame.used - sizeof(frame_header));
+
+    char *dst = arena_alloc(&out->buf, out->frame.used);
+    if (dst != NULL) memcpy(dst, out->frame.data, out->frame.used);
+    arena_reset(&out->frame);
+}
+
+// Send dictionary entries queued by name_dict_id() before the frame using them
+void flush_pending_names(output_block *out) {
+    if (pending_name_count == 0 && !name_dict_cleared) return;
+
+    frame_begin(out, FRAME_NAMES);
+    if (name_dict_cleared && out->frame.used != 0) {
+        ((frame_header *)out->frame.data)->flags = FRAME_FLAG_NAMES_RESET;
+        // What the snapshot needs now is live: clear again once it has doubled
+        uint32_t live = name_dict_count * 2;
+        name_dict_reset_at = live > NAME_DICT_RESET_MIN ? live : NAME_DICT_RESET_MIN;
+        name_dict_cleared = 0;
+    }
+    frame_append(out, pending_names.data, pending_names.used);
+    frame_end(out, pending_name_count);
+
+    arena_reset(&pending_names);
+    pending_name_count = 0;
+}
+
+// Lay out the region in fd, an inherited memfd or shared memory file the
+// reader maps too
+int shm_open_region(int fd) {
+    size_t size = sizeof(shm_header) + 2 * SHM_INITIAL_CAPACITY;
+    if (ftruncate(fd, (off_t)size) != 0) return -1;
+
+    shm_header *h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (h == MAP_FAILED) return -1;
+    *h = (shm_header){
+        .magic = SHM_MAGIC,
+        .version = SHM_VERSION,
+        .record_size = sizeof(proc_record),
+        .size = size,
+        .capacity = SHM_INITIAL_CAPACITY
+    };
+
+    shm_fd = fd;
+    shm = h;
+    return 0;
+}
+
+// Start writing a snapshot of count records: returns the buffer to fill, or
+// NULL if the region cannot grow to hold it (nothing is published then)
+proc_record *shm_begin(size_t count) {
+    uint32_t seq = shm->seq;
+    __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    size_t need = count * sizeof(proc_record);
+    if (need > shm->capacity) {
+        uint64_t capacity = shm->capacity;
+        while (capacity < need) capacity *= 2;
+        size_t size = sizeof(shm_header) + 2 * capacity;
+        size_t old_size = shm->size;
+
+        shm_header *h = MAP_FAILED;
+        if (ftruncate(shm_fd, (off_t)size) == 0) {
+            h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        }
+        // Either way the buffers are no longer what a reader started on
+        if (h == MAP_FAILED) {
+            __atomic_store_n(&shm->seq, seq + 4, __ATOMIC_RELEASE);
+            return NULL;
+        }
+        munmap(shm, old_size);
+        shm = h;
+        shm->size = size;
+        shm->capacity = capacity;
+        __atomic_store_n(&shm->seq, seq + 5, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    uint32_t target = (shm->seq / 2 + 1) % 2;
+    return (proc_record *)((char *)(shm + 1) + target * shm->capacity);
+}
+
+// Publish the snapshot started by shm_begin(); returns its sequence number
+uint32_t shm_end(size_t count) {
+    uint32_t seq = shm->seq + 1;
+    shm->count[(seq / 2) % 2] = (uint32_t)count;
+    __atomic_store_n(&shm->seq, seq, __ATOMIC_RELEASE);
+    return seq;
+}
+
+static void fill_proc_record(proc_record *out, const process_info *p, uint8_t kind) {
+    const char *name = process_name(p);
+    const char *cgroup = cgroup_path(p->cgroup);
+    *out = (proc_record){
+        .memory = p->memory,
+        .pid = p->pid,
+        .name_id = name_dict_id(name, strlen(name)),
+        .cpu_usage = p->cpu_usage,
+        .threads = p->threads,
+        .ppid = p->ppid,
+        .session = p->session,
+        .uid = p->uid,
+        .cgroup_id = p->cgroup ? name_dict_id(cgroup, strlen(cgroup)) : 0,
+        .disk_read = p->disk_read,
+        .disk_written = p->disk_written,
+        .net_received = p->net_received,
+        .net_sent = p->net_sent,
+        .pss = p->pss,
+        .uss = p->uss,
+        .start_time = p->start_time * 1000 / clock_ticks,
+        .subtree_memory = p->subtree_memory,
+        .subtree_cpu = p->subtree_cpu,
+        .subtree_disk = p->subtree_disk,
+        .subtree_net = p->subtree_net,
+        .state = p->state,
+        .kind = kind
+    };
+}
+
+// Remember what the client now holds for p
+static void mark_sent(cpu_record_time *rec, const process_info *p) {
+    if (rec == NULL) return;
+    rec->in_client = 1;
+    rec->sent_state = p->state;
+    rec->sent_threads = p->threads;
+    rec->sent_ppid = p->ppid;
+    rec->sent_uid = p->uid;
+    rec->sent_cgroup = p->cgroup;
+    rec->sent_cpu = p->cpu_usage;
+    rec->sent_memory = p->memory;
+    rec->sent_disk_read = p->disk_read;
+    rec->sent_disk_written = p->disk_written;
+    rec->sent_net_received = p->net_received;
+    rec->sent_net_sent = p->net_sent;
+    rec->sent_pss = p->pss;
+    rec->sent_uss = p->uss;
+    rec->sent_subtree_cpu = p->subtree_cpu;
+    rec->sent_subtree_memory = p->subtree_memory;
+    rec->sent_subtree_disk = p->subtree_disk;
+    rec->sent_subtree_net = p->subtree_net;
+    rec->sent_frame = output_frame;
+}
+
+static int rate_changed(float now, float sent) {
+    return fabsf(now - sent) >= DELTA_IO_THRESHOLD;
+}
+
+static int memory_changed(uint32_t now, uint32_t sent) {
+    return (now > sent ? now - sent : sent - now) >= DELTA_MEMORY_THRESHOLD;
+}
+
+static int changed_since_sent(const cpu_record_time *rec, const process_info *p) {
+    float dcpu = p->cpu_usage - rec->sent_cpu;
+    float dsubtree_cpu = p->subtree_cpu - rec->sent_subtree_cpu;
+    unsigned long dsubtree_mem = p->subtree_memory > rec->sent_subtree_memory
+                                 ? p->subtree_memory - rec->sent_subtree_memory
+                                 : rec->sent_subtree_memory - p->subtree_memory;
+    unsigned long dmem = p->memory > rec->sent_memory ? p->memory - rec->sent_memory
+                                                      : rec->sent_memory - p->memory;
+    return p->state != rec->sent_state ||
+           p->threads != rec->sent_threads ||
+           p->ppid != rec->sent_ppid || p->uid != rec->sent_uid || p->cgroup != rec->sent_cgroup ||
+           dcpu >= DELTA_CPU_THRESHOLD || dcpu <= -DELTA_CPU_THRESHOLD ||
+           dmem >= DELTA_MEMORY_THRESHOLD ||
+           rate_changed(p->disk_read, rec->sent_disk_read) ||
+           rate_changed(p->disk_written, rec->sent_disk_written) ||
+           rate_changed(p->net_received, rec->sent_net_received) ||
+           rate_changed(p->net_sent, rec->sent_net_sent) ||
+           memory_changed(p->pss, rec->sent_pss) || memory_changed(p->uss, rec->sent_uss) ||
+           dsubtree_cpu >= DELTA_CPU_THRESHOLD || dsubtree_cpu <= -DELTA_CPU_THRESHOLD ||
+           dsubtree_mem >= DELTA_MEMORY_THRESHOLD ||
+           rate_changed(p->subtree_disk, rec->sent_subtree_disk) ||
+           rate_changed(p->subtree_net, rec->sent_subtree_net);
+}
+
+// With --top, PIDs that dropped out of the top K are removed from the client
+// too (on a keyframe the client replaces everything, so just forget them)
+static size_t collect_dropped(proc_record **out, int keyframe) {
+    size_t count = 0;
+    if (top_k <= 0) return 0;
+
+    for (size_t i = 0; i < cpu_table_size; i++) {
+        cpu_record_time *rec = &cpu_table[i];
+        if (rec->pid == 0 || !rec->in_client || rec->sent_frame == output_frame) continue;
+
+        rec->in_client = 0;
+        if (keyframe) continue;
+
+        proc_record *r = arena_alloc(&record_arena, sizeof(proc_record));
+        if (r == NULL) break;
+        *out = (proc_record *)record_arena.data;   // arena may have moved
+        *r = (proc_record){ .pid = rec->pid, .kind = RECORD_EXIT };
+        count++;
+    }
+
+    return count;
+}
+
+// FRAME_PROCESSES by way of the snapshot region. The names go down the pipe
+// first, so by the time the reader sees the notice it knows every id in it.
+static int output_process_shm(output_block *o) {
+    proc_record *out = shm_begin((size_t)order_count);
+    if (out == NULL) return -1;
+    name_dict_expire();
+    for (int i = 0; i < order_count; i++) {
+        fill_proc_record(&out[i], porder[i], RECORD_UPDATE);
+    }
+    shm_notice_record notice = { .seq = shm_end((size_t)order_count), .count = (uint32_t)order_count };
+
+    flush_pending_names(o);
+    frame_begin(o, FRAME_SHM_PROCESSES);
+    frame_append(o, &notice, sizeof(notice));
+    frame_end(o, 1);
+
+    frame_begin(o, FRAME_PROCESS_TOTALS);
+    frame_append(o, &proc_totals, sizeof(proc_totals));
+    frame_end(o, 1);
+    return 0;
+}
+
+static void output_process_binary(output_block *o) {
+    // A snapshot that does not fit the region goes down the pipe as usual
+    if (shm != NULL && output_process_shm(o) == 0) return;
+
+    output_frame++;
+    int keyframe = !delta_mode || keyframe_interval <= 1 || output_frame % keyframe_interval == 1;
+    if (keyframe) name_dict_expire();
+
+    arena_reset(&record_arena);
+    proc_record *out = arena_alloc(&record_arena, (size_t)order_count * sizeof(proc_record));
+    if (out == NULL && order_count > 0) return;
+
+    size_t count = 0;
+    for (int i = 0; i < order_count; i++) {
+        const process_info *p = porder[i];
+        if (!delta_mode) {
+            fill_proc_record(&out[count++], p, RECORD_UPDATE);
+            continue;
+        }
+
+        cpu_record_time *rec = cpu_table_find(p->pid);
+        if (keyframe) {
+            fill_proc_record(&out[count++], p, RECORD_UPDATE);
+            mark_sent(rec, p);
+        } else if (rec == NULL || !rec->in_client) {
+            fill_proc_record(&out[count++], p, RECORD_NEW);
+            mark_sent(rec, p);
+        } else if (changed_since_sent(rec, p)) {
+            fill_proc_record(&out[count++], p, RECORD_UPDATE);
+            mark_sent(rec, p);
+        } else {
+            rec->sent_frame = output_frame;    // unchanged, but still shown
+        }
+    }
+
+    if (delta_mode) {
+        // Give back unused slots so EXIT records land right after the last one written
+        record_arena.used = count * sizeof(proc_record);
+        count += collect_dropped(&out, keyframe);
+
+        if (!keyframe) {
+            size_t n_exited = exited_pids.used / sizeof(int32_t);
+            for (size_t i = 0; i < n_exited; i++) {
+                proc_record *r = arena_alloc(&record_arena, sizeof(proc_record));
+                if (r == NULL) break;
+                out = (proc_record *)record_arena.data;
+                *r = (proc_record){ .pid = ((int32_t *)exited_pids.data)[i], .kind = RECORD_EXIT };
+                count++;
+            }
+        }
+        arena_reset(&exited_pids);
+    }
+
+    flush_pending_names(o);
+    frame_begin(o, keyframe ? FRAME_PROCESSES : FRAME_PROCESS_DELTA);
+    frame_append(o, out, count * sizeof(proc_record));
+    frame_end(o, (uint32_t)count);
+
+    frame_begin(o, FRAME_PROCESS_TOTALS);
+    frame_append(o, &proc_totals, sizeof(proc_totals));
+    frame_end(o, 1);
+}
+
+static void output_process_text(output_block *out) {
+    // Send ALL processes (no artificial limit to prevent flickering) unless --top is set.
+    // The cgroup path goes last: it is the one field that may contain '|'.
+    for (int i = 0; i < order_count; i++) {
+        const process_info *p = porder[i];
+        block_printf(out, "%d|%s|%c|%.2f|%lu|%d|%u|%d|%d|%.0f|%.0f|%.0f|%.0f|%u|%u|%llu|%.2f|%lu|%.0f|%.0f|",
+                     p->pid,
+                     process_name(p),
+                     p->state,
+                     p->cpu_usage,
+                     p->memory,
+                     p->threads,
+                     p->uid,
+                     p->ppid,
+                     p->session,
+                     p->disk_read,
+                     p->disk_written,
+                     p->net_received,
+                     p->net_sent,
+                     p->pss,
+                     p->uss,
+                     p->start_time * 1000 / clock_ticks,
+                     p->subtree_cpu,
+                     p->subtree_memory,
+                     p->subtree_disk,
+                     p->subtree_net);
+        block_line_end(out, cgroup_path(p->cgroup));
+    }
+    block_printf(out, "END\n");
+    block_printf(out, "TOTALS|%u|%u|%u|%u\n",
+                 proc_totals.processes, proc_totals.threads, proc_totals.running, proc_totals.blocked);
+}
+
+// One line per scan, so a consumer always sees a consistent snapshot
+static void output_process_jsonl(output_block *out) {
+    block_printf(out, "{\"type\":\"processes\",\"processes\":[");
+    for (int i = 0; i < order_count; i++) {
+        const process_info *p = porder[i];
+        block_printf(out, "%s{\"pid\":%d,\"name\":\"", i ? "," : "", p->pid);
+        block_escaped(out, process_name(p), 1);
+        block_printf(out, "\",\"state\":\"%c\",\"cpu\":%.2f,\"memory_kb\":%lu,\"threads\":%d,"
+                     "\"uid\":%u,\"ppid\":%d,\"session\":%d,\"cgroup\":\"",
+                     p->state, p->cpu_usage, p->memory, p->threads, p->uid, p->ppid, p->session);
+        block_escaped(out, cgroup_path(p->cgroup), 1);
+        block_printf(out, "\",\"disk_read_bytes_per_s\":%.0f,\"disk_written_bytes_per_s\":%.0f,"
+                     "\"net_received_bytes_per_s\":%.0f,\"net_sent_bytes_per_s\":%.0f,\"pss_kb\":%u,\"uss_kb\":%u,"
+                     "\"start_time_ms\":%llu,\"subtree\":{\"cpu\":%.2f,\"memory_kb\":%lu,"
+                     "\"disk_bytes_per_s\":%.0f,\"net_bytes_per_s\":%.0f}}",
+                     p->disk_read, p->disk_written, p->net_received, p->net_sent, p->pss, p->uss,
+                     p->start_time * 1000 / clock_ticks, p->subtree_cpu, p->subtree_memory,
+                     p->subtree_disk, p->subtree_net);
+    }
+    block_printf(out, "],\"totals\":{\"processes\":%u,\"threads\":%u,\"running\":%u,\"blocked\":%u}}\n",
+                 proc_totals.processes, proc_totals.threads, proc_totals.running, proc_totals.blocked);
+}
+
+// --cgroups: sent whole after every process frame; they are few next to processes
+static void output_cgroups(output_block *out) {
+    size_t count = cgroups.used / sizeof(cgroup_entry);
+    const cgroup_entry *list = (const cgroup_entry *)cgroups.data;
+
+    if (format == FORMAT_BINARY) {
+        arena_reset(&record_arena);
+        cgroup_record *records = arena_alloc(&record_arena, count * sizeof(cgroup_record));
+        if (records == NULL && count > 0) return;
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            const cgroup_entry *c = &list[i];
+            if (c->sampled_ns == 0) continue;
+            const char *path = cgroup_path(c->cgroup);
+            records[n++] = (cgroup_record){
+                .memory = c->memory,
+                .name_id = name_dict_id(path, strlen(path)),
+                .processes = c->processes,
+                .cpu = c->cpu,
+                .disk_read = c->disk_read,
+                .disk_written = c->disk_written,
+                .cpu_pressure = c->cpu_pressure,
+                .memory_pressure = c->memory_pressure
+            };
+        }
+        flush_pending_names(out);
+        frame_begin(out, FRAME_CGROUPS);
+        frame_append(out, records, n * sizeof(cgroup_record));
+        frame_end(out, (uint32_t)n);
+    } else if (format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"cgroups\",\"cgroups\":[");
+        int first = 1;
+        for (size_t i = 0; i < count; i++) {
+            const cgroup_entry *c = &list[i];
+            if (c->sampled_ns == 0) continue;
+            block_printf(out, "%s{\"path\":\"", first ? "" : ",");
+            block_escaped(out, cgroup_path(c->cgroup), 1);
+            block_printf(out, "\",\"processes\":%u,\"cpu\":%.2f,\"memory_bytes\":%llu,"
+                         "\"disk_read_bytes_per_s\":%.0f,\"disk_written_bytes_per_s\":%.0f,"
+                         "\"cpu_pressure\":%.2f,\"memory_pressure\":%.2f}",
+                         c->processes, c->cpu, (unsigned long long)c->memory, c->disk_read, c->disk_written,
+                         c->cpu_pressure, c->memory_pressure);
+            first = 0;
+        }
+        block_printf(out, "]}\n");
+    } else {
+        // The path goes last: it is the one field that may contain '|'
+        block_printf(out, "CGROUP_START\n");
+        for (size_t i = 0; i < count; i++) {
+            const cgroup_entry *c = &list[i];
+            if (c->sampled_ns == 0) continue;
+            block_printf(out, "CGROUP|%u|%.2f|%llu|%.0f|%.0f|%.2f|%.2f|",
+                         c->processes, c->cpu, (unsigned long long)c->memory, c->disk_read, c->disk_written,
+                         c->cpu_pressure, c->memory_pressure);
+            block_line_end(out, cgroup_path(c->cgroup));
+        }
+        block_printf(out, "CGROUP_END\n");
+    }
+}
+
+void output_process_info(output_block *out) {
+    if (format == FORMAT_BINARY) {
+        output_process_binary(out);
+    } else if (format == FORMAT_JSONL) {
+        output_process_jsonl(out);
+    } else {
+        output_process_text(out);
+    }
+    if (cgroup_fs_fd >= 0) output_cgroups(out);
+}
+
+// Subscribe to the proc connector's fork/exec/exit multicast (needs CAP_NET_ADMIN)
+int proc_connector_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = CN_IDX_PROC };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))] __attribute__((aligned(NLMSG_ALIGNTO))) = {0};
+    struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+    struct cn_msg *cn = NLMSG_DATA(nlh);
+    enum proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    nlh->nlmsg_type = NLMSG_DONE;
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(op);
+    memcpy(cn->data, &op, sizeof(op));
+
+    if (send(fd, nlh, nlh->nlmsg_len, 0) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    cn_fd = fd;
+    return 0;
+}
+
+typedef struct {
+    struct nlmsghdr nl;
+    struct genlmsghdr genl;
+    char attrs[256];
+} genl_request;
+
+static void genl_add_attr(genl_request *req, uint16_t type, const void *data, size_t len) {
+    struct nlattr *na = (struct nlattr *)((char *)req + NLMSG_ALIGN(req->nl.nlmsg_len));
+    na->nla_type = type;
+    na->nla_len = NLA_HDRLEN + len;
+    memcpy((char *)na + NLA_HDRLEN, data, len);
+    req->nl.nlmsg_len = NLMSG_ALIGN(req->nl.nlmsg_len) + NLA_ALIGN(na->nla_len);
+}
+
+// Send a request and wait for its reply; returns the received length or -1
+static ssize_t genl_transact(int fd, genl_request *req, char *reply, size_t size) {
+    if (send(fd, req, req->nl.nlmsg_len, 0) < 0) return -1;
+    ssize_t len = recv(fd, reply, size, 0);
+    if (len < (ssize_t)NLMSG_HDRLEN) return -1;
+
+    struct nlmsghdr *nlh = (struct nlmsghdr *)reply;
+    if (!NLMSG_OK(nlh, (size_t)len)) return -1;
+    if (nlh->nlmsg_type == NLMSG_ERROR && ((struct nlmsgerr *)NLMSG_DATA(nlh))->error != 0) return -1;
+    return len;
+}
+
+// Register for the taskstats record the kernel sends as each task exits, so
+// processes that live and die between two ticks are still accounted for
+int taskstats_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    char reply[NETLINK_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    genl_request req = {
+        .nl = { .nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN), .nlmsg_type = GENL_ID_CTRL, .nlmsg_flags = NLM_F_REQUEST },
+        .genl = { .cmd = CTRL_CMD_GETFAMILY, .version = 1 }
+    };
+    genl_add_attr(&req, CTRL_ATTR_FAMILY_NAME, TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME));
+
+    ssize_t len;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        (len = genl_transact(fd, &req, reply, sizeof(reply))) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Find CTRL_ATTR_FAMILY_ID in the reply
+    struct nlmsghdr *nlh = (struct nlmsghdr *)reply;
+    struct nlattr *na = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+    int remaining = (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+    while (remaining >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN) {
+        if (na->nla_type == CTRL_ATTR_FAMILY_ID) {
+            memcpy(&taskstats_family, (char *)na + NLA_HDRLEN, sizeof(taskstats_family));
+            break;
+        }
+        remaining -= NLA_ALIGN(na->nla_len);
+        na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+    }
+
+    char cpumask[32];
+    snprintf(cpumask, sizeof(cpumask), "0-%ld", sysconf(_SC_NPROCESSORS_CONF) - 1);
+    req = (genl_request){
+        .nl = { .nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN), .nlmsg_type = taskstats_family,
+                .nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK },
+        .genl = { .cmd = TASKSTATS_CMD_GET, .version = TASKSTATS_GENL_VERSION }
+    };
+    genl_add_attr(&req, TASKSTATS_CMD_ATTR_REGISTER_CPUMASK, cpumask, strlen(cpumask) + 1);
+
+    if (taskstats_family == 0 || genl_transact(fd, &req, reply, sizeof(reply)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    taskstats_fd = fd;
+    return 0;
+}
+
+static void queue_event(const proc_event_entry *e) {
+    pthread_mutex_lock(&event_lock);
+    proc_event_entry *slot = arena_alloc(&event_queue, sizeof(*e));
+    if (slot != NULL) *slot = *e;
+    else events_lost = 1;
+    pthread_mutex_unlock(&event_lock);
+}
+
+static void mark_events_lost(void) {
+    pthread_mutex_lock(&event_lock);
+    events_lost = 1;
+    pthread_mutex_unlock(&event_lock);
+}
+
+static void handle_connector(void) {
+    char buf[NETLINK_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    ssize_t len = recv(cn_fd, buf, sizeof(buf), 0);
+    if (len < 0) {
+        if (errno == ENOBUFS) mark_events_lost();    // the socket overflowed; events are gone
+        return;
+    }
+
+    for (struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, (size_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+        struct cn_msg *cn = NLMSG_DATA(nlh);
+        if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+
+        struct proc_event *ev = (struct proc_event *)cn->data;
+        proc_event_entry e = { .kind = EVENT_NEW };
+        // New threads also fork; only thread group leaders are processes
+        if (ev->what == PROC_EVENT_FORK && ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+            e.pid = ev->event_data.fork.child_tgid;
+        } else if (ev->what == PROC_EVENT_EXEC && ev->event_data.exec.process_pid == ev->event_data.exec.process_tgid) {
+            e.pid = ev->event_data.exec.process_tgid;
+        } else {
+            continue;   // exits show up as a failed stat read, or through taskstats
+        }
+        queue_event(&e);
+    }
+}
+
+// Queue the stats inside one TASKSTATS_TYPE_AGGR_PID / AGGR_TGID attribute
+static void handle_taskstats_aggr(struct nlattr *aggr) {
+    int group = aggr->nla_type == TASKSTATS_TYPE_AGGR_TGID;
+    struct nlattr *na = (struct nlattr *)((char *)aggr + NLA_HDRLEN);
+    int remaining = aggr->nla_len - NLA_HDRLEN;
+
+    while (remaining >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN) {
+        if (na->nla_type == TASKSTATS_TYPE_STATS) {
+            struct taskstats ts = {0};
+            struct timespec now;
+            clock_gettime(CLOCK_BOOTTIME, &now);
+            size_t size = na->nla_len - NLA_HDRLEN;
+            memcpy(&ts, (char *)na + NLA_HDRLEN, size < sizeof(ts) ? size : sizeof(ts));
+
+            // Thread exits are reported too; keep the leader and whole-group records
+            if (!group && ts.ac_tgid != 0 && ts.ac_pid != ts.ac_tgid) return;
+
+            proc_event_entry e = {
+                .pid = group && ts.ac_tgid != 0 ? (int)ts.ac_tgid : (int)ts.ac_pid,
+                .kind = EVENT_EXITED,
+                .group = group,
+                .ppid = (int)ts.ac_ppid,
+                .uid = ts.ac_uid,
+                .cpu_us = ts.ac_utime + ts.ac_stime,
+                .elapsed_us = ts.ac_etime,
+                .rss_kb = ts.hiwater_rss
+            };
+            // /proc's start times count from boot too; received a little after the exit, so
+            // never earlier than the real start, which keeps the parent older in the tree
+            unsigned long long now_us = (unsigned long long)now.tv_sec * 1000000 + (unsigned long long)now.tv_nsec / 1000;
+            if (now_us > e.elapsed_us) e.start_time = (now_us - e.elapsed_us) * clock_ticks / 1000000;
+            memcpy(e.comm, ts.ac_comm, sizeof(e.comm));
+            e.comm[sizeof(e.comm) - 1] = '\0';
+            queue_event(&e);
+            return;
+        }
+        remaining -= NLA_ALIGN(na->nla_len);
+        na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+    }
+}
+
+static void handle_taskstats(void) {
+    char buf[NETLINK_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    ssize_t len = recv(taskstats_fd, buf, sizeof(buf), 0);
+    if (len < 0) return;     // a lost exit record only loses that process's accounting
+
+    for (struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, (size_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+        if (nlh->nlmsg_type != taskstats_family) continue;
+
+        struct nlattr *na = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+        int remaining = (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+        while (remaining >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN) {
+            if (na->nla_type == TASKSTATS_TYPE_AGGR_PID || na->nla_type == TASKSTATS_TYPE_AGGR_TGID) {
+                handle_taskstats_aggr(na);
+            }
+            remaining -= NLA_ALIGN(na->nla_len);
+            na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+        }
+    }
+}
+
+static void *proc_events_thread(void *arg) {
+    (void)arg;
+    struct pollfd fds[2] = {
+        { .fd = cn_fd, .events = POLLIN },
+        { .fd = taskstats_fd, .events = POLLIN }     // fd -1 is ignored by poll()
+    };
+
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & (POLLIN | POLLERR)) handle_connector();
+        if (fds[1].revents & (POLLIN | POLLERR)) handle_taskstats();
+    }
+
+    // Polling failed: go back to rescanning /proc
+    pthread_mutex_lock(&event_lock);
+    proc_events_active = 0;
+    pthread_mutex_unlock(&event_lock);
+    return NULL;
+}
+
+// Start --proc-events mode. Returns -1 (and the /proc rescan stays in use)
+// if the proc connector is not available, e.g. without CAP_NET_ADMIN.
+int proc_events_start(void) {
+    if (proc_connector_open() != 0) return -1;
+    if (taskstats_open() != 0) {
+        fprintf(stderr, "taskstats unavailable: processes exiting between ticks will not be shown\n");
+    }
+
+    proc_events_active = 1;
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, proc_events_thread, NULL) != 0) {
+        proc_events_active = 0;
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+// Windows can be destroyed between listing them and asking for their PID;
+// Xlib's default handler would exit on the resulting BadWindow
+static int x11_ignore_error(void *display, x_error_event *e) {
+    (void)display;
+    (void)e;
+    return 0;
+}
+
+// Connect to $DISPLAY and watch the root window's properties
+int x11_open(void) {
+    void *lib = dlopen("libX11.so.6", RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL) lib = dlopen("libX11.so", RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL) return -1;
+
+    x11_api api = { .lib = lib };
+    *(void **)&api.open_display = dlsym(lib, "XOpenDisplay");
+    *(void **)&api.default_root = dlsym(lib, "XDefaultRootWindow");
+    *(void **)&api.intern_atom = dlsym(lib, "XInternAtom");
+    *(void **)&api.select_input = dlsym(lib, "XSelectInput");
+    *(void **)&api.get_window_property = dlsym(lib, "XGetWindowProperty");
+    *(void **)&api.free = dlsym(lib, "XFree");
+    *(void **)&api.next_event = dlsym(lib, "XNextEvent");
+    *(void **)&api.pending = dlsym(lib, "XPending");
+    *(void **)&api.set_error_handler = dlsym(lib, "XSetErrorHandler");
+
+    if (api.open_display == NULL || api.default_root == NULL || api.intern_atom == NULL ||
+        api.select_input == NULL || api.get_window_property == NULL || api.free == NULL ||
+        api.next_event == NULL || api.pending == NULL || api.set_error_handler == NULL ||
+        (api.display = api.open_display(NULL)) == NULL) {
+        dlclose(lib);
+        return -1;
+    }
+
+    api.set_error_handler(x11_ignore_error);
+    api.root = api.default_root(api.display);
+    api.client_list = api.intern_atom(api.display, "_NET_CLIENT_LIST", 0);
+    api.wm_pid = api.intern_atom(api.display, "_NET_WM_PID", 0);
+    api.select_input(api.display, api.root, X_PROPERTY_CHANGE_MASK);
+
+    x11 = api;
+    return 0;
+}
+
+// A format-32 property, which Xlib returns as an array of longs. Free with x11.free.
+static long *x11_get_longs(x_window w, x_atom property, x_atom type, unsigned long *count) {
+    x_atom actual_type;
+    int actual_format;
+    unsigned long after;
+    unsigned char *data = NULL;
+    if (x11.get_window_property(x11.display, w, property, 0, MAX_WINDOWS, 0, type, &actual_type,
+                                &actual_format, count, &after, &data) != X_SUCCESS || data == NULL) {
+        return NULL;
+    }
+    if (actual_type != type || actual_format != 32) {
+        x11.free(data);
+        return NULL;
+    }
+    return (long *)data;
+}
+
+static int compare_int32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorted, unique PIDs of the window manager's client windows
+static int read_window_pids(int32_t *pids, int max) {
+    unsigned long n_windows = 0;
+    long *windows = x11_get_longs(x11.root, x11.client_list, X_ATOM_WINDOW, &n_windows);
+    if (windows == NULL) return 0;
+
+    int count = 0;
+    for (unsigned long i = 0; i < n_windows && count < max; i++) {
+        unsigned long n = 0;
+        long *pid = x11_get_longs((x_window)windows[i], x11.wm_pid, X_ATOM_CARDINAL, &n);
+        if (pid == NULL) continue;
+        if (n > 0 && pid[0] > 0) pids[count++] = (int32_t)pid[0];
+        x11.free(pid);
+    }
+    x11.free(windows);
+
+    qsort(pids, (size_t)count, sizeof(int32_t), compare_int32);
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || pids[i] != pids[unique - 1]) pids[unique++] = pids[i];
+    }
+    return unique;
+}
+
+static void output_window_pids(output_block *out, const int32_t *pids, int count) {
+    if (format == FORMAT_BINARY) {
+        frame_begin(out, FRAME_WINDOW_PIDS);
+        frame_append(out, pids, (size_t)count * sizeof(int32_t));
+        frame_end(out, (uint32_t)count);
+    } else if (format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"windows\",\"pids\":[");
+        for (int i = 0; i < count; i++) block_printf(out, "%s%d", i ? "," : "", pids[i]);
+        block_printf(out, "]}\n");
+    } else {
+        block_printf(out, "WINDOWS");
+        for (int i = 0; i < count; i++) block_printf(out, "|%d", pids[i]);
+        block_printf(out, "\n");
+    }
+}
+
+// Sleeps in XNextEvent until _NET_CLIENT_LIST changes, then sends the window
+// PIDs if they differ from last time. The first list goes out at start.
+static void *window_thread(void *arg) {
+    (void)arg;
+    static int32_t pids[MAX_WINDOWS], sent[MAX_WINDOWS];
+    int sent_count = -1;
+
+    while (1) {
+        int count = read_window_pids(pids, MAX_WINDOWS);
+        if (count != sent_count || memcmp(pids, sent, (size_t)count * sizeof(int32_t)) != 0) {
+            memcpy(sent, pids, (size_t)count * sizeof(int32_t));
+            sent_count = count;
+
+            pthread_mutex_lock(&output_lock);
+            output_window_pids(&window_out, pids, count);
+            submit_block(&window_out);
+            pthread_mutex_unlock(&output_lock);
+        }
+
+        x_event ev;
+        do {
+            x11.next_event(x11.display, &ev);
+        } while (ev.type != X_PROPERTY_NOTIFY || ev.xproperty.atom != x11.client_list);
+        // A window opening often changes the list several times; read it once
+        while (x11.pending(x11.display) > 0) x11.next_event(x11.display, &ev);
+    }
+    return NULL;
+}
+
+int window_tracking_start(void) {
+    if (x11_open() != 0) return -1;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, window_thread, NULL) != 0) return -1;
+    pthread_detach(tid);
+    return 0;
+}
+
+// --commands: requests arrive on stdin, one line each. The only command is
+//   KILL <request> <signal> <timeout_ms> <pid>[@<start_ms>] ...
+// which sends signal to every target at once, through pidfds, then waits
+// for them to exit. Targets still running after timeout_ms get SIGKILL and
+// KILL_ESCALATE_WAIT_MS more (none for SIGKILL itself). start_ms is the
+// start time the client saw; a process that started at another time has
+// reused the PID and is left alone. Results come back as one
+// FRAME_KILL_RESULTS per command, while other commands are still waiting.
+// Linux has no pidfd for a process group, so a group is sent as its PIDs.
+static int pidfd_open_pid(int pid) {
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+}
+
+static int pidfd_signal(int fd, int sig) {
+    return (int)syscall(SYS_pidfd_send_signal, fd, sig, NULL, 0);
+}
+
+static void kill_target_done(kill_target *t, kill_batch *b, uint32_t outcome, int error) {
+    if (t->fd >= 0) close(t->fd);
+    t->fd = -1;
+    t->outcome = outcome;
+    t->error = error;
+    b->pending--;
+}
+
+// Open and signal one target. The pidfd is opened before the start time is
+// checked, so the process checked is the one that will be signalled.
+static void kill_target_start(kill_target *t, kill_batch *b, long long start_ms) {
+    t->fd = pidfd_open_pid(t->pid);
+    if (t->fd < 0) {
+        kill_target_done(t, b, errno == ESRCH ? KILL_GONE : KILL_FAILED, errno == ESRCH ? 0 : errno);
+        return;
+    }
+
+    proc_stat_sample st;
+    if (read_process_stat(t->pid, &st) != 0 ||
+        (start_ms >= 0 && st.start_time * 1000 / clock_ticks != (unsigned long long)start_ms)) {
+        kill_target_done(t, b, KILL_GONE, 0);
+        return;
+    }
+
+    if (pidfd_signal(t->fd, b->signal) != 0) {
+        kill_target_done(t, b, errno == ESRCH ? KILL_GONE : KILL_FAILED, errno == ESRCH ? 0 : errno);
+    }
+}
+
+// Parse a KILL line and signal its targets. Returns NULL for anything else.
+static kill_batch *kill_batch_start(char *line) {
+    char *save;
+    char *word = strtok_r(line, " \t", &save);
+    if (word == NULL || strcmp(word, "KILL") != 0) return NULL;
+
+    char *request = strtok_r(NULL, " \t", &save);
+    char *signal_word = strtok_r(NULL, " \t", &save);
+    char *timeout = strtok_r(NULL, " \t", &save);
+    char *targets = save;
+    if (request == NULL || signal_word == NULL || timeout == NULL || targets == NULL) return NULL;
+
+    // Only signals that end a process: the escalation assumes that was the intent
+    int sig = atoi(signal_word);
+    if (sig != SIGTERM && sig != SIGINT && sig != SIGHUP && sig != SIGQUIT && sig != SIGKILL) return NULL;
+
+    int count = 0;
+    for (char *c = targets; *c != '\0'; ) {
+        while (*c == ' ' || *c == '\t') c++;
+        if (*c == '\0') break;
+        count++;
+        while (*c != '\0' && *c != ' ' && *c != '\t') c++;
+    }
+    if (count == 0) return NULL;
+
+    kill_batch *b = calloc(1, sizeof(kill_batch) + (size_t)count * sizeof(kill_target));
+    if (b == NULL) return NULL;
+    b->request = (uint32_t)strtoul(request, NULL, 10);
+    b->signal = sig;
+    long timeout_ms = atol(timeout);
+    b->deadline_ns = monotonic_ns() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000000ull;
+    b->count = count;
+    b->pending = count;
+
+    int i = 0;
+    for (word = strtok_r(targets, " \t", &save); word != NULL && i < count; word = strtok_r(NULL, " \t", &save)) {
+        char *at = strchr(word, '@');
+        kill_target *t = &b->targets[i++];
+        t->pid = atoi(word);
+        t->fd = -1;
+        if (t->pid <= 0) kill_target_done(t, b, KILL_FAILED, EINVAL);
+        else kill_target_start(t, b, at != NULL ? atoll(at + 1) : -1);
+    }
+    return b;
+}
+
+// The timeout has passed: escalate to SIGKILL once, then stop waiting
+static void kill_batch_expire(kill_batch *b, uint64_t now) {
+    int escalate = !b->escalated && b->signal != SIGKILL;
+    for (int i = 0; i < b->count; i++) {
+        kill_target *t = &b->targets[i];
+        if (t->fd < 0) continue;
+        if (!escalate) kill_target_done(t, b, KILL_RUNNING, 0);
+        else if (pidfd_signal(t->fd, SIGKILL) != 0 && errno != ESRCH) kill_target_done(t, b, KILL_FAILED, errno);
+    }
+    b->escalated |= escalate;
+    b->deadline_ns = now + KILL_ESCALATE_WAIT_MS * 1000000ull;
+}
+
+static void output_kill_results(output_block *out, const kill_batch *b) {
+    static const char *const outcomes[] = { [KILL_EXITED] = "exited", [KILL_KILLED] = "killed",
+                                            [KILL_GONE] = "gone", [KILL_FAILED] = "failed",
+                                            [KILL_RUNNING] = "running" };
+    if (format == FORMAT_BINARY) {
+        frame_begin(out, FRAME_KILL_RESULTS);
+        for (int i = 0; i < b->count; i++) {
+            kill_result_record r = { .request = b->request, .pid = b->targets[i].pid,
+                                     .outcome = b->targets[i].outcome, .error = b->targets[i].error };
+            frame_append(out, &r, sizeof(r));
+        }
+        frame_end(out, (uint32_t)b->count);
+    } else if (format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"kill\",\"request\":%u,\"results\":[", b->request);
+        for (int i = 0; i < b->count; i++) {
+            block_printf(out, "%s{\"pid\":%d,\"outcome\":\"%s\",\"error\":%d}", i ? "," : "",
+                         b->targets[i].pid, outcomes[b->targets[i].outcome], b->targets[i].error);
+        }
+        block_printf(out, "]}\n");
+    } else {
+        block_printf(out, "KILL|%u", b->request);
+        for (int i = 0; i < b->count; i++) {
+            block_printf(out, "|%d,%u,%d", b->targets[i].pid, b->targets[i].outcome, b->targets[i].error);
+        }
+        block_printf(out, "\n");
+    }
+}
+
+// Run the commands in order as they arrive; wait for every batch's exits in
+// one poll() over stdin and all of their pidfds
+static void *command_thread(void *arg) {
+    (void)arg;
+    static char line[COMMAND_LINE_SIZE];
+    size_t used = 0;
+    int discarding = 0;                 // inside a line longer than COMMAND_LINE_SIZE
+    int input = STDIN_FILENO;
+    kill_batch *batches = NULL;
+    arena polls = {0};                  // struct pollfd: stdin, then the pidfds
+    arena owners = {0};                 // kill_target * of each entry in polls (none for stdin)
+
+    while (input >= 0 || batches != NULL) {
+        uint64_t now = monotonic_ns();
+        uint64_t next = UINT64_MAX;
+        size_t n_fds = 1;
+        for (kill_batch *b = batches; b != NULL; b = b->next) {
+            if (b->deadline_ns < next) next = b->deadline_ns;
+            n_fds += (size_t)b->pending;
+        }
+
+        arena_reset(&polls);
+        arena_reset(&owners);
+        struct pollfd *fds = arena_alloc(&polls, n_fds * sizeof(struct pollfd));
+        kill_target **owned = arena_alloc(&owners, n_fds * sizeof(kill_target *));
+        if (fds == NULL || owned == NULL) break;
+        fds[0] = (struct pollfd){ .fd = input, .events = POLLIN };
+        n_fds = 1;
+        for (kill_batch *b = batches; b != NULL; b = b->next) {
+            for (int i = 0; i < b->count; i++) {
+                if (b->targets[i].fd < 0) continue;
+                fds[n_fds] = (struct pollfd){ .fd = b->targets[i].fd, .events = POLLIN };
+                owned[n_fds++] = &b->targets[i];
+            }
+        }
+        int timeout = next == UINT64_MAX ? -1 : next <= now ? 0 : (int)((next - now + 999999) / 1000000);
+        if (poll(fds, n_fds, timeout) < 0 && errno != EINTR) break;
+
+        // A readable pidfd means that process has exited
+        for (size_t i = 1; i < n_fds; i++) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            for (kill_batch *b = batches; b != NULL; b = b->next) {
+                if (owned[i] >= b->targets && owned[i] < b->targets + b->count) {
+                    kill_target_done(owned[i], b, b->escalated ? KILL_KILLED : KILL_EXITED, 0);
+                    break;
+                }
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = read(input, line + used, sizeof(line) - 1 - used);
+            if (n <= 0) {
+                if (n == 0 || errno != EINTR) input = -1;    // the client closed its end
+            } else {
+                used += (size_t)n;
+                char *start = line;
+                char *end;
+                while ((end = memchr(start, '\n', used - (size_t)(start - line))) != NULL) {
+                    *end = '\0';
+                    if (!discarding) {
+                        kill_batch *b = kill_batch_start(start);
+                        if (b != NULL) {
+                            b->next = batches;
+                            batches = b;
+                        } else if (*start != '\0') {
+                            fprintf(stderr, "Ignoring command: %.40s\n", start);
+                        }
+                    }
+                    discarding = 0;
+                    start = end + 1;
+                }
+                used -= (size_t)(start - line);
+                memmove(line, start, used);
+                if (used == sizeof(line) - 1) {
+                    fprintf(stderr, "Ignoring command longer than %d bytes\n", COMMAND_LINE_SIZE - 1);
+                    discarding = 1;
+                    used = 0;
+                }
+            }
+        }
+
+        now = monotonic_ns();
+        for (kill_batch **link = &batches; *link != NULL; ) {
+            kill_batch *b = *link;
+            if (b->pending > 0 && now >= b->deadline_ns) kill_batch_expire(b, now);
+            if (b->pending > 0) {
+                link = &b->next;
+                continue;
+            }
+
+            pthread_mutex_lock(&output_lock);
+            output_kill_results(&command_out, b);
+            submit_block(&command_out);
+            pthread_mutex_unlock(&output_lock);
+            *link = b->next;
+            free(b);
+        }
+    }
+    return NULL;
+}
+
+// Start reading commands from stdin. A big group needs a pidfd per process,
+// so the soft descriptor limit is raised to the hard one.
+int command_start(void) {
+    if (open_proc_dir() != 0) return -1;
+
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, command_thread, NULL) != 0) return -1;
+    pthread_detach(tid);
+    return 0;
+}
+
+// Disk throughput of pid since the previous scan from /proc/<pid>/io. Only
+// our own processes are readable without root; the others stay at 0, and
+// once refused are not tried again until the PID is reused or execs.
+static void sample_process_io(int pid, cpu_record_time *rec, process_info *info) {
+    char path[32];
+    char buf[STAT_BUF_SIZE];
+
+    if (rec->io_denied) return;
+    snprintf(path, sizeof(path), "%d/io", pid);
+    int fd = counted_openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        rec->io_denied = errno == EACCES || errno == EPERM;
+        return;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return;
+    buf[n] = '\0';
+
+    // read_bytes / write_bytes reached the block layer; rchar / wchar include the page cache
+    char *read_line = strstr(buf, "\nread_bytes: ");
+    char *write_line = strstr(buf, "\nwrite_bytes: ");
+    if (read_line == NULL || write_line == NULL) return;
+    unsigned long long read_bytes = strtoull(read_line + 13, NULL, 10);
+    unsigned long long written_bytes = strtoull(write_line + 14, NULL, 10);
+
+    if (rec->io_ns != 0 && last_scan_ns > rec->io_ns &&
+        read_bytes >= rec->last_read_bytes && written_bytes >= rec->last_written_bytes) {
+        double elapsed = (last_scan_ns - rec->io_ns) / 1e9;
+        info->disk_read = (float)((read_bytes - rec->last_read_bytes) / elapsed);
+        info->disk_written = (float)((written_bytes - rec->last_written_bytes) / elapsed);
+    }
+    rec->last_read_bytes = read_bytes;
+    rec->last_written_bytes = written_bytes;
+    rec->io_ns = last_scan_ns;
+}
+
+// --process-net: byte counters of every TCP socket come from one sock_diag
+// dump per scan. Sockets are matched to processes by inode through
+// /proc/<pid>/fd, which is only walked again when a socket with no known
+// owner shows up. UDP keeps no byte counters, so it is not counted.
+int sock_diag_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (fd < 0) return -1;
+    sock_diag_fd = fd;
+    return 0;
+}
+
+// Append the TCP sockets of one address family to sockets
+static int sock_diag_dump(uint8_t family) {
+    struct {
+        struct nlmsghdr nl;
+        struct inet_diag_req_v2 req;
+    } request = {
+        .nl = { .nlmsg_len = sizeof(request), .nlmsg_type = SOCK_DIAG_BY_FAMILY,
+                .nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP },
+        .req = { .sdiag_family = family, .sdiag_protocol = IPPROTO_TCP,
+                 .idiag_ext = 1 << (INET_DIAG_INFO - 1), .idiag_states = ~0u }
+    };
+    if (send(sock_diag_fd, &request, sizeof(request), 0) < 0) return -1;
+
+    // tcpi_bytes_received is the last counter used; older kernels send a shorter tcp_info
+    size_t info_size = offsetof(struct tcp_info, tcpi_bytes_received) + sizeof(uint64_t);
+    char buf[SOCK_DIAG_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    while (1) {
+        ssize_t len = recv(sock_diag_fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        for (struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, (size_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_DONE) return 0;
+            if (nlh->nlmsg_type == NLMSG_ERROR) return -1;
+
+            struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+            if (msg->idiag_inode == 0) continue;    // TIME_WAIT: no longer owned by anyone
+
+            struct nlattr *na = (struct nlattr *)((char *)msg + NLMSG_ALIGN(sizeof(*msg)));
+            int remaining = (int)nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*msg));
+            while (remaining >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN) {
+                if (na->nla_type == INET_DIAG_INFO && na->nla_len >= NLA_HDRLEN + info_size) {
+                    struct tcp_info info = {0};
+                    size_t got = na->nla_len - NLA_HDRLEN;
+                    memcpy(&info, (char *)na + NLA_HDRLEN, got < sizeof(info) ? got : sizeof(info));
+                    socket_entry *e = arena_alloc(&sockets, sizeof(socket_entry));
+                    if (e == NULL) return -1;
+                    *e = (socket_entry){ .inode = msg->idiag_inode,
+                                         .received = info.tcpi_bytes_received, .sent = info.tcpi_bytes_acked };
+                    break;
+                }
+                remaining -= NLA_ALIGN(na->nla_len);
+                na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+            }
+        }
+    }
+}
+
+static int compare_socket_inode(const void *a, const void *b) {
+    uint32_t x = ((const socket_entry *)a)->inode;
+    uint32_t y = ((const socket_entry *)b)->inode;
+    return (x > y) - (x < y);
+}
+
+static socket_entry *socket_find(arena *a, uint32_t inode) {
+    socket_entry key = { .inode = inode };
+    return bsearch(&key, a->data, a->used / sizeof(socket_entry), sizeof(socket_entry), compare_socket_inode);
+}
+
+static int compare_owner_candidate(const void *a, const void *b) {
+    const owner_candidate *x = a;
+    const owner_candidate *y = b;
+    if (x->urgency != y->urgency) return x->urgency < y->urgency ? -1 : 1;
+    return (x->fd_scan > y->fd_scan) - (x->fd_scan < y->fd_scan);
+}
+
+// Walk process fds for the unresolved sockets of this dump until all are
+// found or SOCKET_OWNER_BUDGET_NS is spent: processes that owned sockets
+// last time first (servers accepting connections), then new or exec'd
+// ones, then the rest, least recently walked first. The first process
+// holding one (forked children share them) is its owner. Sockets still
+// unowned after every process was walked are another user's, or already
+// closed; those left when the budget ran out are looked for next scan.
+static void resolve_socket_owners(size_t unresolved) {
+    char path[32];
+    char link[64];
+
+    arena_reset(&owner_candidates);
+    for (int i = 0; i < p_count; i++) {
+        if (plist[i].state == 'X') continue;
+        const cpu_record_time *rec = cpu_table_find(plist[i].pid);
+        if (rec == NULL) continue;
+        owner_candidate *c = arena_alloc(&owner_candidates, sizeof(owner_candidate));
+        if (c == NULL) return;
+        unsigned int urgency = rec->socket_scan != 0 && scan_generation - rec->socket_scan <= 1 ? 0
+                             : rec->fd_scan == 0 ? 1 : 2;
+        *c = (owner_candidate){ .urgency = urgency, .fd_scan = rec->fd_scan, .index = i };
+    }
+
+    size_t count = owner_candidates.used / sizeof(owner_candidate);
+    owner_candidate *list = (owner_candidate *)owner_candidates.data;
+    qsort(list, count, sizeof(owner_candidate), compare_owner_candidate);
+
+    uint64_t deadline = monotonic_ns() + SOCKET_OWNER_BUDGET_NS;
+    size_t walked = 0;
+    for (; walked < count && unresolved > 0 && monotonic_ns() < deadline; walked++) {
+        int pid = plist[list[walked].index].pid;
+        cpu_record_time *rec = cpu_table_find(pid);
+        rec->fd_scan = scan_generation;
+
+        snprintf(path, sizeof(path), "%d/fd", pid);
+        int fd = counted_openat(proc_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) continue;
+        DIR *dir = fdopendir(fd);
+        if (dir == NULL) {
+            close(fd);
+            continue;
+        }
+
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_type != DT_LNK) continue;
+            ssize_t n = readlinkat(fd, entry->d_name, link, sizeof(link) - 1);
+            if (n < 9 || memcmp(link, "socket:[", 8) != 0) continue;
+            link[n] = '\0';
+            socket_entry *s = socket_find(&sockets, (uint32_t)strtoul(link + 8, NULL, 10));
+            if (s != NULL && s->pid == 0) {
+                s->pid = pid;
+                rec->socket_scan = scan_generation;
+                unresolved--;
+            }
+        }
+        closedir(dir);
+    }
+    if (walked < count && unresolved > 0) return;
+
+    size_t sockets_count = sockets.used / sizeof(socket_entry);
+    for (size_t i = 0; i < sockets_count; i++) {
+        socket_entry *s = &((socket_entry *)sockets.data)[i];
+        if (s->pid == 0) s->pid = -1;    // not looked for again
+    }
+}
+
+// Attribute the TCP bytes since the previous dump to the sampled processes
+void sample_process_net(uint64_t now) {
+    arena swap = last_sockets;
+    last_sockets = sockets;
+    sockets = swap;
+    arena_reset(&sockets);
+
+    if (sock_diag_dump(AF_INET) != 0 || sock_diag_dump(AF_INET6) != 0) {
+        sockets_ns = 0;    // start over: deltas against a partial dump would be wrong
+        return;
+    }
+    size_t count = sockets.used / sizeof(socket_entry);
+    socket_entry *list = (socket_entry *)sockets.data;
+    qsort(list, count, sizeof(socket_entry), compare_socket_inode);
+
+    // Keep the owners found before, unless that process has gone since.
+    // Only sockets opened since the last dump (or whose owner exited) are
+    // looked up, so a steady set of connections costs no fd walking at all.
+    size_t unresolved = 0;
+    for (size_t i = 0; i < count; i++) {
+        socket_entry *last = sockets_ns ? socket_find(&last_sockets, list[i].inode) : NULL;
+        if (last != NULL && last->pid != 0) {
+            cpu_record_time *rec = last->pid > 0 ? cpu_table_find(last->pid) : NULL;
+            if (last->pid < 0 || (rec != NULL && rec->generation == scan_generation)) {
+                list[i].pid = last->pid;
+                if (rec != NULL) rec->socket_scan = scan_generation;
+                continue;
+            }
+        }
+        unresolved++;
+    }
+    if (unresolved > 0) resolve_socket_owners(unresolved);
+
+    uint64_t since = sockets_ns;
+    sockets_ns = now;
+    if (since == 0 || now <= since) return;    // first dump: only a baseline
+
+    for (size_t i = 0; i < count; i++) {
+        const socket_entry *s = &list[i];
+        if (s->pid <= 0) continue;
+        cpu_record_time *rec = cpu_table_find(s->pid);
+        if (rec == NULL) continue;
+
+        // A socket missing from the last dump was opened since: all its bytes are new
+        const socket_entry *last = socket_find(&last_sockets, s->inode);
+        uint64_t received = last ? last->received : 0;
+        uint64_t sent = last ? last->sent : 0;
+        if (s->received >= received) rec->net_received += s->received - received;
+        if (s->sent >= sent) rec->net_sent += s->sent - sent;
+    }
+
+    double elapsed = (now - since) / 1e9;
+    for (int i = 0; i < p_count; i++) {
+        cpu_record_time *rec = cpu_table_find(plist[i].pid);
+        if (rec == NULL || (rec->net_received == 0 && rec->net_sent == 0)) continue;
+        plist[i].net_received = (float)(rec->net_received / elapsed);
+        plist[i].net_sent = (float)(rec->net_sent / elapsed);
+        rec->net_received = 0;
+        rec->net_sent = 0;
+    }
+}
+
+// PSS (shared pages split between the processes mapping them) and USS
+// (pages only this process maps) from /proc/<pid>/smaps_rollup, in kB.
+// Both stay 0 where it is not readable (other users' processes, without root).
+// Returns -1, with errno set, if the file could not be opened.
+static int read_process_pss(int pid, uint32_t *pss, uint32_t *uss) {
+    char path[32];
+    char buf[SMAPS_BUF_SIZE];
+
+    *pss = 0;
+    *uss = 0;
+    snprintf(path, sizeof(path), "%d/smaps_rollup", pid);
+    int fd = counted_openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    char *line;
+    if ((line = strstr(buf, "\nPss:")) != NULL) *pss = (uint32_t)strtoul(line + 5, NULL, 10);
+    if ((line = strstr(buf, "\nPrivate_Clean:")) != NULL) *uss = (uint32_t)strtoul(line + 15, NULL, 10);
+    if ((line = strstr(buf, "\nPrivate_Dirty:")) != NULL) *uss += (uint32_t)strtoul(line + 15, NULL, 10);
+    return 0;
+}
+
+static int compare_pss_candidate(const void *a, const void *b) {
+    const pss_candidate *x = a;
+    const pss_candidate *y = b;
+    if (x->urgency != y->urgency) return x->urgency < y->urgency ? -1 : 1;
+    return (x->pss_scan > y->pss_scan) - (x->pss_scan < y->pss_scan);
+}
+
+// Read smaps_rollup for the processes that need it most until PSS_BUDGET_NS
+// is spent: new ones, then large or fast-changing ones, then those not read
+// for PSS_REFRESH_SCANS. Everything else keeps the value of its last read;
+// a refused file is not tried again until the process execs.
+void sample_process_pss(void) {
+    arena_reset(&pss_candidates);
+    for (int i = 0; i < p_count; i++) {
+        const process_info *p = &plist[i];
+        if (p->memory == 0 || p->state == 'X') continue;    // kernel threads, already exited
+        const cpu_record_time *rec = cpu_table_find(p->pid);
+        if (rec == NULL || rec->pss_denied) continue;
+
+        unsigned long change = p->memory > rec->pss_rss ? p->memory - rec->pss_rss : rec->pss_rss - p->memory;
+        unsigned int urgency;
+        if (rec->pss_scan == 0) urgency = 0;
+        else if (p->memory >= PSS_LARGE_KB || change * PSS_RSS_CHANGE_DIVISOR > rec->pss_rss) urgency = 1;
+        else if (scan_generation >= rec->pss_due) urgency = 2;
+        else continue;
+
+        pss_candidate *c = arena_alloc(&pss_candidates, sizeof(pss_candidate));
+        if (c == NULL) break;
+        *c = (pss_candidate){ .urgency = urgency, .pss_scan = rec->pss_scan, .index = i };
+    }
+
+    size_t count = pss_candidates.used / sizeof(pss_candidate);
+    pss_candidate *list = (pss_candidate *)pss_candidates.data;
+    qsort(list, count, sizeof(pss_candidate), compare_pss_candidate);
+
+    uint64_t deadline = monotonic_ns() + PSS_BUDGET_NS;
+    for (size_t i = 0; i < count && monotonic_ns() < deadline; i++) {
+        process_info *p = &plist[list[i].index];
+        cpu_record_time *rec = cpu_table_find(p->pid);
+        if (read_process_pss(p->pid, &rec->pss, &rec->uss) != 0) rec->pss_denied = errno == EACCES || errno == EPERM;
+        rec->pss_rss = p->memory;
+        // First reads come in bursts (startup); stagger their refreshes over PSS_REFRESH_SCANS
+        rec->pss_due = scan_generation + (rec->pss_scan ? PSS_REFRESH_SCANS : 1 + p->pid % PSS_REFRESH_SCANS);
+        rec->pss_scan = scan_generation;
+        p->pss = rec->pss;
+        p->uss = rec->uss;
+    }
+}
+
+// Subtree totals for the tree view, in O(n): each process is linked to its
+// parent through the per-PID table, then leaves are queued and every process
+// adds its finished subtree to its parent, which is queued in turn once its
+// last child is done. A parent younger than its child is a reused PID
+// (the real parent has exited), so that child becomes a root.
+void sum_process_subtrees(void) {
+    arena_reset(&tree_queue);
+    int *queue = arena_alloc(&tree_queue, (size_t)p_count * sizeof(int));
+    if (queue == NULL && p_count > 0) return;
+
+    for (int i = 0; i < p_count; i++) {
+        process_info *p = &plist[i];
+        p->parent = -1;
+        p->pending = 0;
+        p->subtree_cpu = p->cpu_usage;
+        p->subtree_memory = p->pss ? p->pss : p->memory;
+        p->subtree_disk = p->disk_read + p->disk_written;
+        p->subtree_net = p->net_received + p->net_sent;
+    }
+
+    for (int i = 0; i < p_count; i++) {
+        process_info *p = &plist[i];
+        const cpu_record_time *rec = p->ppid > 0 ? cpu_table_find(p->ppid) : NULL;
+        if (rec == NULL || rec->generation != scan_generation) continue;
+        // index is only set once the parent made it into plist this scan
+        if (rec->index < 0 || rec->index >= p_count || rec->index == i) continue;
+        process_info *parent = &plist[rec->index];
+        if (parent->pid != p->ppid || parent->start_time > p->start_time) continue;
+        p->parent = rec->index;
+        parent->pending++;
+    }
+
+    int tail = 0;
+    for (int i = 0; i < p_count; i++) {
+        if (plist[i].pending == 0) queue[tail++] = i;
+    }
+    for (int head = 0; head < tail; head++) {
+        const process_info *p = &plist[queue[head]];
+        if (p->parent < 0) continue;
+        process_info *parent = &plist[p->parent];
+        parent->subtree_cpu += p->subtree_cpu;
+        parent->subtree_memory += p->subtree_memory;
+        parent->subtree_disk += p->subtree_disk;
+        parent->subtree_net += p->subtree_net;
+        if (--parent->pending == 0) queue[tail++] = p->parent;
+    }
+}
+
+// Only a cgroup v2 hierarchy has the per-group files sample_cgroups() reads:
+// CGROUP_FS itself, or its unified/ mount on a systemd hybrid (v1 + v2) host
+int cgroup_fs_open(void) {
+    static const char *const roots[] = { CGROUP_FS, CGROUP_FS "/unified" };
+    int fd = -1;
+    for (size_t i = 0; i < sizeof(roots) / sizeof(roots[0]) && fd < 0; i++) {
+        fd = open(roots[i], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0 && faccessat(fd, "cgroup.controllers", R_OK, 0) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd < 0) return -1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0) cgroup_cpus = cpus;
+    cgroup_fs_fd = fd;
+    return 0;
+}
+
+// Read <cgroup>/<file> below CGROUP_FS into buf. Returns its length or -1.
+static ssize_t read_cgroup_file(const char *cgroup, const char *file, char *buf, size_t size) {
+    char path[PATH_MAX];
+    // Paths are absolute within the hierarchy; the root group itself is "/"
+    const char *rel = cgroup[0] == '/' ? cgroup + 1 : cgroup;
+    int len = snprintf(path, sizeof(path), "%s%s%s", rel, rel[0] ? "/" : "", file);
+    if (len < 0 || (size_t)len >= sizeof(path)) return -1;
+
+    int fd = counted_openat(cgroup_fs_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return n;
+}
+
+// "some avg10=" of a PSI file, percent
+static float read_cgroup_pressure(const char *cgroup, const char *file) {
+    char buf[256];
+    if (read_cgroup_file(cgroup, file, buf, sizeof(buf)) < 0) return 0.0f;
+    char *avg = strncmp(buf, "some avg10=", 11) == 0 ? buf + 11 : NULL;
+    return avg ? strtof(avg, NULL) : 0.0f;
+}
+
+static void read_cgroup_counters(cgroup_entry *c, uint64_t now) {
+    char buf[CGROUP_BUF_SIZE];
+    const char *path = cgroup_path(c->cgroup);
+
+    // Without cpu.stat this is not a v2 group we can read (v1 name=systemd path)
+    if (read_cgroup_file(path, "cpu.stat", buf, sizeof(buf)) < 0 || strncmp(buf, "usage_usec ", 11) != 0) return;
+    c->usage_usec = strtoull(buf + 11, NULL, 10);
+    c->sampled_ns = now;
+
+    if (read_cgroup_file(path, "memory.current", buf, sizeof(buf)) >= 0) {
+        c->memory = strtoull(buf, NULL, 10);
+    }
+
+    // "MAJ:MIN rbytes=N wbytes=N rios=N ..." per device
+    if (read_cgroup_file(path, "io.stat", buf, sizeof(buf)) >= 0) {
+        for (char *line = buf; *line; ) {
+            char *field = strstr(line, "rbytes=");
+            char *end = strchr(line, '\n');
+            if (field != NULL && (end == NULL || field < end)) {
+                c->read_bytes += strtoull(field + 7, &field, 10);
+                if (strncmp(field, " wbytes=", 8) == 0) c->written_bytes += strtoull(field + 8, NULL, 10);
+            }
+            if (end == NULL) break;
+            line = end + 1;
+        }
+    }
+
+    c->cpu_pressure = read_cgroup_pressure(path, "cpu.pressure");
+    c->memory_pressure = read_cgroup_pressure(path, "memory.pressure");
+}
+
+static int compare_cgroup_entry(const void *a, const void *b) {
+    uint32_t x = ((const cgroup_entry *)a)->cgroup, y = ((const cgroup_entry *)b)->cgroup;
+    return (x > y) - (x < y);
+}
+
+static uint32_t cgroup_reintern(const arena *old_strings, uint32_t handle) {
+    if (handle == 0) return 0;
+    const char *path = old_strings->data + handle - 1;
+    return cgroup_intern(path, strlen(path));
+}
+
+// Drop the cgroup paths no process is in any more: a host that starts and
+// stops services or containers all day would otherwise keep every path it
+// ever saw. Handles are offsets into cgroup_strings, so the live paths are
+// interned again into fresh storage and their holders renumbered. Runs
+// before a scan, once the dictionary has doubled since the last time.
+void cgroup_dict_compact(void) {
+    if (cgroup_dict_count < cgroup_compact_at) return;
+
+    name_slot *old_dict = cgroup_dict;
+    arena old_strings = cgroup_strings;
+    cgroup_dict = NULL;
+    cgroup_dict_size = 0;
+    cgroup_dict_count = 0;
+    cgroup_strings = (arena){0};
+
+    for (size_t i = 0; i < cpu_table_size; i++) {
+        cpu_record_time *rec = &cpu_table[i];
+        if (rec->pid == 0) continue;
+        rec->cgroup = cgroup_reintern(&old_strings, rec->cgroup);
+        rec->sent_cgroup = cgroup_reintern(&old_strings, rec->sent_cgroup);
+    }
+
+    // The previous scan's groups are the base of this scan's rates, kept sorted by handle
+    size_t count = cgroups.used / sizeof(cgroup_entry);
+    cgroup_entry *list = (cgroup_entry *)cgroups.data;
+    for (size_t i = 0; i < count; i++) list[i].cgroup = cgroup_reintern(&old_strings, list[i].cgroup);
+    qsort(list, count, sizeof(cgroup_entry), compare_cgroup_entry);
+
+    free(old_dict);
+    free(old_strings.data);
+    uint32_t live = cgroup_dict_count * 2;
+    cgroup_compact_at = live > CGROUP_DICT_COMPACT_MIN ? live : CGROUP_DICT_COMPACT_MIN;
+}
+
+// Read the counters of every cgroup holding a process in this scan. Each is
+// read once however many processes it has; rates are against the previous scan.
+void sample_cgroups(uint64_t now) {
+    arena swap = last_cgroups;
+    last_cgroups = cgroups;
+    cgroups = swap;
+    arena_reset(&cgroups);
+
+    for (int i = 0; i < p_count; i++) {
+        if (plist[i].cgroup == 0) continue;
+        cgroup_entry *c = arena_alloc(&cgroups, sizeof(cgroup_entry));
+        if (c == NULL) break;
+        *c = (cgroup_entry){ .cgroup = plist[i].cgroup, .processes = 1 };
+    }
+    size_t count = cgroups.used / sizeof(cgroup_entry);
+    cgroup_entry *list = (cgroup_entry *)cgroups.data;
+    qsort(list, count, sizeof(cgroup_entry), compare_cgroup_entry);
+
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique > 0 && list[unique - 1].cgroup == list[i].cgroup) {
+            list[unique - 1].processes++;
+        } else {
+            list[unique++] = list[i];
+        }
+    }
+    cgroups.used = unique * sizeof(cgroup_entry);
+
+    size_t n_last = last_cgroups.used / sizeof(cgroup_entry);
+    for (size_t i = 0; i < unique; i++) {
+        cgroup_entry *c = &list[i];
+        read_cgroup_counters(c, now);
+
+        const cgroup_entry *last = n_last ? bsearch(c, last_cgroups.data, n_last, sizeof(cgroup_entry),
+                                                    compare_cgroup_entry) : NULL;
+        if (last == NULL || last->sampled_ns == 0 || c->sampled_ns <= last->sampled_ns) continue;
+        double elapsed = (c->sampled_ns - last->sampled_ns) / 1e9;
+        if (c->usage_usec >= last->usage_usec) {
+            c->cpu = (float)((c->usage_usec - last->usage_usec) / (elapsed * 1e6 * cgroup_cpus) * 100.0);
+        }
+        if (c->read_bytes >= last->read_bytes) c->disk_read = (float)((c->read_bytes - last->read_bytes) / elapsed);
+        if (c->written_bytes >= last->written_bytes) {
+            c->disk_written = (float)((c->written_bytes - last->written_bytes) / elapsed);
+        }
+    }
+}
+
+// Real uid from /proc/<pid>/status and the cgroup path from /proc/<pid>/cgroup
+// (the v2 "0::" line, else the v1 name=systemd hierarchy). The cgroup file is
+// one line per v1 hierarchy with paths of any length, so it is read whole into
+// identity_buf; a line without its newline came from a short read and is not used.
+int read_process_identity(int pid, uint32_t *uid, uint32_t *cgroup) {
+    char path[32];
+    char buf[STAT_BUF_SIZE];
+    ssize_t n;
+
+    // Uid: comes a few lines in, well inside the first STAT_BUF_SIZE bytes
+    snprintf(path, sizeof(path), "%d/status", pid);
+    int fd = counted_openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+
+    char *line = strstr(buf, "\nUid:");
+    if (line == NULL) return -1;
+    *uid = (uint32_t)strtoul(line + 5, NULL, 10);
+
+    snprintf(path, sizeof(path), "%d/cgroup", pid);
+    fd = counted_openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    arena_reset(&identity_buf);
+    do {
+        char *dst = arena_alloc(&identity_buf, STAT_BUF_SIZE);
+        if (dst == NULL) {
+            close(fd);
+            return -1;
+        }
+        n = read(fd, dst, STAT_BUF_SIZE);
+        identity_buf.used -= STAT_BUF_SIZE - (n > 0 ? (size_t)n : 0);
+    } while (n > 0);
+    close(fd);
+    char *text = arena_alloc(&identity_buf, 1);
+    if (n < 0 || text == NULL) return -1;
+    *text = '\0';
+    text = identity_buf.data;
+
+    char *found = NULL;
+    if (strncmp(text, "0::", 3) == 0) found = text + 3;
+    else if ((found = strstr(text, "\n0::")) != NULL) found += 4;
+    else if ((found = strstr(text, ":name=systemd:")) != NULL) found += 14;
+
+    *cgroup = 0;
+    if (found != NULL) {
+        size_t len = strcspn(found, "\n");
+        if (found[len] == '\n') *cgroup = cgroup_intern(found, len);
+    }
+    return 0;
+}
+
+// Sample one PID into the snapshot. Returns 0 if it was added.
+static int sample_process(int pid, unsigned long long delta_total_cpu) {
+    // name, state, cpu times, threads and rss from one read
+    
+    proc_stat_sample st;
+    if (read_process_stat(pid, &st) != 0) return -1;
+    
+    // cpu usage
+    
+    float cpu_usage = calculate_cpu_usage(pid, st.start_time, st.utime + st.stime, delta_total_cpu);
+
+    // uid and cgroup rarely change: cached per PID, read again after exec or
+    // every IDENTITY_REFRESH_SCANS passes. A failed read (the process is
+    // exiting, or a file was briefly unreadable) keeps what was known, 0 if
+    // nothing, and is tried again next scan.
+    cpu_record_time *rec = cpu_table_find(pid);
+    if (rec == NULL) return -1;
+    uint32_t name_hash = hash_name(st.name, st.name_len);
+    uint32_t uid, cgroup;
+    if ((rec->identity_scan == 0 || rec->name_hash != name_hash ||
+         scan_generation - rec->identity_scan >= IDENTITY_REFRESH_SCANS) &&
+        read_process_identity(pid, &uid, &cgroup) == 0) {
+        rec->uid = uid;
+        rec->cgroup = cgroup;
+        // exec'd: may hold new sockets (walk it early) and run as another user
+        if (rec->name_hash != name_hash) {
+            rec->fd_scan = 0;
+            rec->io_denied = 0;
+            rec->pss_denied = 0;
+        }
+        rec->identity_scan = scan_generation;
+        rec->name_hash = name_hash;
+    }
+    
+    // Store process information
+    process_info *info = arena_alloc(&process_arena, sizeof(process_info));
+    char *name = arena_alloc(&name_arena, st.name_len + 1);
+    if (info == NULL || name == NULL) return -1;
+    memcpy(name, st.name, st.name_len + 1);
+    
+    *info = (process_info){
+        .pid = pid,
+        .name_off = (unsigned int)(name - name_arena.data),
+        .state = st.state,
+        .cpu_usage = cpu_usage,
+        .threads = st.threads,
+        .memory = st.rss_pages * page_size_kb,    // kB, same units as VmRSS
+        .ppid = st.ppid,
+        .session = st.session,
+        .uid = rec->uid,
+        .cgroup = rec->cgroup,
+        .pss = rec->pss,
+        .uss = rec->uss,
+        .start_time = st.start_time
+    };
+    rec->index = p_count;
+    sample_process_io(pid, rec, info);
+    
+    p_count++;
+    proc_totals.processes++;
+    proc_totals.threads += (uint32_t)st.threads;
+    return 0;
+}
+
+// A process that started and exited since the previous scan: show it for one
+// tick (state 'X') with the CPU it used, instead of never showing it at all
+static void add_exited_process(const proc_event_entry *e, unsigned long long delta_total_cpu, uint64_t since_ns) {
+    if (delta_total_cpu == 0 || e->elapsed_us * 1000 > since_ns) return;   // alive at the last scan
+
+    int found;
+    cpu_record_time *rec = cpu_table_lookup(e->pid, &found);
+    if (rec == NULL || found) return;    // sampled already; leaves through the normal EXIT path
+
+    // Kept for this tick only, so --delta sends its EXIT on the next frame
+    cpu_table_used++;
+    *rec = (cpu_record_time){ .pid = e->pid, .generation = scan_generation, .index = p_count };
+
+    size_t len = strlen(e->comm);
+    process_info *info = arena_alloc(&process_arena, sizeof(process_info));
+    char *name = arena_alloc(&name_arena, len + 1);
+    if (info == NULL || name == NULL) return;
+    memcpy(name, e->comm, len + 1);
+
+    unsigned long long ticks = e->cpu_us * clock_ticks / 1000000;
+    *info = (process_info){
+        .pid = e->pid,
+        .name_off = (unsigned int)(name - name_arena.data),
+        .state = 'X',
+        .cpu_usage = (ticks * 100.0) / delta_total_cpu,
+        .threads = 1,
+        .memory = e->rss_kb,
+        .ppid = e->ppid,
+        .uid = e->uid,
+        .start_time = e->start_time
+    };
+    p_count++;
+}
+
+// With --proc-events, sample the PIDs already known plus the ones the kernel
+// reported as new, instead of listing /proc. Returns -1 to request a rescan.
+static int scan_known_processes(unsigned long long delta_total_cpu, uint64_t since_ns) {
+    pthread_mutex_lock(&event_lock);
+    int rescan = events_lost || !proc_events_active;
+    events_lost = 0;
+    arena swap = event_queue;
+    event_queue = event_batch;
+    event_batch = swap;
+    pthread_mutex_unlock(&event_lock);
+
+    proc_event_entry *events = (proc_event_entry *)event_batch.data;
+    size_t n_events = event_batch.used / sizeof(proc_event_entry);
+    arena_reset(&event_batch);
+    if (rescan) return -1;
+
+    // Copy the pids first: sampling inserts into (and may grow) cpu_table
+    arena_reset(&candidate_pids);
+    for (size_t i = 0; i < cpu_table_size; i++) {
+        if (cpu_table[i].pid == 0) continue;
+        int *slot = arena_alloc(&candidate_pids, sizeof(int));
+        if (slot == NULL) return -1;
+        *slot = cpu_table[i].pid;
+    }
+
+    size_t n_known = candidate_pids.used / sizeof(int);
+    for (size_t i = 0; i < n_known; i++) sample_process(((int *)candidate_pids.data)[i], delta_total_cpu);
+
+    for (size_t i = 0; i < n_events; i++) {
+        if (events[i].kind != EVENT_NEW) continue;
+        cpu_record_time *rec = cpu_table_find(events[i].pid);
+        if (rec != NULL && rec->generation == scan_generation) continue;   // already sampled
+        sample_process(events[i].pid, delta_total_cpu);
+    }
+
+    // Whole-group stats first, so they win over the leader thread's own record
+    for (int pass = 1; pass >= 0; pass--) {
+        for (size_t i = 0; i < n_events; i++) {
+            if (events[i].kind == EVENT_EXITED && events[i].group == pass) {
+                add_exited_process(&events[i], delta_total_cpu, since_ns);
+            }
+        }
+    }
+    return 0;
+}
+
+void read_process_info(void) {
+    if (open_proc_dir() != 0) {
+        fprintf(stderr, "Error: Cannot open %s directory\n", proc_root);
+        return;
+    }
+    
+    uint64_t began = monotonic_ns();
+    proc_totals = (process_totals_record){0};
+    unsigned long long delta_total_cpu;
+    get_total_cpu_time(&delta_total_cpu, &proc_totals);
+
+    uint64_t now = monotonic_ns();
+    uint64_t since_ns = now - last_scan_ns;
+    last_scan_ns = now;
+    
+    p_count = 0;
+    arena_reset(&process_arena);
+    arena_reset(&name_arena);
+    scan_generation++;
+    cgroup_dict_compact();
+
+    if (!proc_events || scan_known_processes(delta_total_cpu, since_ns) != 0) {
+        rewinddir(proc_dir);
+        struct dirent *entry;
         
-        p_count++;
+        while ((entry = readdir(proc_dir)) != NULL) {
+            if (!isdigit(entry->d_name[0])) continue;
+            sample_process(atoi(entry->d_name), delta_total_cpu);
+        }
     }
+    process_scan_ns = monotonic_ns() - began;
     
-    closedir(dir);
+    plist = (process_info *)process_arena.data;
+    if (sock_diag_fd >= 0) sample_process_net(now);
+    if (pss_mode) sample_process_pss();
+    sum_process_subtrees();
+    if (cgroup_fs_fd >= 0) sample_cgroups(now);
+    
+    // Forget processes that have exited since the last pass
+    cpu_table_evict_stale();
     
     // Sort by CPU usage (descending) to show most active processes first
-    for (int i = 0; i < p_count - 1; i++) {
-        for (int j = 0; j < p_count - i - 1; j++) {
-            if (plist[j].cpu_usage < plist[j + 1].cpu_usage) {
-                process_info temp = plist[j];
-                plist[j] = plist[j + 1];
-                plist[j + 1] = temp;
+    uint64_t sort_began = monotonic_ns();
+    if (sort_processes() != 0) order_count = 0;
+    process_sort_ns = monotonic_ns() - sort_began;
+}
+
+// Hand a finished block to the writer thread. Waits if the reader has fallen
+// MAX_QUEUED_BLOCKS behind: dropping a block could lose a delta or name entry.
+void submit_block(output_block *out) {
+    if (out->buf.used == 0) return;
+
+    queued_block *b = malloc(sizeof(queued_block) + out->buf.used);
+    if (b == NULL) return;
+    b->next = NULL;
+    b->size = out->buf.used;
+    memcpy(b->data, out->buf.data, out->buf.used);
+    arena_reset(&out->buf);
+
+    pthread_mutex_lock(&queue_lock);
+    while (queue_len >= MAX_QUEUED_BLOCKS) pthread_cond_wait(&queue_not_full, &queue_lock);
+    if (queue_tail != NULL) queue_tail->next = b;
+    else queue_head = b;
+    queue_tail = b;
+    queue_len++;
+    pthread_cond_signal(&queue_not_empty);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+// The only code that touches stdout. Exits once the reader has gone away.
+static void *writer_thread(void *arg) {
+    (void)arg;
+    while (1) {
+        pthread_mutex_lock(&queue_lock);
+        while (queue_head == NULL) pthread_cond_wait(&queue_not_empty, &queue_lock);
+        queued_block *b = queue_head;
+        queue_head = b->next;
+        if (queue_head == NULL) queue_tail = NULL;
+        queue_len--;
+        pthread_cond_signal(&queue_not_full);
+        pthread_mutex_unlock(&queue_lock);
+
+        int ok = fwrite(b->data, 1, b->size, stdout) == b->size && fflush(stdout) == 0;
+        free(b);
+        if (!ok) exit(0);
+    }
+    return NULL;
+}
+
+// Prometheus text exposition (--listen). Each sampler renders its section
+// right after sampling, from the same data it writes to stdout; a scrape
+// returns the latest section of every sampler.
+static void metric_header(output_block *out, const char *name, const char *type, const char *help) {
+    block_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// name{pid="...",name="..."} for a per-process series
+static void process_series(output_block *out, const char *metric, const process_info *p) {
+    block_printf(out, "%s{pid=\"%d\",name=\"", metric, p->pid);
+    block_escaped(out, process_name(p), 0);
+    block_write(out, "\"} ", 3);
+}
+
+// Every cgroup holding a process gets series: there are as many as services
+// and containers, not processes
+static void export_cgroup_metrics(output_block *out) {
+    static const struct { const char *name, *help; size_t offset; } gauges[] = {
+        { "taskmanager_cgroup_cpu_percent", "CPU usage of the cgroup (cpu.stat), % of all CPUs",
+          offsetof(cgroup_entry, cpu) },
+        { "taskmanager_cgroup_disk_read_bytes_per_second", "Disk reads of the cgroup (io.stat)",
+          offsetof(cgroup_entry, disk_read) },
+        { "taskmanager_cgroup_disk_written_bytes_per_second", "Disk writes of the cgroup (io.stat)",
+          offsetof(cgroup_entry, disk_written) },
+        { "taskmanager_cgroup_cpu_pressure_percent", "Share of time some task of the cgroup waited for a CPU (avg10)",
+          offsetof(cgroup_entry, cpu_pressure) },
+        { "taskmanager_cgroup_memory_pressure_percent", "Share of time some task of the cgroup waited for memory (avg10)",
+          offsetof(cgroup_entry, memory_pressure) },
+    };
+    size_t count = cgroups.used / sizeof(cgroup_entry);
+    const cgroup_entry *list = (const cgroup_entry *)cgroups.data;
+
+    metric_header(out, "taskmanager_cgroup_memory_bytes", "gauge", "Memory charged to the cgroup (memory.current)");
+    for (size_t i = 0; i < count; i++) {
+        if (list[i].sampled_ns == 0) continue;
+        block_printf(out, "taskmanager_cgroup_memory_bytes{cgroup=\"");
+        block_escaped(out, cgroup_path(list[i].cgroup), 0);
+        block_printf(out, "\"} %llu\n", (unsigned long long)list[i].memory);
+    }
+    for (size_t m = 0; m < sizeof(gauges) / sizeof(gauges[0]); m++) {
+        metric_header(out, gauges[m].name, "gauge", gauges[m].help);
+        for (size_t i = 0; i < count; i++) {
+            if (list[i].sampled_ns == 0) continue;
+            block_printf(out, "%s{cgroup=\"", gauges[m].name);
+            block_escaped(out, cgroup_path(list[i].cgroup), 0);
+            block_printf(out, "\"} %.2f\n", *(const float *)((const char *)&list[i] + gauges[m].offset));
+        }
+    }
+}
+
+void export_process_metrics(output_block *out) {
+    metric_header(out, "taskmanager_processes", "gauge", "Processes (thread group leaders) on the system");
+    block_printf(out, "taskmanager_processes %u\n", proc_totals.processes);
+    metric_header(out, "taskmanager_threads", "gauge", "Threads of all processes");
+    block_printf(out, "taskmanager_threads %u\n", proc_totals.threads);
+    metric_header(out, "taskmanager_tasks_running", "gauge", "Runnable tasks (/proc/stat procs_running)");
+    block_printf(out, "taskmanager_tasks_running %u\n", proc_totals.running);
+    metric_header(out, "taskmanager_tasks_blocked", "gauge", "Tasks waiting on I/O (/proc/stat procs_blocked)");
+    block_printf(out, "taskmanager_tasks_blocked %u\n", proc_totals.blocked);
+
+    // porder is sorted busiest first: only the top get series, to bound label cardinality
+    int n = order_count < listen_top ? order_count : listen_top;
+    metric_header(out, "taskmanager_process_cpu_percent", "gauge",
+                  "CPU usage of the busiest processes, % of all CPUs");
+    for (int i = 0; i < n; i++) {
+        process_series(out, "taskmanager_process_cpu_percent", porder[i]);
+        block_printf(out, "%.2f\n", porder[i]->cpu_usage);
+    }
+    metric_header(out, "taskmanager_process_resident_bytes", "gauge", "Resident set size of the busiest processes");
+    for (int i = 0; i < n; i++) {
+        process_series(out, "taskmanager_process_resident_bytes", porder[i]);
+        block_printf(out, "%llu\n", (unsigned long long)porder[i]->memory * 1024);
+    }
+    if (pss_mode) {
+        metric_header(out, "taskmanager_process_pss_bytes", "gauge",
+                      "Proportional set size of the busiest processes (shared pages split between their users)");
+        for (int i = 0; i < n; i++) {
+            process_series(out, "taskmanager_process_pss_bytes", porder[i]);
+            block_printf(out, "%llu\n", (unsigned long long)porder[i]->pss * 1024);
+        }
+        metric_header(out, "taskmanager_process_uss_bytes", "gauge", "Memory only the busiest processes map");
+        for (int i = 0; i < n; i++) {
+            process_series(out, "taskmanager_process_uss_bytes", porder[i]);
+            block_printf(out, "%llu\n", (unsigned long long)porder[i]->uss * 1024);
+        }
+    }
+    metric_header(out, "taskmanager_process_threads", "gauge", "Threads of the busiest processes");
+    for (int i = 0; i < n; i++) {
+        process_series(out, "taskmanager_process_threads", porder[i]);
+        block_printf(out, "%d\n", porder[i]->threads);
+    }
+
+    static const struct { const char *name, *help; size_t offset; } rates[] = {
+        { "taskmanager_process_disk_read_bytes_per_second", "Disk reads of the busiest processes",
+          offsetof(process_info, disk_read) },
+        { "taskmanager_process_disk_written_bytes_per_second", "Disk writes of the busiest processes",
+          offsetof(process_info, disk_written) },
+        { "taskmanager_process_network_received_bytes_per_second", "TCP bytes received by the busiest processes",
+          offsetof(process_info, net_received) },
+        { "taskmanager_process_network_sent_bytes_per_second", "TCP bytes sent by the busiest processes",
+          offsetof(process_info, net_sent) },
+    };
+    size_t n_rates = sock_diag_fd >= 0 ? 4 : 2;
+    for (size_t m = 0; m < n_rates; m++) {
+        metric_header(out, rates[m].name, "gauge", rates[m].help);
+        for (int i = 0; i < n; i++) {
+            process_series(out, rates[m].name, porder[i]);
+            block_printf(out, "%.0f\n", *(const float *)((const char *)porder[i] + rates[m].offset));
+        }
+    }
+
+    if (cgroup_fs_fd >= 0) export_cgroup_metrics(out);
+}
+
+void export_gpu_metrics(output_block *out) {
+    if (gpu_count <= 0) return;
+
+    static const struct { const char *name, *type, *help; } series[] = {
+        { "taskmanager_gpu_utilization_percent", "gauge", "GPU utilization" },
+        { "taskmanager_gpu_memory_used_bytes", "gauge", "GPU memory in use" },
+        { "taskmanager_gpu_memory_total_bytes", "gauge", "GPU memory installed" },
+        { "taskmanager_gpu_temperature_celsius", "gauge", "GPU temperature" },
+        { "taskmanager_gpu_power_watts", "gauge", "GPU power draw" },
+        { "taskmanager_gpu_power_limit_watts", "gauge", "GPU power limit" },
+    };
+    for (size_t m = 0; m < sizeof(series) / sizeof(series[0]); m++) {
+        metric_header(out, series[m].name, series[m].type, series[m].help);
+        for (int i = 0; i < gpu_count; i++) {
+            const gpu_info *g = &gpus[i];
+            unsigned long long values[] = {
+                (unsigned long long)g->utilization, (unsigned long long)g->mem_used << 20,
+                (unsigned long long)g->mem_total << 20, (unsigned long long)g->temperature,
+                (unsigned long long)g->power_usage, (unsigned long long)g->power_limit
+            };
+            block_printf(out, "%s{gpu=\"%d\",name=\"", series[m].name, g->index);
+            block_escaped(out, g->name, 0);
+            block_printf(out, "\"} %llu\n", values[m]);
+        }
+    }
+}
+
+void export_system_metrics(output_block *out) {
+    const system_record *r = &sys_sample;
+
+    metric_header(out, "taskmanager_cpu_busy_percent", "gauge", "CPU time not idle or waiting on I/O, all CPUs");
+    block_printf(out, "taskmanager_cpu_busy_percent %.2f\n", r->cpu_usage);
+    metric_header(out, "taskmanager_cpu_mode_percent", "gauge", "CPU time by mode, all CPUs");
+    const char *modes[] = { "user", "system", "iowait", "irq", "steal" };
+    const float shares[] = { r->cpu_user, r->cpu_system, r->cpu_iowait, r->cpu_irq, r->cpu_steal };
+    for (int i = 0; i < 5; i++) {
+        block_printf(out, "taskmanager_cpu_mode_percent{mode=\"%s\"} %.2f\n", modes[i], shares[i]);
+    }
+    metric_header(out, "taskmanager_cpu_core_busy_percent", "gauge", "CPU time not idle or waiting on I/O, per logical CPU");
+    for (int i = 0; i < sys_core_count; i++) {
+        block_printf(out, "taskmanager_cpu_core_busy_percent{cpu=\"%d\"} %.2f\n", i, sys_cores[i].usage);
+    }
+    if (r->cpu_freq) {
+        metric_header(out, "taskmanager_cpu_frequency_hertz", "gauge", "Average clock of the online CPUs");
+        block_printf(out, "taskmanager_cpu_frequency_hertz %llu\n", (unsigned long long)r->cpu_freq * 1000000);
+    }
+    if (r->temperature > 0) {
+        metric_header(out, "taskmanager_cpu_temperature_celsius", "gauge", "CPU package temperature (hwmon)");
+        block_printf(out, "taskmanager_cpu_temperature_celsius %.1f\n", r->temperature / 1000.0);
+    }
+
+    metric_header(out, "taskmanager_memory_bytes", "gauge", "Physical memory from /proc/meminfo");
+    const char *kinds[] = { "total", "free", "available", "cached", "buffers" };
+    const uint64_t mem[] = { r->mem_total, r->mem_free, r->mem_available, r->mem_cached, r->mem_buffers };
+    for (int i = 0; i < 5; i++) {
+        block_printf(out, "taskmanager_memory_bytes{kind=\"%s\"} %llu\n", kinds[i], (unsigned long long)mem[i] * 1024);
+    }
+    metric_header(out, "taskmanager_root_filesystem_bytes", "gauge", "Size of the filesystem mounted at /");
+    block_printf(out, "taskmanager_root_filesystem_bytes{kind=\"total\"} %llu\n"
+                 "taskmanager_root_filesystem_bytes{kind=\"free\"} %llu\n"
+                 "taskmanager_root_filesystem_bytes{kind=\"available\"} %llu\n",
+                 (unsigned long long)r->fs_total, (unsigned long long)r->fs_free, (unsigned long long)r->fs_avail);
+
+    metric_header(out, "taskmanager_disk_read_bytes_total", "counter", "Bytes read from whole disks since boot");
+    block_printf(out, "taskmanager_disk_read_bytes_total %llu\n", (unsigned long long)r->disk_read);
+    metric_header(out, "taskmanager_disk_written_bytes_total", "counter", "Bytes written to whole disks since boot");
+    block_printf(out, "taskmanager_disk_written_bytes_total %llu\n", (unsigned long long)r->disk_written);
+    metric_header(out, "taskmanager_network_received_bytes_total", "counter", "Bytes received on every interface but lo");
+    block_printf(out, "taskmanager_network_received_bytes_total %llu\n", (unsigned long long)r->net_received);
+    metric_header(out, "taskmanager_network_sent_bytes_total", "counter", "Bytes sent on every interface but lo");
+    block_printf(out, "taskmanager_network_sent_bytes_total %llu\n", (unsigned long long)r->net_sent);
+    metric_header(out, "taskmanager_uptime_seconds", "gauge", "Time since boot");
+    block_printf(out, "taskmanager_uptime_seconds %llu\n", (unsigned long long)r->uptime);
+}
+
+// Make a sampler's new section the one scrapes return
+static void publish_metrics(sampler *s) {
+    pthread_mutex_lock(&metrics_lock);
+    arena latest = metrics_published[s->id];
+    metrics_published[s->id] = s->metrics.buf;
+    s->metrics.buf = latest;
+    pthread_mutex_unlock(&metrics_lock);
+    arena_reset(&s->metrics.buf);
+}
+
+static int send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Answer one HTTP/1.x request: GET or HEAD /metrics, anything else is a 404
+static void serve_scrape(int fd, output_block *body) {
+    char req[LISTEN_REQUEST_SIZE];
+    size_t used = 0;
+    while (used < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + used, sizeof(req) - 1 - used, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        used += (size_t)n;
+        req[used] = '\0';
+        if (strstr(req, "\r\n\r\n") != NULL || strstr(req, "\n\n") != NULL) break;
+    }
+    req[used] = '\0';
+
+    int head = strncmp(req, "HEAD ", 5) == 0;
+    const char *path = head ? req + 5 : strncmp(req, "GET ", 4) == 0 ? req + 4 : NULL;
+    size_t path_len = path != NULL ? strcspn(path, " ?\r\n") : 0;
+    int found = path_len == 8 && strncmp(path, "/metrics", 8) == 0;
+
+    arena_reset(&body->buf);
+    if (found) {
+        pthread_mutex_lock(&metrics_lock);
+        for (int i = 0; i <= SAMPLER_SYSTEM; i++) {
+            block_write(body, metrics_published[i].data, metrics_published[i].used);
+        }
+        pthread_mutex_unlock(&metrics_lock);
+    } else {
+        block_printf(body, "Metrics are at /metrics\n");
+    }
+
+    char header[256];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                       "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                       path == NULL ? "405 Method Not Allowed" : found ? "200 OK" : "404 Not Found",
+                       body->buf.used);
+    if (send_all(fd, header, (size_t)len) == 0 && !head) {
+        send_all(fd, body->buf.data, body->buf.used);
+    }
+}
+
+// Scrapes are served one at a time; each is bounded by LISTEN_TIMEOUT_S
+static void *listen_thread(void *arg) {
+    (void)arg;
+    output_block body = {0};
+    while (1) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        struct timeval tv = { .tv_sec = LISTEN_TIMEOUT_S };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        serve_scrape(fd, &body);
+        close(fd);
+    }
+    return NULL;
+}
+
+// Bind [HOST:]PORT (HOST may be [v6addr]; no HOST = every interface) and
+// start serving /metrics
+int listen_open(const char *spec) {
+    char host[NAME_SIZE] = "";
+    const char *port = spec;
+    const char *colon = strrchr(spec, ':');
+    if (colon != NULL) {
+        size_t len = (size_t)(colon - spec);
+        if (len >= 2 && spec[0] == '[' && spec[len - 1] == ']') {
+            spec++;
+            len -= 2;
+        }
+        if (len >= sizeof(host)) return -1;
+        memcpy(host, spec, len);
+        host[len] = '\0';
+        port = colon + 1;
+    }
+
+    char *end;
+    long port_number = strtol(port, &end, 10);
+    if (*port == '\0' || *end != '\0' || port_number < 1 || port_number > 65535) return -1;
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM,
+                              .ai_flags = AI_PASSIVE | AI_NUMERICSERV };
+    struct addrinfo *res;
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res) != 0) return -1;
+
+    // IPv6 addresses first: with no HOST the IPv6 wildcard accepts IPv4 too
+    // (unless bindv6only is set); fall back to the others if it cannot bind
+    int fd = -1;
+    for (int pass = 0; pass < 2 && fd < 0; pass++) {
+        for (struct addrinfo *ai = res; ai != NULL && fd < 0; ai = ai->ai_next) {
+            if ((ai->ai_family == AF_INET6) != (pass == 0)) continue;
+
+            fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            int one = 1;
+            if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+                            bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, LISTEN_BACKLOG) != 0)) {
+                close(fd);
+                fd = -1;
             }
         }
     }
-    
-    // Send ALL processes (no artificial limit to prevent flickering)
-    for (int i = 0; i < p_count; i++) {
-        printf("%d|%s|%c|%.2f|%lu|%d\n",
-               plist[i].pid,
-               plist[i].name,
-               plist[i].state,
-               plist[i].cpu_usage,
-               plist[i].memory,
-               plist[i].threads);
+    freeaddrinfo(res);
+    if (fd < 0) return -1;
+    listen_fd = fd;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, listen_thread, NULL) != 0) return -1;
+    pthread_detach(tid);
+    return 0;
+}
+
+uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// CPU time the calling thread has used
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Read and write calls (syscr + syscw) in the I/O accounting file at path,
+// 0 if it cannot be read
+static uint64_t read_syscalls(const char *path) {
+    char buf[STAT_BUF_SIZE];
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+
+    static const char syscr_key[] = "\nsyscr: ", syscw_key[] = "\nsyscw: ";
+    char *syscr = strstr(buf, syscr_key);
+    char *syscw = strstr(buf, syscw_key);
+    if (syscr == NULL || syscw == NULL) return 0;
+    return strtoull(syscr + sizeof(syscr_key) - 1, NULL, 10) + strtoull(syscw + sizeof(syscw_key) - 1, NULL, 10);
+}
+
+// Read and write calls the calling thread has made, 0 without task I/O
+// accounting. This read of /proc/thread-self/io is one of them; it always
+// uses the real /proc.
+static uint64_t thread_syscalls(void) {
+    return read_syscalls("/proc/thread-self/io");
+}
+
+static const char *const sampler_names[] = { [SAMPLER_PROCESS] = "process", [SAMPLER_GPU] = "gpu",
+                                             [SAMPLER_SYSTEM] = "system" };
+
+// Lead every block with when it was sampled, so the reader can compute rates
+// over the real interval and notice skipped periods
+static void output_tick(output_block *out, const tick_record *tick) {
+    if (format == FORMAT_BINARY) {
+        frame_begin(out, FRAME_TICK);
+        frame_append(out, tick, sizeof(*tick));
+        frame_end(out, 1);
+    } else if (format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"tick\",\"sampler\":\"%s\",\"timestamp_ns\":%llu,\"delta_ns\":%llu,"
+                     "\"missed\":%u}\n", sampler_names[tick->sampler],
+                     (unsigned long long)tick->timestamp_ns, (unsigned long long)tick->delta_ns, tick->missed);
+    } else {
+        block_printf(out, "TICK|%u|%llu|%llu|%u\n", tick->sampler,
+                     (unsigned long long)tick->timestamp_ns,
+                     (unsigned long long)tick->delta_ns, tick->missed);
     }
-    printf("END\n");
-    fflush(stdout);
 }
 
+// Close every block with what producing it cost
+static void output_sampler_stats(output_block *out, const sampler_stats_record *stats) {
+    if (format == FORMAT_BINARY) {
+        frame_begin(out, FRAME_SAMPLER_STATS);
+        frame_append(out, stats, sizeof(*stats));
+        frame_end(out, 1);
+    } else if (format == FORMAT_JSONL) {
+        block_printf(out, "{\"type\":\"sampler_stats\",\"sampler\":\"%s\",\"sample_ns\":%llu,"
+                     "\"serialize_ns\":%llu,\"cpu_ns\":%llu,\"scan_ns\":%llu,\"sort_ns\":%llu,"
+                     "\"opens\":%u,\"syscalls\":%u}\n", sampler_names[stats->sampler],
+                     (unsigned long long)stats->sample_ns, (unsigned long long)stats->serialize_ns,
+                     (unsigned long long)stats->cpu_ns, (unsigned long long)stats->scan_ns,
+                     (unsigned long long)stats->sort_ns, stats->opens, stats->syscalls);
+    } else {
+        block_printf(out, "STATS|%u|%llu|%llu|%llu|%llu|%llu|%u|%u\n", stats->sampler,
+                     (unsigned long long)stats->sample_ns, (unsigned long long)stats->serialize_ns,
+                     (unsigned long long)stats->cpu_ns, (unsigned long long)stats->scan_ns,
+                     (unsigned long long)stats->sort_ns, stats->opens, stats->syscalls);
+    }
+}
 
+// Wake on absolute CLOCK_MONOTONIC deadlines: the period stays fixed no matter
+// how long sampling takes, and an overrun skips whole periods instead of drifting
+static void *sampler_thread(void *arg) {
+    sampler *s = arg;
+    uint64_t period = (uint64_t)*s->interval_ms * 1000000ull;
+    uint64_t deadline = monotonic_ns();
+    uint64_t last = 0;
+    uint32_t missed = 0;
+    uint64_t syscalls = thread_syscalls();
 
-int main(void) {
     while (1) {
+        uint64_t now = monotonic_ns();
+        tick_record tick = {
+            .timestamp_ns = now,
+            .delta_ns = last ? now - last : 0,
+            .sampler = s->id,
+            .missed = missed
+        };
+        last = now;
+
+        uint32_t opens = thread_opens;
+        uint64_t cpu = thread_cpu_ns();
+        s->sample();
+        sampler_stats_record stats = {
+            .sample_ns = monotonic_ns() - now,
+            .sampler = s->id,
+            .opens = thread_opens - opens
+        };
+        if (s->id == SAMPLER_PROCESS) {
+            stats.scan_ns = process_scan_ns;
+            stats.sort_ns = process_sort_ns;
+        }
+
+        if (listen_fd >= 0) {
+            s->export_metrics(&s->metrics);
+            publish_metrics(s);
+        }
+
+        if (format != FORMAT_NONE) {
+            pthread_mutex_lock(&output_lock);
+            output_tick(&s->out, &tick);
+            uint64_t serialize_began = monotonic_ns();
+            s->serialize(&s->out);
+            stats.serialize_ns = monotonic_ns() - serialize_began;
+            stats.cpu_ns = thread_cpu_ns() - cpu;
+            uint64_t calls = thread_syscalls();
+            stats.syscalls = calls >= syscalls ? (uint32_t)(calls - syscalls) : 0;
+            syscalls = calls;
+            output_sampler_stats(&s->out, &stats);
+            submit_block(&s->out);
+            pthread_mutex_unlock(&output_lock);
+        }
+
+        deadline += period;
+        now = monotonic_ns();
+        missed = 0;
+        if (now >= deadline) {
+            uint64_t behind = (now - deadline) / period + 1;
+            missed = (uint32_t)behind;
+            deadline += behind * period;
+        }
+
+        struct timespec ts = { .tv_sec = deadline / 1000000000ull, .tv_nsec = deadline % 1000000000ull };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+    }
+    return NULL;
+}
+
+// --bench-pids: write one fixture file under root
+static int write_fixture_file(const char *root, const char *name, const char *fmt, ...) {
+    char path[PATH_SIZE + 32];
+    char buf[STAT_BUF_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (len < 0 || (size_t)len >= sizeof(buf)) return -1;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    int ok = write(fd, buf, (size_t)len) == len;
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+// A synthetic /proc holding what a scan reads: stat with the CPU and task
+// totals, then stat, status, cgroup and io for PIDs 1..pids. PID 1 is the
+// root of a tree BENCH_FIXTURE_FANOUT wide. Counters do not move between
+// scans, so only the cost of reading and parsing is measured.
+static int write_proc_fixture(const char *root, int pids) {
+    if (mkdir(root, 0755) != 0 && errno != EEXIST) return -1;
+    if (write_fixture_file(root, "stat", "cpu  100000 0 50000 800000 1000 0 500 0 0 0\n"
+                           "cpu0 100000 0 50000 800000 1000 0 500 0 0 0\n"
+                           "procs_running 1\nprocs_blocked 0\n") != 0) return -1;
+
+    char name[64];
+    for (int pid = 1; pid <= pids; pid++) {
+        int ppid = pid == 1 ? 0 : (pid - 2) / BENCH_FIXTURE_FANOUT + 1;
+        uint32_t uid = pid == 1 ? 0 : 1000 + (uint32_t)(pid % 4);
+
+        snprintf(name, sizeof(name), "%d", pid);
+        char path[PATH_SIZE + 32];
+        snprintf(path, sizeof(path), "%s/%s", root, name);
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+
+        // All 52 fields, as the kernel writes them
+        snprintf(name, sizeof(name), "%d/stat", pid);
+        if (write_fixture_file(root, name, "%d (bench-%d) S %d %d %d 0 -1 4194560 %d 0 0 0 %d %d 0 0 20 0 %d 0 %d "
+                               "%d %d 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                               pid, pid, ppid, pid, ppid, pid * 10, pid % 500, pid % 100, 1 + pid % 4, 1000 + pid,
+                               4096 * (1000 + pid % 4000), 100 + pid % 10000) != 0) return -1;
+
+        snprintf(name, sizeof(name), "%d/status", pid);
+        if (write_fixture_file(root, name, "Name:\tbench-%d\nUmask:\t0022\nState:\tS (sleeping)\nTgid:\t%d\n"
+                               "Ngid:\t0\nPid:\t%d\nPPid:\t%d\nTracerPid:\t0\nUid:\t%u\t%u\t%u\t%u\n"
+                               "Gid:\t%u\t%u\t%u\t%u\nFDSize:\t64\nVmRSS:\t%d kB\nThreads:\t%d\n",
+                               pid, pid, pid, ppid, uid, uid, uid, uid, uid, uid, uid, uid,
+                               4 * (100 + pid % 10000), 1 + pid % 4) != 0) return -1;
+
+        snprintf(name, sizeof(name), "%d/cgroup", pid);
+        if (write_fixture_file(root, name, "0::/bench.slice/bench-%d.service\n",
+                               pid % BENCH_FIXTURE_CGROUPS) != 0) return -1;
+
+        snprintf(name, sizeof(name), "%d/io", pid);
+        if (write_fixture_file(root, name, "rchar: %d\nwchar: %d\nsyscr: %d\nsyscw: %d\nread_bytes: %d\n"
+                               "write_bytes: %d\ncancelled_write_bytes: 0\n",
+                               pid * 4096, pid * 1024, pid, pid, pid * 512, pid * 256) != 0) return -1;
+    }
+    return 0;
+}
+
+// Undo write_proc_fixture() in a directory it created
+static void remove_proc_fixture(const char *root, int pids) {
+    static const char *const files[] = { "stat", "status", "cgroup", "io" };
+    char path[PATH_SIZE + 32];
+    for (int pid = 1; pid <= pids; pid++) {
+        for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+            snprintf(path, sizeof(path), "%s/%d/%s", root, pid, files[i]);
+            unlink(path);
+        }
+        snprintf(path, sizeof(path), "%s/%d", root, pid);
+        rmdir(path);
+    }
+    snprintf(path, sizeof(path), "%s/stat", root);
+    unlink(path);
+    rmdir(root);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentiles of samples (sorted in place), in milliseconds
+static void print_percentiles(const char *label, uint64_t *samples, int n) {
+    qsort(samples, (size_t)n, sizeof(uint64_t), compare_u64);
+    static const int percents[] = { 50, 90, 99 };
+    printf("%-20s", label);
+    for (size_t i = 0; i < sizeof(percents) / sizeof(percents[0]); i++) {
+        int index = (percents[i] * n + 99) / 100 - 1;
+        printf(" %9.3f", samples[index < 0 ? 0 : index] / 1e6);
+    }
+    printf(" %9.3f\n", samples[n - 1] / 1e6);
+}
+
+// --bench N: time N process scans (after one that fills the caches) and their
+// serialization in the chosen --format, then print percentiles to stdout.
+// With fixture_pids the scans read a synthetic /proc that many PIDs large,
+// written to --proc-root if given (and kept) or to a temporary directory.
+// Returns -1, with a message, if nothing could be scanned.
+int run_bench(int scans, int fixture_pids) {
+    uint64_t *samples = calloc((size_t)scans * 4, sizeof(uint64_t));
+    if (samples == NULL) return -1;
+    uint64_t *total = samples, *scan = samples + scans, *sort = samples + 2 * scans, *serialize = samples + 3 * scans;
+
+    char temp_root[] = "/tmp/task_manager-bench-XXXXXX";
+    int remove_root = 0;
+    if (fixture_pids > 0) {
+        if (strcmp(proc_root, "/proc") == 0) {
+            if (mkdtemp(temp_root) == NULL) {
+                fprintf(stderr, "Cannot create a fixture directory in /tmp\n");
+                free(samples);
+                return -1;
+            }
+            proc_root = temp_root;
+            remove_root = 1;
+        }
+        if (write_proc_fixture(proc_root, fixture_pids) != 0) {
+            fprintf(stderr, "Cannot write a %d PID fixture to %s\n", fixture_pids, proc_root);
+            if (remove_root) remove_proc_fixture(proc_root, fixture_pids);
+            free(samples);
+            return -1;
+        }
+
+        // The fixture's last PID made pid read and pid write calls; check the
+        // counter parsing the syscalls column relies on against it
+        char io_path[PATH_SIZE + 32];
+        snprintf(io_path, sizeof(io_path), "%s/%d/io", proc_root, fixture_pids);
+        uint64_t calls = read_syscalls(io_path);
+        if (calls != 2 * (uint64_t)fixture_pids) {
+            fprintf(stderr, "%s: read %llu read and write calls, expected %d\n", io_path,
+                    (unsigned long long)calls, 2 * fixture_pids);
+            if (remove_root) remove_proc_fixture(proc_root, fixture_pids);
+            free(samples);
+            return -1;
+        }
+    }
+
+    output_block out = {0};
+    uint64_t opens = 0;
+    uint64_t syscalls = 0;
+
+    read_process_info();
+    if (proc_dir == NULL) {
+        free(samples);
+        return -1;
+    }
+    for (int i = 0; i < scans; i++) {
+        uint32_t opens_before = thread_opens;
+        uint64_t syscalls_before = thread_syscalls();
+        uint64_t began = monotonic_ns();
         read_process_info();
-        output_gpu_info();
-        sleep(2);
+        uint64_t sampled = monotonic_ns();
+        if (format != FORMAT_NONE) {
+            output_process_info(&out);
+            arena_reset(&out.buf);
+        }
+        serialize[i] = monotonic_ns() - sampled;
+        total[i] = sampled - began;
+        scan[i] = process_scan_ns;
+        sort[i] = process_sort_ns;
+        opens += thread_opens - opens_before;
+        uint64_t calls = thread_syscalls();
+        if (calls > syscalls_before) syscalls += calls - syscalls_before - 1;   // not the second read
+    }
+
+    printf("%d scans of %s, %d processes\n", scans, proc_root, p_count);
+    printf("%-20s %9s %9s %9s %9s\n", "ms", "p50", "p90", "p99", "max");
+    print_percentiles("read_process_info", total, scans);
+    print_percentiles("  /proc scan", scan, scans);
+    print_percentiles("  sort", sort, scans);
+    if (format != FORMAT_NONE) print_percentiles("serialize", serialize, scans);
+    printf("per scan: %.1f files opened, %.1f read and write calls\n",
+           (double)opens / scans, (double)syscalls / scans);
+
+    free(samples);
+    if (remove_root) remove_proc_fixture(proc_root, fixture_pids);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--top N] [--format text|binary|jsonl] [--delta] [--keyframe-interval N]\n"
+                    "          [--interval-ms MS] [--gpu-interval-ms MS] [--system-interval-ms MS]\n"
+                    "          [--proc-events] [--windows] [--history FILE]\n"
+                    "          [--listen [HOST:]PORT] [--listen-top N] [--shm-fd FD] [--process-net] [--pss]\n"
+                    "          [--cgroups] [--commands] [--bench N [--bench-pids N] [--proc-root DIR]]\n", prog);
+    fprintf(stderr, "  --top N          only send the N processes with the highest CPU usage\n");
+    fprintf(stderr, "  --format FORMAT  text (default, pipe-delimited lines), binary (length-prefixed frames)\n"
+                    "                   or jsonl (one JSON object per line)\n");
+    fprintf(stderr, "  --delta          binary only: send changed, new and exited processes between keyframes\n");
+    fprintf(stderr, "  --keyframe-interval N  frames between full snapshots in --delta mode (default %d)\n",
+            DEFAULT_KEYFRAME_INTERVAL);
+    fprintf(stderr, "  --interval-ms MS     process sampling period (default %d)\n", DEFAULT_INTERVAL_MS);
+    fprintf(stderr, "  --gpu-interval-ms MS GPU sampling period, independent of processes (default %d)\n",
+            DEFAULT_GPU_INTERVAL_MS);
+    fprintf(stderr, "  --system-interval-ms MS  CPU, memory, disk and network totals period (default %d)\n",
+            DEFAULT_SYSTEM_INTERVAL_MS);
+    fprintf(stderr, "  --proc-events        track process creation through the proc connector and exits through\n"
+                    "                       taskstats instead of listing /proc every tick (needs CAP_NET_ADMIN)\n");
+    fprintf(stderr, "  --windows            send the PIDs owning top-level windows whenever the X window list\n"
+                    "                       changes (libX11 and $DISPLAY)\n");
+    fprintf(stderr, "  --history FILE       keep 10 minutes at 1 s and 24 hours at 10 s of system metrics\n"
+                    "                       (min / max / avg) in FILE, mmap'd and kept across restarts\n");
+    fprintf(stderr, "  --listen [HOST:]PORT serve Prometheus metrics at http://HOST:PORT/metrics (every interface\n"
+                    "                       without HOST); stdout stays silent unless --format is given too\n");
+    fprintf(stderr, "  --listen-top N       processes with their own metric series, busiest first (default %d)\n",
+            DEFAULT_LISTEN_TOP);
+    fprintf(stderr, "  --shm-fd FD          binary only: write process snapshots to the shared memory file FD\n"
+                    "                       (e.g. an inherited memfd) and send just a notice down the pipe\n");
+    fprintf(stderr, "  --process-net        per-process TCP throughput from sock_diag (other users' processes\n"
+                    "                       need root)\n");
+    fprintf(stderr, "  --pss                PSS and USS from smaps_rollup, re-read adaptively within a time\n"
+                    "                       budget per scan (busy and large processes first)\n");
+    fprintf(stderr, "  --cgroups            CPU, memory, disk and pressure totals of every cgroup v2 group that\n"
+                    "                       holds a process, read from " CGROUP_FS "\n");
+    fprintf(stderr, "  --commands           read KILL commands from stdin: signal a batch of PIDs through pidfds,\n"
+                    "                       escalate to SIGKILL after a timeout and report how each one ended\n");
+    fprintf(stderr, "  --bench N            time N process scans and their serialization, print percentiles\n"
+                    "                       and exit\n");
+    fprintf(stderr, "  --bench-pids N       scan a synthetic /proc of N PIDs, written to --proc-root (kept)\n"
+                    "                       or to a temporary directory\n");
+    fprintf(stderr, "  --proc-root DIR      with --bench, scan DIR instead of /proc\n");
+}
+
+int main(int argc, char **argv) {
+    static const struct option long_options[] = {
+        {"top",    required_argument, NULL, 't'},
+        {"format", required_argument, NULL, 'f'},
+        {"delta",  no_argument,       NULL, 'd'},
+        {"keyframe-interval", required_argument, NULL, 'k'},
+        {"interval-ms", required_argument, NULL, 'i'},
+        {"gpu-interval-ms", required_argument, NULL, 'g'},
+        {"system-interval-ms", required_argument, NULL, 's'},
+        {"proc-events", no_argument,   NULL, 'e'},
+        {"windows", no_argument,       NULL, 'w'},
+        {"history", required_argument, NULL, 'H'},
+        {"listen", required_argument, NULL, 'l'},
+        {"listen-top", required_argument, NULL, 'L'},
+        {"shm-fd", required_argument, NULL, 'm'},
+        {"process-net", no_argument,   NULL, 'n'},
+        {"pss", no_argument,           NULL, 'p'},
+        {"cgroups", no_argument,       NULL, 'c'},
+        {"commands", no_argument,      NULL, 'C'},
+        {"bench", required_argument,   NULL, 'b'},
+        {"bench-pids", required_argument, NULL, 'B'},
+        {"proc-root", required_argument, NULL, 'r'},
+        {"help", no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    int format_given = 0;
+    while ((opt = getopt_long(argc, argv, "h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 't':
+                top_k = atoi(optarg);
+                if (top_k < 0) top_k = 0;
+                break;
+            case 'f':
+                if (strcmp(optarg, "text") == 0) {
+                    format = FORMAT_TEXT;
+                } else if (strcmp(optarg, "binary") == 0) {
+                    format = FORMAT_BINARY;
+                } else if (strcmp(optarg, "jsonl") == 0) {
+                    format = FORMAT_JSONL;
+                } else {
+                    fprintf(stderr, "Unknown format: %s\n", optarg);
+                    return 1;
+                }
+                format_given = 1;
+                break;
+            case 'd':
+                delta_mode = 1;
+                break;
+            case 'k':
+                keyframe_interval = atoi(optarg);
+                if (keyframe_interval < 1) keyframe_interval = 1;
+                break;
+            case 'i':
+                interval_ms = atoi(optarg);
+                if (interval_ms < 100) interval_ms = 100;
+                break;
+            case 'g':
+                gpu_interval_ms = atoi(optarg);
+                if (gpu_interval_ms < 100) gpu_interval_ms = 100;
+                break;
+            case 's':
+                system_interval_ms = atoi(optarg);
+                if (system_interval_ms < 100) system_interval_ms = 100;
+                break;
+            case 'e':
+                proc_events = 1;
+                break;
+            case 'w':
+                track_windows = 1;
+                break;
+            case 'H':
+                history_path = optarg;
+                break;
+            case 'l':
+                listen_addr = optarg;
+                break;
+            case 'L':
+                listen_top = atoi(optarg);
+                if (listen_top < 0) listen_top = 0;
+                break;
+            case 'm':
+                shm_fd = atoi(optarg);
+                break;
+            case 'n':
+                process_net = 1;
+                break;
+            case 'p':
+                pss_mode = 1;
+                break;
+            case 'c':
+                cgroup_mode = 1;
+                break;
+            case 'C':
+                command_mode = 1;
+                break;
+            case 'b':
+                bench_scans = atoi(optarg);
+                if (bench_scans < 1) bench_scans = 1;
+                break;
+            case 'B':
+                bench_pids = atoi(optarg);
+                if (bench_pids < 0) bench_pids = 0;
+                break;
+            case 'r':
+                proc_root = optarg;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((bench_pids > 0 || strcmp(proc_root, "/proc") != 0) && bench_scans == 0) {
+        fprintf(stderr, "--bench-pids and --proc-root require --bench\n");
+        return 1;
+    }
+
+    if (delta_mode && format != FORMAT_BINARY) {
+        fprintf(stderr, "--delta requires --format=binary\n");
+        return 1;
+    }
+
+    // Full snapshots cost the pipe nothing here, so there is nothing for --delta to save
+    if (shm_fd >= 0) {
+        if (format != FORMAT_BINARY || delta_mode) {
+            fprintf(stderr, "--shm-fd requires --format=binary without --delta\n");
+            return 1;
+        }
+        if (shm_open_region(shm_fd) != 0) {
+            fprintf(stderr, "Cannot map --shm-fd %d, sending snapshots down the pipe\n", shm_fd);
+        }
+    }
+
+    // Headless: the endpoint is the only output unless a stream was asked for
+    if (listen_addr != NULL) {
+        if (!format_given) format = FORMAT_NONE;
+        if (listen_open(listen_addr) != 0) {
+            fprintf(stderr, "Cannot listen on %s\n", listen_addr);
+            return 1;
+        }
+    }
+
+    // Falls back to nvidia-smi per sample if the NVIDIA driver library is not present
+    nvml_open();
+
+    if (proc_events && proc_events_start() != 0) {
+        fprintf(stderr, "proc connector unavailable, scanning /proc every tick\n");
+    }
+
+    if (process_net && sock_diag_open() != 0) {
+        fprintf(stderr, "sock_diag unavailable, not measuring per-process network traffic\n");
+    }
+
+    if (cgroup_mode && cgroup_fs_open() != 0) {
+        fprintf(stderr, "No cgroup v2 hierarchy at " CGROUP_FS ", not reading cgroup totals\n");
+    }
+
+    // Measures the same scan the process sampler runs, with the options given above
+    if (bench_scans > 0) {
+        return run_bench(bench_scans, bench_pids) != 0;
+    }
+
+    if (track_windows && format != FORMAT_NONE && window_tracking_start() != 0) {
+        fprintf(stderr, "X display unavailable, not tracking windows\n");
+    }
+
+    // Results go down the same stream as the samples
+    if (command_mode && format != FORMAT_NONE && command_start() != 0) {
+        fprintf(stderr, "Cannot start the command reader, ignoring stdin\n");
+    }
+
+    if (history_path != NULL && history_open(history_path) != 0) {
+        fprintf(stderr, "Cannot open history file %s (in use or not writable), not keeping history\n", history_path);
+    }
+
+    // Each sampler runs on its own thread, so a slow nvidia-smi only delays GPU frames
+    static sampler samplers[] = {
+        { .name = "process", .id = SAMPLER_PROCESS, .interval_ms = &interval_ms,
+          .sample = read_process_info, .serialize = output_process_info,
+          .export_metrics = export_process_metrics },
+        { .name = "gpu", .id = SAMPLER_GPU, .interval_ms = &gpu_interval_ms,
+          .sample = sample_gpu_info, .serialize = output_gpu_info,
+          .export_metrics = export_gpu_metrics },
+        { .name = "system", .id = SAMPLER_SYSTEM, .interval_ms = &system_interval_ms,
+          .sample = sample_system_info, .serialize = output_system_info,
+          .export_metrics = export_system_metrics },
+    };
+
+    for (size_t i = 0; i < sizeof(samplers) / sizeof(samplers[0]); i++) {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, sampler_thread, &samplers[i]) != 0) {
+            fprintf(stderr, "Cannot start %s sampler\n", samplers[i].name);
+            return 1;
+        }
+        pthread_detach(tid);
     }
 
+    // The main thread becomes the writer
+    writer_thread(NULL);
     return 0;
 }
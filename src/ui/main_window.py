@@ -11,7 +11,13 @@ import os
 import sys
 
 from .themes import COLORS, Theme
-from .views import ProcessesView, PerformanceView
+from .views import ProcessesView, PerformanceView, ServicesView
+from .utils import (
+    BinaryFrameReader, TextFrameReader, SnapshotRegion, FrameMailbox, HistoryStore, CACHE_DIR,
+    FRAME_PROCESSES, FRAME_PROCESS_DELTA, FRAME_GPU, FRAME_GPU_PROCESSES, FRAME_TICK,
+    FRAME_SYSTEM, FRAME_CPU_CORES, FRAME_PROCESS_TOTALS, FRAME_WINDOW_PIDS, FRAME_CGROUPS,
+    FRAME_SAMPLER_STATS, FRAME_KILL_RESULTS, SAMPLER_PROCESS, SAMPLER_SYSTEM,
+)
 
 
 class TaskManagerApp:
@@ -20,6 +26,21 @@ class TaskManagerApp:
     Coordinates backend communication and view updates.
     """
 
+    # The backend's --history file: system metrics for the last 24 hours, kept across restarts
+    HISTORY_PATH = os.path.join(CACHE_DIR, 'history.bin')
+
+    # Backend output format: 'binary' (compact frames) or 'text' (readable, for debugging)
+    BACKEND_FORMAT = 'binary'
+    # Binary only: send just the changed/new/exited processes between full keyframes
+    BACKEND_DELTA = True
+    # Binary only: full process snapshots through a shared memfd instead of the
+    # pipe (replaces BACKEND_DELTA; falls back to it without os.memfd_create)
+    BACKEND_SHM = True
+    # How often the Tk loop renders backend frames; newer frames overwrite older ones meanwhile
+    FRAME_POLL_MS = 100
+    # How often the sidebar's status line is refreshed
+    STATUS_POLL_MS = 1000
+
     def __init__(self, root):
         self.root = root
         self.root.title("Task Manager")
@@ -35,7 +56,13 @@ class TaskManagerApp:
         # State
         self.running = True
         self.proc = None
+        self.region = None        # SnapshotRegion shared with the backend (--shm-fd)
         self.current_view = 'processes'
+        self.backend_ticks = {}   # sampler -> (timestamp_ns, delta_ns) of its latest block
+        self.missed_ticks = {}    # sampler -> periods skipped because sampling overran
+        self.backend_stats = {}   # sampler -> SAMPLER_STATS_FIELDS of its latest block: what the backend costs
+        self._kill_request = 0    # id of the last KILL command sent, see send_kill()
+        self.mailbox = FrameMailbox()  # reader thread -> Tk; mailbox.dropped counts frames never rendered
 
         # Setup UI
         self._setup_styles()
@@ -179,6 +206,18 @@ class TaskManagerApp:
         self.performance_tab = self._create_sidebar_button(sidebar, "Performance", 'performance')
         self.performance_tab.pack(fill=tk.X, padx=8, pady=2)
 
+        self.services_tab = self._create_sidebar_button(sidebar, "Services", 'services')
+        self.services_tab.pack(fill=tk.X, padx=8, pady=2)
+
+        # Status line: how well the UI keeps up with the backend
+        self.status_label = tk.Label(
+            sidebar, text="",
+            font=Theme.get_font(Theme.FONT_SIZE_TINY),
+            bg=COLORS['bg_secondary'], fg=COLORS['text_tertiary'],
+            justify=tk.LEFT, anchor='w', wraplength=156
+        )
+        self.status_label.pack(side=tk.BOTTOM, fill=tk.X, padx=12, pady=12)
+
     def _create_sidebar_button(self, parent, text, view_name):
         """Create a sidebar navigation button"""
         btn = tk.Frame(
@@ -239,12 +278,13 @@ class TaskManagerApp:
                 )
 
         # Show/hide views
-        if view_name == 'processes':
-            self.processes_view.pack(fill=tk.BOTH, expand=True)
-            self.performance_view.pack_forget()
-        else:
-            self.performance_view.pack(fill=tk.BOTH, expand=True)
-            self.processes_view.pack_forget()
+        for name, view in self.views.items():
+            if name == view_name:
+                view.pack(fill=tk.BOTH, expand=True)
+            else:
+                view.pack_forget()
+        self.performance_view.set_visible(view_name == 'performance')
+        self.services_view.set_visible(view_name == 'services')
 
     def _create_content(self):
         """Create the main content area"""
@@ -253,7 +293,11 @@ class TaskManagerApp:
 
         # Create views
         self.processes_view = ProcessesView(self.content)
-        self.performance_view = PerformanceView(self.content)
+        self.processes_view.kill_backend = self.send_kill
+        self.performance_view = PerformanceView(self.content, history=HistoryStore(self.HISTORY_PATH))
+        self.services_view = ServicesView(self.content)
+        self.views = {'processes': self.processes_view, 'performance': self.performance_view,
+                      'services': self.services_view}
 
         # Show processes view by default
         self.processes_view.pack(fill=tk.BOTH, expand=True)
@@ -278,7 +322,7 @@ class TaskManagerApp:
             ):
                 print(f"Compiling backend from {source_path}...")
                 result = subprocess.run(
-                    ['gcc', '-o', backend_path, source_path, '-Wall', '-O2'],
+                    ['gcc', '-o', backend_path, source_path, '-Wall', '-O2', '-ldl', '-pthread'],
                     capture_output=True, text=True
                 )
                 if result.returncode != 0:
@@ -287,12 +331,36 @@ class TaskManagerApp:
                     return
 
             # Start backend
+            # --windows: the backend watches the X window list, so no wmctrl polling
+            # --process-net: per-process TCP throughput for the Network column
+            # --pss: RAM column in PSS, so a group's shared pages are not counted once per process
+            # --cgroups: the Services tab shows the kernel's per-cgroup totals
+            # --commands: End task / Force kill go to the backend's stdin, see send_kill()
+            args = [backend_path, f'--format={self.BACKEND_FORMAT}', '--windows', '--process-net', '--pss',
+                    '--cgroups', '--commands']
+            try:
+                os.makedirs(os.path.dirname(self.HISTORY_PATH), exist_ok=True)
+                args += ['--history', self.HISTORY_PATH]
+            except OSError:
+                pass  # no cache directory: graphs just cover the last 60 seconds
+            region_fd = None
+            if self.BACKEND_FORMAT == 'binary' and self.BACKEND_SHM and hasattr(os, 'memfd_create'):
+                try:
+                    region_fd = os.memfd_create('task-manager-snapshots')
+                except OSError:
+                    pass
+            if region_fd is not None:
+                args += ['--shm-fd', str(region_fd)]
+                self.region = SnapshotRegion(region_fd)
+            elif self.BACKEND_FORMAT == 'binary' and self.BACKEND_DELTA:
+                args.append('--delta')
+
             self.proc = subprocess.Popen(
-                [backend_path],
+                args,
+                stdin=subprocess.PIPE,
                 stdout=subprocess.PIPE,
                 stderr=subprocess.PIPE,
-                text=True,
-                bufsize=1
+                pass_fds=(region_fd,) if region_fd is not None else ()
             )
 
             # Start reader thread
@@ -304,84 +372,154 @@ class TaskManagerApp:
 
     def _read_backend(self):
         """Read data from backend"""
-        frame = []
-        gpu_frame = []
-        in_gpu_block = False
+        if self.BACKEND_FORMAT == 'binary':
+            reader = BinaryFrameReader(self.proc.stdout, self.region)
+        else:
+            reader = TextFrameReader(self.proc.stdout)
 
         try:
-            for line in self.proc.stdout:
+            for frame_type, records in reader:
                 if not self.running:
                     break
 
-                line = line.strip()
-                if not line:
-                    continue
-
-                # Handle GPU data block
-                if line == "GPU_START":
-                    in_gpu_block = True
-                    gpu_frame.clear()
-                    continue
-                elif line == "GPU_END":
-                    in_gpu_block = False
-                    if gpu_frame:
-                        self.root.after(0, self._update_gpu, gpu_frame.copy())
-                    continue
-
-                if in_gpu_block:
-                    if line.startswith("GPU|"):
-                        parts = line.split('|')
-                        if len(parts) == 9:  # GPU|index|name|util|mem_used|mem_total|temp|power|power_limit
-                            gpu_frame.append(parts[1:])  # Skip "GPU" prefix
-                    continue
-
-                # Handle process data
-                if line == "END":
-                    if frame:
-                        self.root.after(0, self._update_processes, frame.copy())
-                        frame.clear()
-                    continue
-
-                parts = line.split('|')
-                if len(parts) == 6:
-                    frame.append(parts)
+                if frame_type == FRAME_TICK:
+                    # Precedes the sampler's frames; rates use delta_ns rather than the nominal period
+                    sampler, timestamp_ns, delta_ns, missed = records
+                    self.backend_ticks[sampler] = (timestamp_ns, delta_ns)
+                    if missed:
+                        self.missed_ticks[sampler] = self.missed_ticks.get(sampler, 0) + missed
+                elif frame_type == FRAME_SAMPLER_STATS:
+                    sampler, stats = records
+                    self.backend_stats[sampler] = stats
+                elif frame_type == FRAME_SYSTEM:
+                    _timestamp, delta_ns = self.backend_ticks.get(SAMPLER_SYSTEM, (0, 0))
+                    self.mailbox.put(frame_type, (records, delta_ns))
+                else:
+                    # Rendered by _poll_frames(), never queued as a Tk callback per frame
+                    self.mailbox.put(frame_type, records)
 
         except Exception as e:
             if self.running:
                 print(f"Backend error: {e}")
 
+    def _poll_frames(self):
+        """Render whatever the reader thread left in the mailbox since the last poll"""
+        if not self.running:
+            return
+
+        for frame_type, records in self.mailbox.take():
+            if frame_type == FRAME_PROCESSES:
+                self._update_processes(records)
+            elif frame_type == FRAME_PROCESS_DELTA:
+                self._apply_process_delta(*records)
+            elif frame_type == FRAME_GPU:
+                self._update_gpu(records)
+            elif frame_type == FRAME_GPU_PROCESSES:
+                self._update_gpu_processes(records)
+            elif frame_type == FRAME_SYSTEM:
+                self._update_system(*records)
+            elif frame_type == FRAME_CPU_CORES:
+                self._update_cpu_cores(records)
+            elif frame_type == FRAME_PROCESS_TOTALS:
+                self._update_process_totals(records)
+            elif frame_type == FRAME_WINDOW_PIDS:
+                self.processes_view.set_window_pids(records)
+            elif frame_type == FRAME_CGROUPS:
+                self.services_view.update_data(records)
+            elif frame_type == FRAME_KILL_RESULTS:
+                for request, results in records:
+                    self.processes_view.kill_finished(request, results)
+
+        self.root.after(self.FRAME_POLL_MS, self._poll_frames)
+
     def _update_processes(self, data):
         """Update processes view with new data"""
         self.processes_view.update_data(data)
 
+    def _apply_process_delta(self, changed, exited):
+        """Apply a delta frame to the processes view"""
+        self.processes_view.apply_delta(changed, exited)
+
     def _update_gpu(self, gpu_data):
         """Update performance view with GPU data"""
         self.performance_view.update_gpu_data(gpu_data)
 
+    def _update_system(self, system, delta_ns):
+        """Update performance view with system-wide data from the backend"""
+        self.performance_view.update_system(system, delta_ns)
+
+    def _update_cpu_cores(self, usage):
+        """Update performance view with per-core CPU usage"""
+        self.performance_view.update_cpu_cores(usage)
+
+    def _update_process_totals(self, totals):
+        """Update performance view with the backend's exact process and thread counts"""
+        self.performance_view.update_process_totals(*totals)
+
+    def _update_gpu_processes(self, gpu_procs):
+        """Update per-process GPU memory in the processes view"""
+        self.processes_view.update_gpu_processes(gpu_procs)
+
     def _start_updates(self):
         """Start periodic updates"""
-        self._update_performance()
+        self._poll_frames()
         self._update_window_pids()
-
-    def _update_performance(self):
-        """Update performance view"""
+        self._update_status()
+
+    def _status_lines(self):
+        """Lines of the sidebar's status line"""
+        received, dropped = self.mailbox.totals()
+        lines = [f"{received} frames, {dropped} merged before drawing"]
+        missed = sum(list(self.missed_ticks.values()))
+        if missed:
+            lines.append(f"{missed} sampling periods missed (sampling overran)")
+        # What the backend's last process block cost: wall time, its own CPU and open() calls
+        stats = self.backend_stats.get(SAMPLER_PROCESS)
+        if stats:
+            lines.append(f"Process scan {(stats['sample_ns'] + stats['serialize_ns']) / 1e6:.1f} ms, "
+                         f"{stats['cpu_ns'] / 1e6:.1f} ms CPU, {stats['opens']} files")
+        return lines
+
+    def _update_status(self):
+        """Refresh the status line (the counters are kept by the reader thread)"""
         if not self.running:
             return
-
-        # Always collect performance data so graphs have history from startup
-        self.performance_view.update()
-
-        self.root.after(1000, self._update_performance)
+        text = "\n".join(self._status_lines())
+        if self.status_label.cget('text') != text:
+            self.status_label.configure(text=text)
+        self.root.after(self.STATUS_POLL_MS, self._update_status)
 
     def _update_window_pids(self):
         """Update window PIDs for process classification"""
         if not self.running:
             return
 
+        # Only until the backend's window tracking reports in (no X display: keep polling)
+        if self.processes_view.window_tracking:
+            return
+
         # Run in background, less frequently (10 seconds)
         self.processes_view.update_window_pids()
         self.root.after(10000, self._update_window_pids)
 
+    def send_kill(self, targets, sig, timeout_ms):
+        """
+        Ask the backend to send sig to targets [(pid, start_time_ms or None), ...]
+        in one batch and SIGKILL whatever is still running timeout_ms later.
+        Returns the request id its FRAME_KILL_RESULTS will carry, or None if
+        the backend cannot be reached.
+        """
+        if self.proc is None or self.proc.stdin is None or self.proc.poll() is not None:
+            return None
+        self._kill_request += 1
+        words = ' '.join(str(pid) if start is None else f"{pid}@{start}" for pid, start in targets)
+        try:
+            self.proc.stdin.write(f"KILL {self._kill_request} {int(sig)} {timeout_ms} {words}\n".encode())
+            self.proc.stdin.flush()
+        except (OSError, ValueError):
+            return None
+        return self._kill_request
+
     def _on_close(self):
         """Handle window close"""
         self.running = False
@@ -1,3 +1,12 @@
 """UI Utilities"""
 
-from .icon_loader import IconLoader
+from .icon_loader import IconLoader, CACHE_DIR
+from .history_store import HistoryStore, HISTORY_CPU, HISTORY_MEMORY
+from .frame_mailbox import FrameMailbox
+from .backend_protocol import (
+    BinaryFrameReader, TextFrameReader, SnapshotRegion,
+    FRAME_PROCESSES, FRAME_PROCESS_DELTA, FRAME_GPU, FRAME_GPU_PROCESSES, FRAME_TICK,
+    FRAME_SYSTEM, FRAME_CPU_CORES, FRAME_PROCESS_TOTALS, FRAME_WINDOW_PIDS, FRAME_CGROUPS,
+    FRAME_SAMPLER_STATS, FRAME_KILL_RESULTS, SAMPLER_PROCESS, SAMPLER_SYSTEM,
+    KILL_EXITED, KILL_KILLED, KILL_GONE, KILL_FAILED, KILL_RUNNING,
+)
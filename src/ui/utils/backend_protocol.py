@@ -0,0 +1,433 @@
+"""
+Backend protocol - Decoders for the C backend's output
+Binary layouts mirror the frame structs in src/backend/task_manager.c
+"""
+
+import mmap
+import os
+import struct
+
+# Frame types (binary format)
+FRAME_MAGIC = 0x31464d54  # "TMF1"
+FRAME_NAMES = 1
+FRAME_PROCESSES = 2
+FRAME_GPU = 3
+FRAME_PROCESS_DELTA = 4
+FRAME_GPU_PROCESSES = 5
+FRAME_TICK = 6
+FRAME_SYSTEM = 7
+FRAME_CPU_CORES = 8
+FRAME_PROCESS_TOTALS = 9
+FRAME_WINDOW_PIDS = 10
+FRAME_SHM_PROCESSES = 11  # decoded into FRAME_PROCESSES from the SnapshotRegion
+FRAME_CGROUPS = 12
+FRAME_SAMPLER_STATS = 13
+FRAME_KILL_RESULTS = 14
+
+# frame_header.flags
+FRAME_FLAG_NAMES_RESET = 1  # FRAME_NAMES: the backend cleared its dictionary, ids are reused
+
+# Snapshot region (--shm-fd)
+SHM_MAGIC = 0x31534d54  # "TMS1"
+SHM_VERSION = 1
+
+# tick_record.sampler
+SAMPLER_PROCESS = 1
+SAMPLER_GPU = 2
+SAMPLER_SYSTEM = 3
+
+# kill_result_record.outcome (answers to MainWindow.send_kill)
+KILL_EXITED = 0   # exited after the requested signal
+KILL_KILLED = 1   # outlived the timeout, exited after SIGKILL
+KILL_GONE = 2     # not running, or its PID reused, when the command arrived
+KILL_FAILED = 3   # could not be signalled: error is the errno
+KILL_RUNNING = 4  # still running when the backend stopped waiting
+
+# proc_record.kind
+RECORD_UPDATE = 0
+RECORD_NEW = 1
+RECORD_EXIT = 2
+
+# Native byte order, standard sizes, no padding: both ends are on the same host
+HEADER = struct.Struct('=IHHII')        # magic, type, flags, count, length
+NAME_ENTRY = struct.Struct('=IH')       # id, len (followed by len bytes)
+# memory, pid, name_id, cpu, threads, ppid, session, uid, cgroup_id,
+# disk_read, disk_written, net_received, net_sent (bytes/s), pss, uss (kB), start_time (ms after boot),
+# subtree_memory (kB), subtree_cpu, subtree_disk, subtree_net, state, kind
+PROC_RECORD = struct.Struct('=QiIfiiiIIffffIIQQfffBB2x')
+GPU_RECORD = struct.Struct('=QQiIiiii')   # mem_used, mem_total, index, name_id, util, temp, power, limit
+GPU_PROCESS_RECORD = struct.Struct('=Qii')  # mem_used, gpu_index, pid
+TICK_RECORD = struct.Struct('=QQII')    # timestamp_ns, delta_ns, sampler, missed
+SYSTEM_RECORD = struct.Struct('=13Q6fIi')
+CPU_CORE_RECORD = struct.Struct('=6f')  # usage, user, system, iowait, irq, steal
+PROCESS_TOTALS_RECORD = struct.Struct('=4I')  # processes, threads, running, blocked
+PID_RECORD = struct.Struct('=i')
+# memory (bytes), name_id, processes, cpu, disk_read, disk_written (bytes/s), cpu_pressure, memory_pressure (%)
+CGROUP_RECORD = struct.Struct('=QIIfffff4x')
+# sample_ns, serialize_ns, cpu_ns, scan_ns, sort_ns, sampler, opens, syscalls
+SAMPLER_STATS_RECORD = struct.Struct('=5Q3I4x')
+KILL_RESULT_RECORD = struct.Struct('=IiIi')  # request, pid, outcome, error
+SHM_HEADER = struct.Struct('=4IQQ2I24x')  # magic, version, seq, record_size, size, capacity, count[2]
+SHM_NOTICE = struct.Struct('=II')       # seq, count
+
+# system_record fields, in struct (and SYSTEM| line) order. Memory is in kB,
+# disk / filesystem / network in bytes, uptime in seconds, temperature in
+# millidegrees C (0 = no sensor), cpu_freq in MHz, cpu_* in percent.
+SYSTEM_FIELDS = (
+    'mem_total', 'mem_free', 'mem_available', 'mem_cached', 'mem_buffers',
+    'disk_read', 'disk_written', 'fs_total', 'fs_free', 'fs_avail',
+    'net_received', 'net_sent', 'uptime',
+    'cpu_usage', 'cpu_user', 'cpu_system', 'cpu_iowait', 'cpu_irq', 'cpu_steal',
+    'cpu_freq', 'temperature',
+)
+
+# sampler_stats_record fields after the sampler, in STATS| line order. Times
+# are in nanoseconds; scan_ns and sort_ns are 0 except for SAMPLER_PROCESS.
+SAMPLER_STATS_FIELDS = ('sample_ns', 'serialize_ns', 'cpu_ns', 'scan_ns', 'sort_ns', 'opens', 'syscalls')
+
+
+class SnapshotRegion:
+    """
+    Reader side of the backend's --shm-fd region: process snapshots in two
+    buffers under a seqlock (see shm_header in task_manager.c). The snapshot
+    with sequence s is in buffer (s // 2) % 2 and is intact while seq <= s + 2.
+    """
+
+    def __init__(self, fd):
+        self.fd = fd
+        self._map = None
+
+    def _mapped(self):
+        """Map the region, again if the backend has grown it"""
+        size = os.fstat(self.fd).st_size
+        if self._map is None or len(self._map) != size:
+            if self._map is not None:
+                self._map.close()
+            self._map = mmap.mmap(self.fd, size, access=mmap.ACCESS_READ) if size >= SHM_HEADER.size else None
+        return self._map
+
+    def read(self, seq):
+        """Raw PROC_RECORD tuples of snapshot seq, or None if it has already been overwritten"""
+        m = self._mapped()
+        if m is None:
+            return None
+        magic, version, current, record_size, size, capacity, *counts = SHM_HEADER.unpack_from(m, 0)
+        if magic != SHM_MAGIC or version != SHM_VERSION or record_size != PROC_RECORD.size:
+            return None
+        if current > seq + 1 or size != len(m):
+            return None  # replaced (a notice for the newer one follows) or being regrown
+
+        buffer = (seq // 2) % 2
+        start = SHM_HEADER.size + buffer * capacity
+        with memoryview(m) as view, view[start:start + counts[buffer] * record_size] as records:
+            snapshot = list(PROC_RECORD.iter_unpack(records))
+
+        # The writer may have moved on to this buffer while we were reading it
+        if SHM_HEADER.unpack_from(m, 0)[2] > seq + 2:
+            return None
+        return snapshot
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+        self._map = None
+
+
+class BinaryFrameReader:
+    """
+    Reads length-prefixed frames from the backend (--format=binary).
+    Yields (frame_type, records) with records already converted to Python values:
+      FRAME_PROCESSES -> [(pid, name, state, cpu, mem_kb, threads, uid, ppid, session, cgroup,
+                           disk_read, disk_written, net_received, net_sent, pss_kb, uss_kb,
+                           start_time_ms, subtree_mem_kb, subtree_cpu, subtree_disk, subtree_net), ...]
+                         (full snapshot, rates in bytes/s, pss / uss 0 unless measured;
+                          subtree_* are this process plus all its descendants)
+      FRAME_PROCESS_DELTA -> ([(pid, name, ...same fields...), ...], [exited_pid, ...])
+      FRAME_GPU       -> [[index, name, util, mem_used, mem_total, temp, power, power_limit], ...]
+      FRAME_GPU_PROCESSES -> [(gpu_index, pid, mem_used_mb), ...]
+      FRAME_TICK      -> (sampler, timestamp_ns, delta_ns, missed), ahead of that sampler's frames
+      FRAME_SYSTEM    -> {field: value} keyed by SYSTEM_FIELDS
+      FRAME_CPU_CORES -> [(usage, user, system, iowait, irq, steal), ...] percent, one per logical CPU
+      FRAME_CGROUPS   -> [(path, processes, cpu, memory, disk_read, disk_written,
+                           cpu_pressure, memory_pressure), ...] (--cgroups, after every process frame)
+      FRAME_PROCESS_TOTALS -> (processes, threads, running, blocked), after every process frame
+      FRAME_WINDOW_PIDS -> [pid, ...] owning a top-level window (--windows), whenever that changes
+      FRAME_SAMPLER_STATS -> (sampler, {field: value} keyed by SAMPLER_STATS_FIELDS), what the
+                         backend spent on the block it ends
+      FRAME_KILL_RESULTS -> [(request, [(pid, outcome, error), ...])], one KILL command
+                         (--commands) once all of its targets have an outcome (KILL_*)
+    With a SnapshotRegion (--shm-fd), FRAME_SHM_PROCESSES notices are read from
+    it and yielded as FRAME_PROCESSES; snapshots replaced before their notice
+    was read are skipped.
+    """
+
+    def __init__(self, stream, region=None):
+        self.stream = stream
+        self.region = region
+        self.names = {}  # name_id -> str, filled from FRAME_NAMES
+
+    def _read_exact(self, size):
+        """Read exactly size bytes, or return None at EOF"""
+        data = self.stream.read(size)
+        if data is None or len(data) < size:
+            return None
+        return data
+
+    def __iter__(self):
+        names = self.names
+        while True:
+            header = self._read_exact(HEADER.size)
+            if header is None:
+                return
+
+            magic, frame_type, flags, count, length = HEADER.unpack(header)
+            if magic != FRAME_MAGIC:
+                raise ValueError(f"Bad frame magic {magic:#x}")
+
+            payload = self._read_exact(length) if length else b''
+            if payload is None:
+                return
+
+            if frame_type == FRAME_NAMES:
+                if flags & FRAME_FLAG_NAMES_RESET:
+                    names.clear()  # in place: names is an alias of self.names
+                self._decode_names(payload, count)
+            elif frame_type == FRAME_PROCESSES:
+                yield frame_type, self._processes(PROC_RECORD.iter_unpack(payload))
+            elif frame_type == FRAME_SHM_PROCESSES:
+                seq, _count = SHM_NOTICE.unpack_from(payload)
+                snapshot = self.region.read(seq) if self.region is not None else None
+                if snapshot is not None:
+                    yield FRAME_PROCESSES, self._processes(snapshot)
+            elif frame_type == FRAME_PROCESS_DELTA:
+                changed = []
+                exited = []
+                for (mem, pid, name_id, cpu, threads, ppid, session, uid, cgroup_id,
+                     disk_read, disk_written, net_received, net_sent, pss, uss, start_time,
+                     subtree_mem, subtree_cpu, subtree_disk, subtree_net,
+                     state, kind) in PROC_RECORD.iter_unpack(payload):
+                    if kind == RECORD_EXIT:
+                        exited.append(pid)
+                    else:
+                        # NEW and UPDATE both carry the full record: apply as upserts
+                        changed.append((pid, names.get(name_id, ''), chr(state), cpu, mem, threads,
+                                        uid, ppid, session, names.get(cgroup_id, ''),
+                                        disk_read, disk_written, net_received, net_sent, pss, uss,
+                                        start_time, subtree_mem, subtree_cpu, subtree_disk, subtree_net))
+                yield frame_type, (changed, exited)
+            elif frame_type == FRAME_GPU:
+                yield frame_type, [
+                    [index, names.get(name_id, ''), util, mem_used, mem_total, temp, power, limit]
+                    for mem_used, mem_total, index, name_id, util, temp, power, limit
+                    in GPU_RECORD.iter_unpack(payload)
+                ]
+            elif frame_type == FRAME_GPU_PROCESSES:
+                yield frame_type, [
+                    (gpu_index, pid, mem_used)
+                    for mem_used, gpu_index, pid in GPU_PROCESS_RECORD.iter_unpack(payload)
+                ]
+            elif frame_type == FRAME_TICK:
+                timestamp_ns, delta_ns, sampler, missed = TICK_RECORD.unpack_from(payload)
+                yield frame_type, (sampler, timestamp_ns, delta_ns, missed)
+            elif frame_type == FRAME_SYSTEM:
+                yield frame_type, dict(zip(SYSTEM_FIELDS, SYSTEM_RECORD.unpack_from(payload)))
+            elif frame_type == FRAME_CPU_CORES:
+                yield frame_type, list(CPU_CORE_RECORD.iter_unpack(payload))
+            elif frame_type == FRAME_PROCESS_TOTALS:
+                yield frame_type, PROCESS_TOTALS_RECORD.unpack_from(payload)
+            elif frame_type == FRAME_WINDOW_PIDS:
+                yield frame_type, [pid for (pid,) in PID_RECORD.iter_unpack(payload)]
+            elif frame_type == FRAME_CGROUPS:
+                yield frame_type, [
+                    (names.get(name_id, ''), processes, cpu, memory, disk_read, disk_written,
+                     cpu_pressure, memory_pressure)
+                    for (memory, name_id, processes, cpu, disk_read, disk_written, cpu_pressure,
+                         memory_pressure) in CGROUP_RECORD.iter_unpack(payload)
+                ]
+            elif frame_type == FRAME_SAMPLER_STATS:
+                *values, sampler, opens, syscalls = SAMPLER_STATS_RECORD.unpack_from(payload)
+                yield frame_type, (sampler, dict(zip(SAMPLER_STATS_FIELDS, values + [opens, syscalls])))
+            elif frame_type == FRAME_KILL_RESULTS:
+                results = list(KILL_RESULT_RECORD.iter_unpack(payload))
+                if results:
+                    yield frame_type, [(results[0][0], [(pid, outcome, error)
+                                                        for _request, pid, outcome, error in results])]
+            # Unknown frame types are skipped so newer backends stay compatible
+
+    def _processes(self, records):
+        names = self.names
+        return [
+            (pid, names.get(name_id, ''), chr(state), cpu, mem, threads,
+             uid, ppid, session, names.get(cgroup_id, ''),
+             disk_read, disk_written, net_received, net_sent, pss, uss,
+             start_time, subtree_mem, subtree_cpu, subtree_disk, subtree_net)
+            for (mem, pid, name_id, cpu, threads, ppid, session, uid, cgroup_id,
+                 disk_read, disk_written, net_received, net_sent, pss, uss, start_time,
+                 subtree_mem, subtree_cpu, subtree_disk, subtree_net, state, _kind) in records
+        ]
+
+    def _decode_names(self, payload, count):
+        """Add dictionary entries: repeated {uint32 id, uint16 len, bytes}"""
+        view = memoryview(payload)
+        offset = 0
+        for _ in range(count):
+            name_id, length = NAME_ENTRY.unpack_from(view, offset)
+            offset += NAME_ENTRY.size
+            self.names[name_id] = bytes(view[offset:offset + length]).decode('utf-8', 'replace')
+            offset += length
+
+
+class TextFrameReader:
+    """
+    Reads the pipe-delimited text protocol (--format=text, useful for debugging).
+    Yields the same (frame_type, records) tuples as BinaryFrameReader.
+    """
+
+    def __init__(self, stream):
+        self.stream = stream
+
+    def __iter__(self):
+        frame = []
+        gpu_frame = []
+        gpu_procs = []
+        in_gpu_block = False
+        cgroups = None  # inside CGROUP_START .. CGROUP_END
+
+        for raw in self.stream:
+            line = raw.decode('utf-8', 'replace').strip()
+            if not line:
+                continue
+
+            if line.startswith("TICK|"):
+                parts = line.split('|')
+                if len(parts) == 5:  # TICK|sampler|timestamp_ns|delta_ns|missed
+                    try:
+                        yield FRAME_TICK, tuple(int(p) for p in parts[1:])
+                    except ValueError:
+                        pass
+                continue
+
+            if line.startswith("STATS|"):
+                parts = line.split('|')
+                if len(parts) == len(SAMPLER_STATS_FIELDS) + 2:  # STATS|sampler|sample_ns|...|syscalls
+                    try:
+                        values = [int(p) for p in parts[1:]]
+                        yield FRAME_SAMPLER_STATS, (values[0], dict(zip(SAMPLER_STATS_FIELDS, values[1:])))
+                    except ValueError:
+                        pass
+                continue
+
+            if line.startswith("KILL|"):
+                parts = line.split('|')
+                try:
+                    # KILL|request|pid,outcome,error|...
+                    yield FRAME_KILL_RESULTS, [(int(parts[1]), [tuple(int(v) for v in target.split(','))
+                                                                for target in parts[2:]])]
+                except (ValueError, IndexError):
+                    pass
+                continue
+
+            if line.startswith("SYSTEM|"):
+                parts = line.split('|')[1:]
+                if len(parts) == len(SYSTEM_FIELDS):
+                    try:
+                        values = [float(p) if '.' in p else int(p) for p in parts]
+                        yield FRAME_SYSTEM, dict(zip(SYSTEM_FIELDS, values))
+                    except ValueError:
+                        pass
+                continue
+            elif line.startswith("CPU_CORES"):
+                try:
+                    # CPU_CORES|usage,user,system,iowait,irq,steal|... one group per CPU
+                    yield FRAME_CPU_CORES, [tuple(float(v) for v in core.split(','))
+                                            for core in line.split('|')[1:]]
+                except ValueError:
+                    pass
+                continue
+
+            if line.startswith("TOTALS|"):
+                parts = line.split('|')
+                if len(parts) == 5:  # TOTALS|processes|threads|running|blocked
+                    try:
+                        yield FRAME_PROCESS_TOTALS, tuple(int(p) for p in parts[1:])
+                    except ValueError:
+                        pass
+                continue
+
+            if line.startswith("WINDOWS"):
+                try:
+                    # WINDOWS|pid|pid|...
+                    yield FRAME_WINDOW_PIDS, [int(p) for p in line.split('|')[1:]]
+                except ValueError:
+                    pass
+                continue
+
+            if line == "CGROUP_START":
+                cgroups = []
+                continue
+            elif line == "CGROUP_END":
+                if cgroups is not None:
+                    yield FRAME_CGROUPS, cgroups
+                cgroups = None
+                continue
+            elif cgroups is not None:
+                # CGROUP|processes|cpu|memory|disk_read|disk_written|cpu_pressure|memory_pressure|path
+                parts = line.split('|', 8)
+                if len(parts) == 9 and parts[0] == "CGROUP":
+                    try:
+                        cgroups.append((parts[8], int(parts[1]), float(parts[2]), int(parts[3]),
+                                        float(parts[4]), float(parts[5]), float(parts[6]), float(parts[7])))
+                    except ValueError:
+                        pass
+                continue
+
+            # Handle GPU data block
+            if line == "GPU_START":
+                in_gpu_block = True
+                gpu_frame = []
+                gpu_procs = []
+                continue
+            elif line == "GPU_END":
+                in_gpu_block = False
+                if gpu_frame:
+                    yield FRAME_GPU, gpu_frame
+                    yield FRAME_GPU_PROCESSES, gpu_procs
+                continue
+
+            if in_gpu_block:
+                if line.startswith("GPU|"):
+                    parts = line.split('|')
+                    if len(parts) == 9:  # GPU|index|name|util|mem_used|mem_total|temp|power|power_limit
+                        try:
+                            gpu_frame.append([int(parts[1]), parts[2]] + [int(p) for p in parts[3:]])
+                        except ValueError:
+                            pass
+                elif line.startswith("GPU_PROC|"):
+                    parts = line.split('|')
+                    if len(parts) == 4:  # GPU_PROC|gpu_index|pid|mem_used
+                        try:
+                            gpu_procs.append((int(parts[1]), int(parts[2]), int(parts[3])))
+                        except ValueError:
+                            pass
+                continue
+
+            # Handle process data
+            if line == "END":
+                if frame:
+                    yield FRAME_PROCESSES, frame
+                    frame = []
+                continue
+
+            # pid|name|state|cpu|mem_kb|threads|uid|ppid|session|disk_read|disk_written|net_received|net_sent|pss|uss|
+            # start_time|subtree_cpu|subtree_mem|subtree_disk|subtree_net|cgroup (last: a path may contain '|')
+            parts = line.split('|', 20)
+            if len(parts) == 21:
+                try:
+                    frame.append((int(parts[0]), parts[1], parts[2],
+                                  float(parts[3]), int(parts[4]), int(parts[5]),
+                                  int(parts[6]), int(parts[7]), int(parts[8]), parts[20],
+                                  float(parts[9]), float(parts[10]), float(parts[11]), float(parts[12]),
+                                  int(parts[13]), int(parts[14]), int(parts[15]),
+                                  int(parts[17]), float(parts[16]), float(parts[18]), float(parts[19])))
+                except ValueError:
+                    pass
@@ -0,0 +1,95 @@
+"""
+Frame mailbox - Latest-value hand-off between the backend reader thread and Tk
+The reader never queues callbacks; the Tk loop collects whatever is pending
+"""
+
+import threading
+
+from .backend_protocol import FRAME_PROCESSES, FRAME_PROCESS_DELTA, FRAME_SYSTEM, FRAME_KILL_RESULTS
+
+
+class FrameMailbox:
+    """
+    One slot per frame type. put() (reader thread) overwrites a frame that has
+    not been rendered yet and counts it in dropped; take() (Tk thread) empties
+    the mailbox, so rendering cost is bounded by the UI's poll rate, not by how
+    fast the backend samples.
+
+    Process frames are merged instead of overwritten, because a delta frame
+    only makes sense on top of the ones before it:
+      snapshot + deltas -> one snapshot with the deltas applied
+      delta + delta     -> one delta (last record per pid, exits that stuck)
+    SYSTEM frames carry (system, delta_ns); delta_ns of overwritten frames is
+    added up so rates over the longer interval stay correct. Kill results
+    answer a request each, so they are queued up rather than replaced.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._slots = {}         # frame_type -> latest records not yet taken
+        self._processes = None   # pid -> record, merged process frames not yet taken
+        self._exited = set()     # exited pids not yet taken (delta only)
+        self._full = False       # _processes holds a full snapshot
+        self.received = {}       # frame_type -> frames put
+        self.dropped = {}        # frame_type -> frames overwritten or merged before rendering
+
+    def put(self, frame_type, records):
+        """Store a decoded frame (reader thread)"""
+        with self._lock:
+            self.received[frame_type] = self.received.get(frame_type, 0) + 1
+            if frame_type in (FRAME_PROCESSES, FRAME_PROCESS_DELTA):
+                if self._processes is not None:
+                    self.dropped[frame_type] = self.dropped.get(frame_type, 0) + 1
+                if frame_type == FRAME_PROCESSES:
+                    self._put_snapshot(records)
+                else:
+                    self._put_delta(*records)
+            elif frame_type == FRAME_KILL_RESULTS:
+                self._slots[frame_type] = self._slots.get(frame_type, []) + records
+            else:
+                if frame_type in self._slots:
+                    self.dropped[frame_type] = self.dropped.get(frame_type, 0) + 1
+                    if frame_type == FRAME_SYSTEM:
+                        system, delta_ns = records
+                        records = (system, delta_ns + self._slots[frame_type][1])
+                self._slots[frame_type] = records
+
+    def _put_snapshot(self, records):
+        # A snapshot replaces everything pending, deltas included
+        self._processes = {rec[0]: rec for rec in records}
+        self._exited.clear()
+        self._full = True
+
+    def _put_delta(self, changed, exited):
+        if self._processes is None:
+            self._processes = {}
+            self._full = False
+
+        # Same order as ProcessesView.apply_delta(): exits first, then upserts
+        for pid in exited:
+            self._processes.pop(pid, None)
+            if not self._full:
+                self._exited.add(pid)
+        for rec in changed:
+            self._processes[rec[0]] = rec
+            self._exited.discard(rec[0])
+
+    def totals(self):
+        """(frames put, frames overwritten or merged) over all types, for the status line (any thread)"""
+        with self._lock:
+            return sum(self.received.values()), sum(self.dropped.values())
+
+    def take(self):
+        """Return the pending frames as [(frame_type, records), ...] and empty the mailbox (Tk thread)"""
+        with self._lock:
+            frames = []
+            if self._processes is not None:
+                if self._full:
+                    frames.append((FRAME_PROCESSES, list(self._processes.values())))
+                else:
+                    frames.append((FRAME_PROCESS_DELTA, (list(self._processes.values()), list(self._exited))))
+                self._processes = None
+                self._exited = set()
+            frames.extend(self._slots.items())
+            self._slots = {}
+            return frames
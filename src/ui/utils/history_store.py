@@ -0,0 +1,146 @@
+"""
+History store - Reader for the backend's --history file
+Layout mirrors history_header / history_tier / history_slot in src/backend/task_manager.c
+"""
+
+import math
+import mmap
+import os
+import struct
+import time
+
+HISTORY_MAGIC = 0x31484d54  # "TMH1"
+HISTORY_VERSION = 1
+
+# Metric rings, in file order
+HISTORY_CPU = 0           # %, all CPUs
+HISTORY_MEMORY = 1        # % of MemTotal not available
+HISTORY_DISK_READ = 2     # bytes/s
+HISTORY_DISK_WRITTEN = 3
+HISTORY_NET_RECEIVED = 4
+HISTORY_NET_SENT = 5
+
+HEADER = struct.Struct('=6I')    # magic, version, seq, metrics, tier_count, pad
+TIER = struct.Struct('=4IQQ')    # step_s, slots, head, head_samples, head_time, offset
+SLOT = struct.Struct('=3f')      # min, max, avg
+
+# A reader that keeps racing the writer gives up rather than stall the Tk loop
+READ_RETRIES = 5
+
+
+class HistoryStore:
+    """
+    Read-only view of the history file. The backend writes it under a seqlock
+    (seq is odd while it updates the rings): a read copies what it needs and
+    retries if seq moved meanwhile.
+
+    The file is mapped on first use and re-mapped when its size changes
+    (the backend lays it out afresh after a format change).
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self._map = None
+        self._size = 0
+
+    def _mapped(self):
+        """The current mapping, or None if the file is missing or not a history file"""
+        try:
+            size = os.path.getsize(self.path)
+        except OSError:
+            return None
+        if self._map is not None and size == self._size:
+            return self._map
+
+        self.close()
+        if size < HEADER.size:
+            return None
+        try:
+            with open(self.path, 'rb') as f:
+                self._map = mmap.mmap(f.fileno(), size, access=mmap.ACCESS_READ)
+        except (OSError, ValueError):
+            return None
+        self._size = size
+        return self._map
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+        self._map = None
+
+    def read(self, metric, seconds, max_points):
+        """
+        The last `seconds` of a metric, oldest first, from the finest tier that
+        covers them, merged down to at most max_points (min, max, avg) tuples.
+        Intervals without samples are None. Returns None if there is no history.
+        """
+        m = self._mapped()
+        if m is None:
+            return None
+
+        for _ in range(READ_RETRIES):
+            seq = self._seq(m)
+            if seq is None:
+                return None
+            if seq & 1:
+                continue
+            snapshot = self._read_tier(m, metric, seconds)
+            if self._seq(m) == seq:
+                break
+        else:
+            return None
+        if snapshot is None:
+            return None
+        return self._downsample(snapshot, max_points)
+
+    @staticmethod
+    def _seq(m):
+        magic, version, seq, metrics, tier_count, _pad = HEADER.unpack_from(m, 0)
+        if magic != HISTORY_MAGIC or version != HISTORY_VERSION:
+            return None
+        return seq
+
+    def _read_tier(self, m, metric, seconds):
+        """Slots covering the last `seconds`, newest last, None for gaps"""
+        _magic, _version, _seq, metrics, tier_count, _pad = HEADER.unpack_from(m, 0)
+        if metric >= metrics or tier_count == 0:
+            return None
+
+        tiers = [TIER.unpack_from(m, HEADER.size + i * TIER.size) for i in range(tier_count)]
+        # Finest tier that spans the range, or the coarsest one
+        tier = next((t for t in tiers if t[0] * t[1] >= seconds), tiers[-1])
+        step, count, head, _samples, head_time, offset = tier
+        wanted = min(count, max(1, math.ceil(seconds / step)))
+        if head_time == 0 or offset + metrics * count * SLOT.size > len(m):
+            return [None] * wanted
+
+        # Slots the backend never reached because it was not running are gaps too
+        now = int(time.time())
+        missing = max(0, (now - now % step - head_time) // step)
+        stored = max(0, wanted - missing)
+
+        ring = offset + metric * count * SLOT.size
+        slots = []
+        for i in range(stored - 1, -1, -1):
+            index = (head - i) % count
+            low, high, avg = SLOT.unpack_from(m, ring + index * SLOT.size)
+            slots.append(None if math.isnan(avg) else (low, high, avg))
+        slots.extend([None] * (wanted - stored))
+        return slots
+
+    @staticmethod
+    def _downsample(slots, max_points):
+        """Merge neighbouring slots so at most max_points remain"""
+        if len(slots) <= max_points:
+            return slots
+
+        points = []
+        for b in range(max_points):
+            bucket = [s for s in slots[b * len(slots) // max_points:(b + 1) * len(slots) // max_points]
+                      if s is not None]
+            if bucket:
+                points.append((min(s[0] for s in bucket), max(s[1] for s in bucket),
+                               sum(s[2] for s in bucket) / len(bucket)))
+            else:
+                points.append(None)
+        return points
@@ -1,17 +1,23 @@
 """
 IconLoader - Load application icons from .desktop files and icon themes
 Uses CairoSVG to render SVG icons to PNG for Tkinter display
+Lookups run on a worker thread and land in an on-disk cache under ~/.cache
 """
 
 import os
 import glob
 import subprocess
 import io
+import json
+import queue
+import shutil
+import hashlib
+import threading
 from pathlib import Path
 from typing import Optional, Dict
 
 try:
-    from PIL import Image, ImageTk
+    from PIL import Image, ImageTk, ImageDraw
     HAS_PIL = True
 except ImportError:
     HAS_PIL = False
@@ -23,10 +29,19 @@ except ImportError:
     HAS_CAIROSVG = False
 
 
+CACHE_DIR = os.path.join(os.environ.get('XDG_CACHE_HOME') or os.path.expanduser('~/.cache'), 'task-manager')
+
+
 class IconLoader:
     """
     Loads application icons from the system using SVG with CairoSVG.
     Searches .desktop files and icon themes.
+
+    get_icon() never blocks the Tk thread: an icon not loaded yet is queued
+    for the worker thread and a placeholder is returned. take_ready() (Tk
+    thread) turns finished images into PhotoImages. The .desktop index and
+    the rasterized PNGs are kept in CACHE_DIR, and rebuilt when the
+    modification time of a desktop or icon theme directory changes.
     """
 
     # Standard .desktop file locations
@@ -61,10 +76,98 @@ class IconLoader:
             size: Target icon size in pixels
         """
         self.size = size
-        self._cache: Dict[str, Optional[any]] = {}  # name -> PhotoImage or None
-        self._desktop_cache: Dict[str, Optional[str]] = {}  # name -> icon_name or None
+        self._cache: Dict[str, Optional[any]] = {}  # name -> PhotoImage or None (Tk thread only)
+        self._pending = set()  # names queued for the worker, not in _cache yet
+        self._placeholder = None
+        self._requests = queue.Queue()  # names for the worker
+        self._ready = []  # (name, PIL image or None) finished by the worker
+        self._lock = threading.Lock()
+        self._desktop_index: Dict[str, str] = {}
+        self._icon_cache_dir = None  # PNGs for the current size, theme and directory mtimes
+        if HAS_PIL:
+            threading.Thread(target=self._worker, daemon=True).start()
+
+    def _worker(self):
+        """Index .desktop files once, then resolve queued names in order"""
         self._icon_theme = self._get_icon_theme()
+        self._load_desktop_index()
+        self._icon_cache_dir = self._open_icon_cache()
+        while True:
+            name = self._requests.get()
+            try:
+                img = self._resolve_icon(name)
+            except Exception:
+                img = None
+            with self._lock:
+                self._ready.append((name, img))
+
+    @staticmethod
+    def _dir_stamp(dirs):
+        """[[dir, mtime_ns], ...] of the directories that exist"""
+        stamp = []
+        for d in dirs:
+            try:
+                stamp.append([d, os.stat(d).st_mtime_ns])
+            except OSError:
+                continue
+        return stamp
+
+    @staticmethod
+    def _write_atomic(path, data: bytes):
+        """Write through a temporary file so a crash never leaves half a cache entry"""
+        tmp = f'{path}.{os.getpid()}.tmp'
+        with open(tmp, 'wb') as f:
+            f.write(data)
+        os.replace(tmp, path)
+
+    def _load_desktop_index(self):
+        """Use the cached index when no desktop directory changed, else rebuild and store it"""
+        stamp = self._dir_stamp(self.DESKTOP_DIRS)
+        path = os.path.join(CACHE_DIR, 'desktop_index.json')
+        try:
+            with open(path, 'r') as f:
+                cached = json.load(f)
+            if cached['stamp'] == stamp:
+                self._desktop_index = cached['index']
+                return
+        except (OSError, ValueError, KeyError, TypeError):
+            pass
+
         self._build_desktop_index()
+        try:
+            os.makedirs(CACHE_DIR, exist_ok=True)
+            self._write_atomic(path, json.dumps({'stamp': stamp, 'index': self._desktop_index}).encode())
+        except OSError:
+            pass
+
+    def _theme_dirs(self):
+        """Every directory _find_icon_file() looks in; installing an icon changes one of their mtimes"""
+        dirs = list(self.ICON_DIRS)
+        for theme in self._themes_to_search():
+            for icon_dir in self.ICON_DIRS:
+                theme_path = os.path.join(icon_dir, theme)
+                if not os.path.isdir(theme_path):
+                    continue
+                dirs.append(theme_path)
+                for size in self.ICON_SIZES:
+                    for category in self.ICON_CATEGORIES:
+                        dirs.append(os.path.join(theme_path, size, category))
+        return dirs
+
+    def _open_icon_cache(self):
+        """Directory of cached PNGs for this size, theme and directory state; stale ones are removed"""
+        key = json.dumps([self.size, self._icon_theme, self._dir_stamp(self.DESKTOP_DIRS),
+                          self._dir_stamp(self._theme_dirs())])
+        root = os.path.join(CACHE_DIR, 'icons')
+        path = os.path.join(root, hashlib.sha1(key.encode()).hexdigest()[:16])
+        try:
+            os.makedirs(path, exist_ok=True)
+            for entry in os.listdir(root):
+                if entry != os.path.basename(path):
+                    shutil.rmtree(os.path.join(root, entry), ignore_errors=True)
+        except OSError:
+            return None
+        return path
 
     def _get_icon_theme(self) -> str:
         """Get the current icon theme name"""
@@ -102,7 +205,7 @@ class IconLoader:
 
     def _build_desktop_index(self):
         """Build an index of process names to .desktop files"""
-        self._desktop_index: Dict[str, str] = {}  # lowercase name -> icon name
+        self._desktop_index = {}  # lowercase name -> icon name
 
         for desktop_dir in self.DESKTOP_DIRS:
             if not os.path.exists(desktop_dir):
@@ -173,9 +276,7 @@ class IconLoader:
                 return pixmap_path
 
         # Search in icon themes
-        themes_to_search = [self._icon_theme, 'hicolor', 'breeze', 'Adwaita', 'AdwaitaLegacy', 'HighContrast']
-
-        for theme in themes_to_search:
+        for theme in self._themes_to_search():
             for icon_dir in self.ICON_DIRS:
                 theme_path = os.path.join(icon_dir, theme)
                 if not os.path.exists(theme_path):
@@ -194,6 +295,9 @@ class IconLoader:
 
         return None
 
+    def _themes_to_search(self):
+        return [self._icon_theme, 'hicolor', 'breeze', 'Adwaita', 'AdwaitaLegacy', 'HighContrast']
+
     def _load_svg(self, svg_path: str) -> Optional[Image.Image]:
         """Load an SVG file and convert to PIL Image using CairoSVG"""
         if not HAS_CAIROSVG:
@@ -231,14 +335,15 @@ class IconLoader:
 
     def get_icon(self, process_name: str, root=None) -> Optional[any]:
         """
-        Get an icon for a process name.
+        Get an icon for a process name (Tk thread).
 
         Args:
             process_name: The process name (e.g., 'firefox', 'code')
             root: Tkinter root window (needed for PhotoImage)
 
         Returns:
-            A Tkinter PhotoImage or None if not found
+            A Tkinter PhotoImage, None if there is no icon, or the placeholder
+            while the worker is still loading it (see take_ready())
         """
         if not HAS_PIL:
             return None
@@ -249,6 +354,80 @@ class IconLoader:
         if name_lower in self._cache:
             return self._cache[name_lower]
 
+        if name_lower not in self._pending:
+            self._pending.add(name_lower)
+            self._requests.put(name_lower)
+        return self._get_placeholder()
+
+    @property
+    def pending(self) -> bool:
+        """Icons were requested that take_ready() has not delivered yet"""
+        return bool(self._pending)
+
+    def take_ready(self) -> set:
+        """Create PhotoImages for icons the worker finished (Tk thread); returns their names"""
+        with self._lock:
+            ready, self._ready = self._ready, []
+
+        names = set()
+        for name, img in ready:
+            photo = None
+            if img is not None:
+                try:
+                    photo = ImageTk.PhotoImage(img)
+                except Exception:
+                    photo = None
+            self._cache[name] = photo
+            self._pending.discard(name)
+            names.add(name)
+        return names
+
+    def _get_placeholder(self):
+        """Neutral rounded square, same size as the icons so rows do not shift"""
+        if self._placeholder is None:
+            try:
+                img = Image.new('RGBA', (self.size, self.size), (0, 0, 0, 0))
+                ImageDraw.Draw(img).rounded_rectangle(
+                    (1, 1, self.size - 2, self.size - 2), radius=self.size // 5, fill=(128, 128, 128, 72))
+                self._placeholder = ImageTk.PhotoImage(img)
+            except Exception:
+                self._placeholder = False
+        return self._placeholder or None
+
+    def _cache_file(self, name_lower: str) -> Optional[str]:
+        if self._icon_cache_dir is None:
+            return None
+        return os.path.join(self._icon_cache_dir, hashlib.sha1(name_lower.encode()).hexdigest())
+
+    def _resolve_icon(self, name_lower: str) -> Optional[Image.Image]:
+        """Find and rasterize the icon for a name (worker thread), through the disk cache"""
+        cache_file = self._cache_file(name_lower)
+        if cache_file is not None:
+            if os.path.exists(cache_file + '.none'):
+                return None
+            try:
+                img = Image.open(cache_file + '.png')
+                img.load()
+                return img
+            except (OSError, ValueError):
+                pass
+
+        img = self._lookup_icon(name_lower)
+
+        if cache_file is not None:
+            try:
+                if img is None:
+                    self._write_atomic(cache_file + '.none', b'')
+                else:
+                    png = io.BytesIO()
+                    img.save(png, 'PNG')
+                    self._write_atomic(cache_file + '.png', png.getvalue())
+            except (OSError, ValueError):
+                pass
+        return img
+
+    def _lookup_icon(self, name_lower: str) -> Optional[Image.Image]:
+        """Resolve a name through the .desktop index and icon themes and load it"""
         # Try to find icon name from desktop file
         icon_name = self._desktop_index.get(name_lower)
 
@@ -288,27 +467,11 @@ class IconLoader:
 
         # Find the actual icon file
         icon_path = self._find_icon_file(icon_name)
-
         if not icon_path:
-            self._cache[name_lower] = None
-            return None
-
-        # Load the image
-        img = self._load_image(icon_path)
-
-        if not img:
-            self._cache[name_lower] = None
             return None
 
-        # Convert to PhotoImage
-        try:
-            photo = ImageTk.PhotoImage(img)
-            self._cache[name_lower] = photo
-            return photo
-        except Exception:
-            self._cache[name_lower] = None
-            return None
+        return self._load_image(icon_path)
 
     def clear_cache(self):
-        """Clear the icon cache"""
+        """Clear the in-memory icon cache (the disk cache stays)"""
         self._cache.clear()
@@ -1,5 +1,6 @@
 """Views package"""
 from .processes_view import ProcessesView
 from .performance_view import PerformanceView
+from .services_view import ServicesView
 
-__all__ = ['ProcessesView', 'PerformanceView']
+__all__ = ['ProcessesView', 'PerformanceView', 'ServicesView']
@@ -8,59 +8,139 @@ from tkinter import ttk
 from collections import deque
 import psutil
 import time
+import math
 import subprocess
+import threading
 from ..themes import COLORS, Theme
-from ..widgets import GraphWidget, PerformanceButton
+from ..widgets import GraphWidget, MiniGraphWidget, PerformanceButton
+from ..utils import HISTORY_CPU, HISTORY_MEMORY
+
+# Slow probes (lscpu, statfs of a mount) run on a thread; the Tk loop checks
+# for the result this often, and gives up after PROBE_TIMEOUT_S (stale NFS)
+PROBE_POLL_MS = 100
+PROBE_TIMEOUT_S = 10
+
+# Time ranges the CPU and Memory graphs cycle through (click the range label):
+# (seconds, label, axis label). The first is drawn live from the SYSTEM frames,
+# the others come from the backend's history file as HISTORY_POINTS averages.
+HISTORY_RANGES = (
+    (60, "60 Seconds", "60s"),
+    (600, "10 Minutes", "10m"),
+    (3600, "1 Hour", "1h"),
+    (86400, "24 Hours", "24h"),
+)
+HISTORY_POINTS = 300
+# Panels with a zoomable graph -> history metric
+HISTORY_METRICS = {'cpu': HISTORY_CPU, 'memory': HISTORY_MEMORY}
 
 
 class PerformanceView(tk.Frame):
     """
     Performance view with sidebar navigation and metric panels.
     Displays CPU, Memory, Disk, Network, and GPU statistics.
+
+    Panels are built the first time they are shown. Every tick updates the
+    sidebar buttons and the history, but only the panel on screen is drawn
+    (none while the Performance tab is hidden, see set_visible());
+    _show_panel() brings a panel up to date from the stored history.
+
+    history is a utils.HistoryStore; without one the graphs stay at 60 seconds.
     """
 
-    def __init__(self, parent, **kwargs):
+    def __init__(self, parent, history=None, **kwargs):
         super().__init__(parent, bg=COLORS['bg_primary'], **kwargs)
 
+        self.history = history
+        self._range = {panel: 0 for panel in HISTORY_METRICS}   # panel -> index into HISTORY_RANGES
+        self._range_loaded = {}      # panel -> time.monotonic() its long range was last read
+
         self.cpu_history = deque(maxlen=60)
         self.mem_history = deque(maxlen=60)
         self.gpu_history = deque(maxlen=60)
         self.current_panel = 'cpu'
+        self.visible = False         # Performance tab on screen (set by the main window)
         self.gpu_data = []
         self.has_gpu = False
         self.start_time = time.time()
 
-        # Cached values for expensive operations (updated less frequently)
-        self._thread_count = 0
-        self._proc_count = 0
-        self._cpu_temp = 0
-        self._slow_update_counter = 0
+        # System-wide data from the backend's SYSTEM frames
+        self._last_system = None
+        self.cpu_core_usage = []
+        self.core_history = []       # one deque per logical CPU, from CPU_CORES frames
+        self.core_graphs = []        # one MiniGraphWidget per logical CPU, built with the CPU panel
+        self.show_core_graphs = False
+        self._totals = None          # last PROCESS_TOTALS frame
+        self._rates = {}             # stat label name -> bytes/s, from the last two SYSTEM frames
 
-        # Get CPU info once
+        # Get CPU info once (lscpu runs in the background)
         self._get_cpu_info()
 
         self._create_ui()
+        self._run_probe(self._probe_lscpu, self._apply_lscpu)
 
     def _get_cpu_info(self):
-        """Get static CPU information"""
+        """Get static CPU information (placeholders until _apply_lscpu())"""
         self.cpu_model = "Unknown CPU"
         self.cpu_max_speed = "0 GHz"
         self.cpu_sockets = 1
         self.cpu_cores = psutil.cpu_count(logical=False) or 1
         self.cpu_threads = psutil.cpu_count() or 1
 
-        try:
-            result = subprocess.run(['lscpu'], capture_output=True, text=True)
-            for line in result.stdout.split('\n'):
+    @staticmethod
+    def _probe_lscpu():
+        """Model name, max speed and socket count from lscpu (worker thread)"""
+        info = {}
+        result = subprocess.run(['lscpu'], capture_output=True, text=True, timeout=PROBE_TIMEOUT_S)
+        for line in result.stdout.split('\n'):
+            try:
                 if 'Model name' in line:
-                    self.cpu_model = line.split(':')[1].strip()
+                    info['model'] = line.split(':')[1].strip()
                 elif 'CPU max MHz' in line:
                     max_mhz = float(line.split(':')[1].strip())
-                    self.cpu_max_speed = f"{max_mhz/1000:.2f}GHz"
+                    info['max_speed'] = f"{max_mhz/1000:.2f}GHz"
                 elif 'Socket(s)' in line:
-                    self.cpu_sockets = int(line.split(':')[1].strip())
-        except:
-            pass
+                    info['sockets'] = int(line.split(':')[1].strip())
+            except (IndexError, ValueError):
+                continue
+        return info
+
+    def _apply_lscpu(self, info):
+        if not info:
+            return
+        self.cpu_model = info.get('model', self.cpu_model)
+        self.cpu_max_speed = info.get('max_speed', self.cpu_max_speed)
+        self.cpu_sockets = info.get('sockets', self.cpu_sockets)
+        if 'cpu' in self.panels:
+            self.cpu_model_label.configure(text=self.cpu_model)
+            self.cpu_max_speed_label.configure(text=self.cpu_max_speed)
+            self.cpu_sockets_label.configure(text=str(self.cpu_sockets))
+
+    def _run_probe(self, probe, on_done, *args):
+        """
+        Run probe(*args) on a daemon thread and call on_done(result) on the Tk
+        thread. result is None if the probe failed or did not finish within
+        PROBE_TIMEOUT_S; a hung probe thread is simply abandoned.
+        """
+        result = []
+
+        def run():
+            try:
+                result.append(probe(*args))
+            except Exception:
+                result.append(None)
+
+        deadline = time.monotonic() + PROBE_TIMEOUT_S
+
+        def poll():
+            if result:
+                on_done(result[0])
+            elif time.monotonic() >= deadline:
+                on_done(None)
+            else:
+                self.after(PROBE_POLL_MS, poll)
+
+        threading.Thread(target=run, daemon=True).start()
+        self.after(PROBE_POLL_MS, poll)
 
     def _create_ui(self):
         """Create the performance view UI"""
@@ -85,16 +165,17 @@ class PerformanceView(tk.Frame):
         self.content = tk.Frame(main_container, bg=COLORS['bg_primary'])
         self.content.pack(side=tk.LEFT, fill=tk.BOTH, expand=True, padx=(0, Theme.PADDING_LARGE), pady=(0, Theme.PADDING_MEDIUM))
 
-        # Create panels
+        # Panels are created on first _show_panel()
         self.panels = {}
-        self._create_cpu_panel()
-        self._create_memory_panel()
-        self._create_disk_panel()
-        self._create_network_panel()
-        self._create_gpu_panel()
+        self._panel_builders = {
+            'cpu': self._create_cpu_panel,
+            'memory': self._create_memory_panel,
+            'disk': self._create_disk_panel,
+            'network': self._create_network_panel,
+            'gpu': self._create_gpu_panel,
+        }
 
-        # Show CPU panel by default
-        self._show_panel('cpu')
+        # CPU panel is shown by default, and built once the tab is first shown
 
     def _create_sidebar_buttons(self, parent):
         """Create sidebar navigation buttons"""
@@ -162,11 +243,12 @@ class PerformanceView(tk.Frame):
             bg=COLORS['bg_primary'], fg=COLORS['text_primary']
         ).pack(side=tk.LEFT)
 
-        tk.Label(
+        self.cpu_model_label = tk.Label(
             header, text=self.cpu_model,
             font=Theme.get_font(Theme.FONT_SIZE_SMALL),
             bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
-        ).pack(side=tk.RIGHT)
+        )
+        self.cpu_model_label.pack(side=tk.RIGHT)
 
         # Graph labels row: "% Usage" on left, "100" on right
         graph_labels_top = tk.Frame(panel, bg=COLORS['bg_primary'])
@@ -184,9 +266,22 @@ class PerformanceView(tk.Frame):
             bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
         ).pack(side=tk.RIGHT)
 
+        # Switch between the overall graph and one graph per logical processor
+        self.cpu_graph_toggle = tk.Label(
+            graph_labels_top, text="Logical processors",
+            font=Theme.get_font(Theme.FONT_SIZE_TINY),
+            bg=COLORS['bg_primary'], fg=COLORS['accent'], cursor='hand2'
+        )
+        self.cpu_graph_toggle.pack(side=tk.RIGHT, padx=Theme.PADDING_LARGE)
+        self.cpu_graph_toggle.bind('<Button-1>', lambda e: self._toggle_core_graphs())
+
         # CPU Graph - takes most space (borderless like WSysMon)
         graph_frame = tk.Frame(panel, bg=COLORS['bg_tertiary'])
         graph_frame.pack(fill=tk.BOTH, expand=True, padx=Theme.PADDING_LARGE, pady=2)
+        self.cpu_graph_frame = graph_frame
+
+        # Per-core grid, packed in place of graph_frame when selected
+        self.cpu_cores_frame = tk.Frame(panel, bg=COLORS['bg_primary'])
 
         # Orange colors for CPU graph
         self.cpu_graph = GraphWidget(graph_frame, height=250,
@@ -198,12 +293,9 @@ class PerformanceView(tk.Frame):
         # Graph labels bottom: "60 Seconds" on left, "0" on right
         graph_labels_bottom = tk.Frame(panel, bg=COLORS['bg_primary'])
         graph_labels_bottom.pack(fill=tk.X, padx=Theme.PADDING_LARGE)
+        self.cpu_graph_labels_bottom = graph_labels_bottom
 
-        tk.Label(
-            graph_labels_bottom, text="60 Seconds",
-            font=Theme.get_font(Theme.FONT_SIZE_TINY),
-            bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
-        ).pack(side=tk.LEFT)
+        self.cpu_range_label = self._create_range_label(graph_labels_bottom, 'cpu')
 
         tk.Label(
             graph_labels_bottom, text="0",
@@ -229,12 +321,15 @@ class PerformanceView(tk.Frame):
         self._create_stat_item(left_stats1, "Speed", "0GHz", 'cpu_speed')
         # Processes
         self._create_stat_item(left_stats1, "Processes", "0", 'cpu_procs')
+        # Run queue: tasks running / blocked on I/O right now
+        self._create_stat_item(left_stats1, "Running", "0", 'cpu_running')
+        self._create_stat_item(left_stats1, "Blocked", "0", 'cpu_blocked')
 
         # Right stats
         right_stats1 = tk.Frame(row1, bg=COLORS['bg_primary'])
         right_stats1.pack(side=tk.RIGHT)
 
-        self._create_stat_item_right(right_stats1, "Maximum CPU speed:", self.cpu_max_speed)
+        self.cpu_max_speed_label = self._create_stat_item_right(right_stats1, "Maximum CPU speed:", self.cpu_max_speed)
 
         # Row 2: Threads, Uptime, Temperature | Sockets, Cores, Logical processors
         row2 = tk.Frame(stats_container, bg=COLORS['bg_primary'])
@@ -247,17 +342,32 @@ class PerformanceView(tk.Frame):
         self._create_stat_item(left_stats2, "Threads", "0", 'cpu_threads')
         self._create_stat_item(left_stats2, "Uptime", "00:00:00", 'cpu_uptime')
         self._create_stat_item(left_stats2, "Temperature", "0°C", 'cpu_temp')
+        self._create_stat_item(left_stats2, "I/O wait", "0%", 'cpu_iowait')
+        self._create_stat_item(left_stats2, "Steal", "0%", 'cpu_steal')
 
         # Right stats
         right_stats2 = tk.Frame(row2, bg=COLORS['bg_primary'])
         right_stats2.pack(side=tk.RIGHT)
 
-        self._create_stat_item_right(right_stats2, "Sockets:", str(self.cpu_sockets))
+        self.cpu_sockets_label = self._create_stat_item_right(right_stats2, "Sockets:", str(self.cpu_sockets))
         self._create_stat_item_right(right_stats2, "Cores:", str(self.cpu_cores))
         self._create_stat_item_right(right_stats2, "Logical processors:", str(self.cpu_threads))
 
         self.panels['cpu'] = panel
 
+    def _create_range_label(self, parent, panel):
+        """Bottom-left time range of a graph; clicking it cycles HISTORY_RANGES if there is history"""
+        label = tk.Label(
+            parent, text=HISTORY_RANGES[self._range[panel]][1],
+            font=Theme.get_font(Theme.FONT_SIZE_TINY),
+            bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
+        )
+        label.pack(side=tk.LEFT)
+        if self.history is not None:
+            label.configure(cursor='hand2')
+            label.bind('<Button-1>', lambda e: self._cycle_range(panel))
+        return label
+
     def _create_stat_item(self, parent, label, value, var_name=None):
         """Create a stat item (label on top, value below)"""
         frame = tk.Frame(parent, bg=COLORS['bg_primary'])
@@ -280,7 +390,7 @@ class PerformanceView(tk.Frame):
             setattr(self, f'{var_name}_label', val_label)
 
     def _create_stat_item_right(self, parent, label, value):
-        """Create a right-aligned stat item (label: value on same line)"""
+        """Create a right-aligned stat item (label: value on same line); returns the value label"""
         frame = tk.Frame(parent, bg=COLORS['bg_primary'])
         frame.pack(anchor='e')
 
@@ -290,11 +400,13 @@ class PerformanceView(tk.Frame):
             bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
         ).pack(side=tk.LEFT)
 
-        tk.Label(
+        val_label = tk.Label(
             frame, text=value,
             font=Theme.get_font(Theme.FONT_SIZE_SMALL),
             bg=COLORS['bg_primary'], fg=COLORS['text_primary']
-        ).pack(side=tk.LEFT, padx=(8, 0))
+        )
+        val_label.pack(side=tk.LEFT, padx=(8, 0))
+        return val_label
 
     def _create_memory_panel(self):
         """Create Memory detail panel"""
@@ -350,11 +462,7 @@ class PerformanceView(tk.Frame):
         graph_labels_bottom = tk.Frame(panel, bg=COLORS['bg_primary'])
         graph_labels_bottom.pack(fill=tk.X, padx=Theme.PADDING_LARGE)
 
-        tk.Label(
-            graph_labels_bottom, text="60 Seconds",
-            font=Theme.get_font(Theme.FONT_SIZE_TINY),
-            bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
-        ).pack(side=tk.LEFT)
+        self.mem_range_label = self._create_range_label(graph_labels_bottom, 'memory')
 
         tk.Label(
             graph_labels_bottom, text="0",
@@ -394,25 +502,39 @@ class PerformanceView(tk.Frame):
             bg=COLORS['bg_primary'], fg=COLORS['text_primary']
         ).pack(side=tk.LEFT)
 
-        # Disk info
+        # Throughput across all disks
+        rates = tk.Frame(panel, bg=COLORS['bg_primary'])
+        rates.pack(fill=tk.X, padx=Theme.PADDING_LARGE, pady=(0, Theme.PADDING_SMALL))
+        self._create_stat_item(rates, "Read speed", "0 KB/s", 'disk_read')
+        self._create_stat_item(rates, "Write speed", "0 KB/s", 'disk_write')
+
+        # Disk info: mounts and their usage are probed in the background
         content_area = tk.Frame(panel, bg=COLORS['bg_primary'])
         content_area.pack(fill=tk.BOTH, expand=True, padx=Theme.PADDING_LARGE)
+        self.disk_cards_area = content_area
 
-        try:
-            partitions = psutil.disk_partitions()
-            for part in partitions[:4]:
-                try:
-                    usage = psutil.disk_usage(part.mountpoint)
-                    self._create_disk_card(content_area, part, usage)
-                except:
-                    pass
-        except:
-            pass
+        self.disk_loading_label = tk.Label(
+            content_area, text="Loading disks...",
+            font=Theme.get_font(Theme.FONT_SIZE_SMALL),
+            bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
+        )
+        self.disk_loading_label.pack(anchor='w', pady=8)
+        self._run_probe(psutil.disk_partitions, self._apply_disk_partitions)
 
         self.panels['disk'] = panel
 
-    def _create_disk_card(self, parent, partition, usage):
-        """Create a card for a disk partition"""
+    def _apply_disk_partitions(self, partitions):
+        """One card per mount; each fills in when its own disk_usage() returns"""
+        self.disk_loading_label.destroy()
+        for part in (partitions or [])[:4]:
+            bar, usage_label = self._create_disk_card(self.disk_cards_area, part)
+            self._run_probe(psutil.disk_usage,
+                            lambda usage, bar=bar, usage_label=usage_label:
+                                self._fill_disk_card(bar, usage_label, usage),
+                            part.mountpoint)
+
+    def _create_disk_card(self, parent, partition):
+        """Create a card for a disk partition; returns (bar, usage label) for _fill_disk_card()"""
         card = tk.Frame(parent, bg=COLORS['surface'], highlightbackground=COLORS['border'], highlightthickness=1)
         card.pack(fill=tk.X, pady=8)
 
@@ -434,17 +556,26 @@ class PerformanceView(tk.Frame):
         bar_frame = tk.Frame(inner, bg=COLORS['bg_tertiary'], height=8)
         bar_frame.pack(fill=tk.X, pady=(8, 4))
 
-        used_pct = usage.percent / 100
-        bar = tk.Frame(bar_frame, bg=COLORS['accent'], width=int(used_pct * 300), height=8)
+        bar = tk.Frame(bar_frame, bg=COLORS['accent'], width=0, height=8)
         bar.place(x=0, y=0)
 
-        total_gb = usage.total / (1024**3)
-        used_gb = usage.used / (1024**3)
-        tk.Label(
-            inner, text=f"{used_gb:.1f} GB / {total_gb:.1f} GB ({usage.percent:.0f}%)",
+        usage_label = tk.Label(
+            inner, text="...",
             font=Theme.get_font(Theme.FONT_SIZE_TINY),
             bg=COLORS['surface'], fg=COLORS['text_secondary']
-        ).pack(anchor='w')
+        )
+        usage_label.pack(anchor='w')
+        return bar, usage_label
+
+    def _fill_disk_card(self, bar, usage_label, usage):
+        if usage is None:
+            usage_label.configure(text="Not responding")
+            return
+
+        bar.configure(width=int(usage.percent / 100 * 300))
+        total_gb = usage.total / (1024**3)
+        used_gb = usage.used / (1024**3)
+        usage_label.configure(text=f"{used_gb:.1f} GB / {total_gb:.1f} GB ({usage.percent:.0f}%)")
 
     def _create_network_panel(self):
         """Create Network detail panel"""
@@ -460,6 +591,12 @@ class PerformanceView(tk.Frame):
             bg=COLORS['bg_primary'], fg=COLORS['text_primary']
         ).pack(side=tk.LEFT)
 
+        # Throughput across all interfaces except loopback
+        rates = tk.Frame(panel, bg=COLORS['bg_primary'])
+        rates.pack(fill=tk.X, padx=Theme.PADDING_LARGE, pady=(0, Theme.PADDING_SMALL))
+        self._create_stat_item(rates, "Send", "0 KB/s", 'net_send')
+        self._create_stat_item(rates, "Receive", "0 KB/s", 'net_recv')
+
         content_area = tk.Frame(panel, bg=COLORS['bg_primary'])
         content_area.pack(fill=tk.BOTH, expand=True, padx=Theme.PADDING_LARGE)
 
@@ -605,11 +742,25 @@ class PerformanceView(tk.Frame):
 
         self.panels['gpu'] = panel
 
+    def set_visible(self, visible):
+        """The main window switched tabs; a newly shown tab catches up on what it missed"""
+        self.visible = visible
+        if visible:
+            self._show_panel(self.current_panel)
+
+    @property
+    def _drawn_panel(self):
+        """Panel that is on screen right now, or None"""
+        return self.current_panel if self.visible else None
+
     def _show_panel(self, panel_name):
-        """Show the specified panel"""
+        """Show the specified panel, building it the first time"""
         for name, btn in self.buttons.items():
             btn.set_selected(name == panel_name)
 
+        if panel_name not in self.panels and panel_name in self._panel_builders:
+            self._panel_builders[panel_name]()
+
         for panel in self.panels.values():
             panel.pack_forget()
 
@@ -617,116 +768,227 @@ class PerformanceView(tk.Frame):
             self.panels[panel_name].pack(fill=tk.BOTH, expand=True)
 
         self.current_panel = panel_name
+        self._catch_up_panel()
+
+    def _catch_up_panel(self):
+        """Redraw the current panel from stored history: it was not drawn while hidden"""
+        panel = self.current_panel
+        if panel == 'cpu':
+            self._load_range('cpu')
+            if len(self.core_graphs) != len(self.core_history):
+                self._build_core_graphs(len(self.core_history))
+            for graph, history in zip(self.core_graphs, self.core_history):
+                graph.set_values(history)
+            if self._totals is not None:
+                self._render_totals()
+            if self._last_system is not None:
+                self._render_cpu(self._last_system)
+        elif panel == 'memory':
+            self._load_range('memory')
+            if self._last_system is not None:
+                self._render_memory(self._last_system)
+        elif panel in ('disk', 'network'):
+            self._render_rates()
+        elif panel == 'gpu':
+            self.gpu_graph.set_values(self.gpu_history)
+            if self.gpu_data:
+                self._render_gpu(self.gpu_data[0])
+
+    def _graph_for(self, panel):
+        """(graph, live 60-second history, range label) of a zoomable panel"""
+        if panel == 'cpu':
+            return self.cpu_graph, self.cpu_history, self.cpu_range_label
+        return self.mem_graph, self.mem_history, self.mem_range_label
+
+    def _cycle_range(self, panel):
+        self._range[panel] = (self._range[panel] + 1) % len(HISTORY_RANGES)
+        self._load_range(panel)
+
+    def _load_range(self, panel):
+        """Fill a panel's graph for its selected range: live history, or read from the history file"""
+        graph, live, label = self._graph_for(panel)
+        seconds, text, axis = HISTORY_RANGES[self._range[panel]]
+        label.configure(text=text)
+        if self._range[panel] == 0:
+            graph.set_range(live.maxlen, axis)
+            graph.set_values(live)
+            return
 
-    def update(self):
-        """Update performance metrics"""
-        # Increment slow update counter (for expensive operations)
-        self._slow_update_counter += 1
-        do_slow_update = (self._slow_update_counter % 5 == 0)  # Every 5 seconds
+        points = self.history.read(HISTORY_METRICS[panel], seconds, HISTORY_POINTS) or []
+        graph.set_range(max(len(points), 2), axis)
+        # Gaps (backend not running) draw as 0, like a graph that has not filled up yet
+        graph.set_values([p[2] if p is not None else 0 for p in points])
+        self._range_loaded[panel] = time.monotonic()
 
-        # CPU (fast)
-        cpu_pct = psutil.cpu_percent()
+    def _add_graph_value(self, panel, value):
+        """A new sample for a drawn zoomable graph; long ranges re-read once per point"""
+        if self._range[panel] == 0:
+            self._graph_for(panel)[0].add_value(value)
+            return
+        seconds = HISTORY_RANGES[self._range[panel]][0]
+        if time.monotonic() - self._range_loaded.get(panel, 0) >= seconds / HISTORY_POINTS:
+            self._load_range(panel)
+
+    def update_process_totals(self, processes, threads, running, blocked):
+        """Store a PROCESS_TOTALS frame: exact counts from the backend's last scan"""
+        self._totals = (processes, threads, running, blocked)
+        if self._drawn_panel == 'cpu':
+            self._render_totals()
+
+    def _render_totals(self):
+        processes, threads, running, blocked = self._totals
+        self.cpu_procs_label.configure(text=str(processes))
+        self.cpu_threads_label.configure(text=str(threads))
+        self.cpu_running_label.configure(text=str(running))
+        self.cpu_blocked_label.configure(text=str(blocked))
+
+    def update_system(self, system, delta_ns=0):
+        """
+        Render a SYSTEM frame from the backend (see SYSTEM_FIELDS in
+        utils/backend_protocol.py). delta_ns is the measured time since the
+        previous one, used to turn the cumulative disk / network counters into rates.
+        """
+        # CPU
+        cpu_pct = system['cpu_usage']
         self.cpu_history.append(cpu_pct)
-
-        self.cpu_graph.add_value(cpu_pct)
         self.cpu_btn.set_value(cpu_pct)
         self.cpu_btn.add_data_point(cpu_pct)
 
-        if hasattr(self, 'cpu_usage_label'):
-            self.cpu_usage_label.configure(text=f"{cpu_pct:.2f}%")
-
-        # CPU Speed (fast)
-        try:
-            freq = psutil.cpu_freq()
-            if freq and hasattr(self, 'cpu_speed_label'):
-                self.cpu_speed_label.configure(text=f"{freq.current/1000:.2f}GHz")
-        except:
-            pass
-
-        # Process count (fast) and threads (SLOW - only update every 5 cycles)
-        if do_slow_update:
-            try:
-                self._proc_count = len(psutil.pids())
-                # Thread count is expensive - use cached /proc/stat instead
-                try:
-                    with open('/proc/stat', 'r') as f:
-                        for line in f:
-                            if line.startswith('processes'):
-                                # This isn't thread count, so estimate from process count
-                                break
-                    # Simple estimate: ~2-3 threads per process on average
-                    self._thread_count = self._proc_count * 2
-                except:
-                    self._thread_count = self._proc_count * 2
-            except:
-                pass
-
-        if hasattr(self, 'cpu_procs_label'):
-            self.cpu_procs_label.configure(text=str(self._proc_count))
-        if hasattr(self, 'cpu_threads_label'):
-            self.cpu_threads_label.configure(text=str(self._thread_count))
-
-        # Uptime (fast)
-        uptime_seconds = int(time.time() - psutil.boot_time())
-        hours, remainder = divmod(uptime_seconds, 3600)
-        minutes, seconds = divmod(remainder, 60)
-        if hasattr(self, 'cpu_uptime_label'):
-            self.cpu_uptime_label.configure(text=f"{hours:02d}:{minutes:02d}:{seconds:02d}")
-
-        # CPU Temperature (SLOW - only update every 5 cycles)
-        if do_slow_update:
-            try:
-                temps = psutil.sensors_temperatures()
-                if temps:
-                    for name, entries in temps.items():
-                        if entries:
-                            self._cpu_temp = entries[0].current
-                            break
-            except:
-                pass
-
-        if hasattr(self, 'cpu_temp_label') and self._cpu_temp > 0:
-            self.cpu_temp_label.configure(text=f"{self._cpu_temp:.0f}°C")
-
-        # Memory (fast)
-        mem = psutil.virtual_memory()
-        self.mem_history.append(mem.percent)
-
-        self.mem_graph.add_value(mem.percent)
-        self.mem_btn.set_value(mem.percent)
-        self.mem_btn.add_data_point(mem.percent)
-        self.mem_btn.set_secondary_text(f"{mem.used / (1024**3):.1f} / {mem.total / (1024**3):.1f} GB")
-
-        if hasattr(self, 'mem_used_label') and self.mem_used_label:
-            self.mem_used_label.configure(text=f"{mem.used / (1024**3):.1f} GB")
-        if hasattr(self, 'mem_avail_label') and self.mem_avail_label:
-            self.mem_avail_label.configure(text=f"{mem.available / (1024**3):.1f} GB")
-        if hasattr(self, 'mem_cached_label') and self.mem_cached_label:
-            self.mem_cached_label.configure(text=f"{mem.cached / (1024**3):.1f} GB")
-
-        # Disk (moderately slow - only update every 5 cycles)
-        if do_slow_update:
-            try:
-                disk = psutil.disk_usage('/')
-                self.disk_btn.set_value(disk.percent)
-                self.disk_btn.set_secondary_text(f"{disk.used / (1024**3):.0f} / {disk.total / (1024**3):.0f} GB")
-            except:
-                pass
-
-        # Network (fast)
-        try:
-            net = psutil.net_io_counters()
-            sent_mb = net.bytes_sent / (1024**2)
-            recv_mb = net.bytes_recv / (1024**2)
-            self.net_btn.set_value(0, unit="")
-            self.net_btn.set_secondary_text(f"S: {sent_mb:.0f} MB  R: {recv_mb:.0f} MB")
-        except:
-            pass
+        # Memory (kB)
+        gb = 1024 ** 2
+        mem_total = system['mem_total']
+        mem_used = mem_total - system['mem_available']
+        mem_pct = mem_used / mem_total * 100 if mem_total else 0
+        self.mem_history.append(mem_pct)
+        self.mem_btn.set_value(mem_pct)
+        self.mem_btn.add_data_point(mem_pct)
+        self.mem_btn.set_secondary_text(f"{mem_used / gb:.1f} / {mem_total / gb:.1f} GB")
+
+        # Disk: capacity of / on the button, throughput in the panel
+        fs_used = system['fs_total'] - system['fs_free']
+        fs_usable = fs_used + system['fs_avail']
+        if fs_usable:
+            self.disk_btn.set_value(fs_used / fs_usable * 100)
+            self.disk_btn.set_secondary_text(f"{fs_used / (1024**3):.0f} / {system['fs_total'] / (1024**3):.0f} GB")
+
+        # Network (cumulative, bytes)
+        self.net_btn.set_value(0, unit="")
+        self.net_btn.set_secondary_text(
+            f"S: {system['net_sent'] / (1024**2):.0f} MB  R: {system['net_received'] / (1024**2):.0f} MB")
+
+        last = self._last_system
+        if last is not None and delta_ns > 0:
+            elapsed = delta_ns / 1e9
+            rates = (('disk_read', 'disk_read'), ('disk_written', 'disk_write'),
+                     ('net_sent', 'net_send'), ('net_received', 'net_recv'))
+            for field, var_name in rates:
+                self._rates[var_name] = max(system[field] - last[field], 0) / elapsed
+        self._last_system = system
 
         # GPU
         if self.gpu_data:
             self._update_gpu_display()
 
+        # Only the panel on screen is drawn
+        panel = self._drawn_panel
+        if panel == 'cpu':
+            self._add_graph_value('cpu', cpu_pct)
+            self._render_cpu(system)
+        elif panel == 'memory':
+            self._add_graph_value('memory', mem_pct)
+            self._render_memory(system)
+        elif panel in ('disk', 'network'):
+            self._render_rates()
+
+    def _render_cpu(self, system):
+        self.cpu_usage_label.configure(text=f"{system['cpu_usage']:.2f}%")
+        self.cpu_iowait_label.configure(text=f"{system['cpu_iowait']:.1f}%")
+        self.cpu_steal_label.configure(text=f"{system['cpu_steal']:.1f}%")
+        if system['cpu_freq']:
+            self.cpu_speed_label.configure(text=f"{system['cpu_freq']/1000:.2f}GHz")
+
+        # Uptime
+        hours, remainder = divmod(system['uptime'], 3600)
+        minutes, seconds = divmod(remainder, 60)
+        self.cpu_uptime_label.configure(text=f"{hours:02d}:{minutes:02d}:{seconds:02d}")
+
+        # CPU Temperature (hwmon, millidegrees)
+        if system['temperature'] > 0:
+            self.cpu_temp_label.configure(text=f"{system['temperature'] / 1000:.0f}°C")
+
+    def _render_memory(self, system):
+        gb = 1024 ** 2
+        mem_used = system['mem_total'] - system['mem_available']
+        self.mem_used_label.configure(text=f"{mem_used / gb:.1f} GB")
+        self.mem_avail_label.configure(text=f"{system['mem_available'] / gb:.1f} GB")
+        self.mem_cached_label.configure(text=f"{system['mem_cached'] / gb:.1f} GB")
+
+    def _render_rates(self):
+        """Disk or network throughput labels, whichever panel is showing"""
+        names = ('disk_read', 'disk_write') if self.current_panel == 'disk' else ('net_send', 'net_recv')
+        for var_name in names:
+            if var_name in self._rates:
+                getattr(self, f'{var_name}_label').configure(text=self._format_rate(self._rates[var_name]))
+
+    def update_cpu_cores(self, cores):
+        """Per-logical-CPU breakdown from the backend's CPU_CORES frame"""
+        self.cpu_core_usage = cores
+
+        if len(cores) != len(self.core_history):
+            self.core_history = [deque(maxlen=60) for _ in cores]
+        for history, core in zip(self.core_history, cores):
+            history.append(core[0])
+
+        if self._drawn_panel != 'cpu':
+            return
+        if len(cores) != len(self.core_graphs):
+            self._build_core_graphs(len(cores))
+
+        # Hidden graphs still record history; they skip drawing while unmapped
+        for graph, core in zip(self.core_graphs, cores):
+            graph.add_value(core[0])
+
+    def _build_core_graphs(self, count):
+        """Lay out one small graph per logical CPU in a near-square grid"""
+        for graph in self.core_graphs:
+            graph.destroy()
+        self.core_graphs = []
+
+        cols = max(1, math.ceil(math.sqrt(count)))
+        rows = max(1, math.ceil(count / cols))
+        for col in range(cols):
+            self.cpu_cores_frame.columnconfigure(col, weight=1, uniform='core')
+        for row in range(rows):
+            self.cpu_cores_frame.rowconfigure(row, weight=1, uniform='core')
+
+        for i in range(count):
+            graph = MiniGraphWidget(self.cpu_cores_frame, width=60, height=40,
+                                    line_color=COLORS['graph_line_orange'],
+                                    fill_color=COLORS['graph_fill_orange'])
+            graph.grid(row=i // cols, column=i % cols, sticky='nsew', padx=1, pady=1)
+            self.core_graphs.append(graph)
+
+    def _toggle_core_graphs(self):
+        """Swap the overall CPU graph for the per-core grid and back"""
+        self.show_core_graphs = not self.show_core_graphs
+        if self.show_core_graphs:
+            self.cpu_graph_frame.pack_forget()
+            self.cpu_cores_frame.pack(fill=tk.BOTH, expand=True, padx=Theme.PADDING_LARGE, pady=2,
+                                      before=self.cpu_graph_labels_bottom)
+            self.cpu_graph_toggle.configure(text="Overall utilization")
+        else:
+            self.cpu_cores_frame.pack_forget()
+            self.cpu_graph_frame.pack(fill=tk.BOTH, expand=True, padx=Theme.PADDING_LARGE, pady=2,
+                                      before=self.cpu_graph_labels_bottom)
+            self.cpu_graph_toggle.configure(text="Logical processors")
+
+    @staticmethod
+    def _format_rate(bytes_per_sec):
+        """Format a byte rate for the stat labels"""
+        if bytes_per_sec >= 1024 ** 2:
+            return f"{bytes_per_sec / (1024**2):.1f} MB/s"
+        return f"{bytes_per_sec / 1024:.0f} KB/s"
+
     def update_gpu_data(self, gpu_data):
         """Update GPU data from backend"""
         self.gpu_data = gpu_data
@@ -758,19 +1020,29 @@ class PerformanceView(tk.Frame):
             return
 
         self.gpu_history.append(gpu_util)
-        self.gpu_graph.add_value(gpu_util)
 
         self.gpu_btn.set_value(gpu_util)
         self.gpu_btn.add_data_point(gpu_util)
         self.gpu_btn.set_secondary_text(f"{gpu_mem_used} / {gpu_mem_total} MB")
 
+        if self._drawn_panel == 'gpu':
+            self.gpu_graph.add_value(gpu_util)
+            self._render_gpu(gpu)
+
+    def _render_gpu(self, gpu):
+        try:
+            gpu_index = int(gpu[0])
+            gpu_name = gpu[1]
+            gpu_util = int(gpu[2])
+            gpu_mem_used = int(gpu[3])
+            gpu_mem_total = int(gpu[4])
+            gpu_temp = int(gpu[5])
+        except (ValueError, IndexError):
+            return
+
         self.gpu_title_label.configure(text=f"GPU {gpu_index}")
         self.gpu_model_label.configure(text=gpu_name)
-
-        if hasattr(self, 'gpu_usage_label'):
-            self.gpu_usage_label.configure(text=f"{gpu_util}%")
-        if hasattr(self, 'gpu_vram_label'):
-            mem_pct = (gpu_mem_used / gpu_mem_total * 100) if gpu_mem_total > 0 else 0
-            self.gpu_vram_label.configure(text=f"{gpu_mem_used/1024:.1f}/{gpu_mem_total/1024:.0f} GiB ({mem_pct:.0f}%)")
-        if hasattr(self, 'gpu_temp_label'):
-            self.gpu_temp_label.configure(text=f"{gpu_temp}°C")
+        self.gpu_usage_label.configure(text=f"{gpu_util}%")
+        mem_pct = (gpu_mem_used / gpu_mem_total * 100) if gpu_mem_total > 0 else 0
+        self.gpu_vram_label.configure(text=f"{gpu_mem_used/1024:.1f}/{gpu_mem_total/1024:.0f} GiB ({mem_pct:.0f}%)")
+        self.gpu_temp_label.configure(text=f"{gpu_temp}°C")
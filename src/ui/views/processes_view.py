@@ -9,12 +9,23 @@ import psutil
 import os
 import signal
 import subprocess
-import time
 import re
 import threading
+import bisect
+from collections import namedtuple
 from ..themes import COLORS, Theme
-from ..utils import IconLoader
+from ..utils import IconLoader, KILL_EXITED, KILL_KILLED, KILL_FAILED, KILL_RUNNING
 
+# How often rows showing a placeholder check for icons the loader finished
+ICON_POLL_MS = 50
+
+# Disk and network rates arrive in bytes/s and are shown in MB/s
+MB = 1024 * 1024
+
+# End task sends SIGTERM; the backend sends SIGKILL to whatever is still running this much later
+END_TASK_TIMEOUT_MS = 2000
+# Force kill: how long the backend waits for the exits before reporting
+FORCE_KILL_TIMEOUT_MS = 1000
 
 # Process classification patterns
 APP_PATTERNS = [
@@ -54,6 +65,20 @@ PARENT_BLACKLIST = {
     'systemd', 'init',
 }
 
+# Name fragments of helper processes (e.g. crashpad in chrome_crashpad_handler)
+HELPER_PATTERNS = ['crashpad', 'helper', 'zygote', 'nacl_helper']
+
+
+def is_app_unit(cgroup):
+    """True for the systemd unit a desktop launcher starts an app in
+    (app-*.scope / app-*.service, snap.*.scope) under a user slice"""
+    if 'user.slice/' not in cgroup:
+        return False
+    leaf = cgroup.rsplit('/', 1)[-1]
+    if leaf.startswith('app-'):
+        return leaf.endswith(('.scope', '.service'))
+    return leaf.startswith('snap.') and leaf.endswith('.scope')
+
 
 def get_usage_color(value, max_val=100):
     """Get background color based on usage value (yellow/orange gradient)"""
@@ -79,6 +104,33 @@ def get_usage_color(value, max_val=100):
         return '#ab8b2a'
 
 
+def format_memory(mib):
+    """Memory in MiB for the Properties dialog"""
+    return f"{mib:.2f} MiB" if mib < 1024 else f"{mib/1024:.2f} GiB"
+
+
+def format_rate(mb_per_sec):
+    """Disk / network cell text for a rate in MB/s"""
+    if mb_per_sec < 0.05:
+        return "0 MB/s"
+    return f"{mb_per_sec:.1f} MB/s"
+
+
+def update_rate_cells(row, disk, net):
+    """Disk and network cells of a row, skipped while unchanged at display precision"""
+    disk_rounded = round(disk, 1)
+    if disk_rounded != row._prev_disk:
+        row._prev_disk = disk_rounded
+        row.disk = disk
+        row.disk_label.configure(text=format_rate(disk), bg=get_usage_color(disk, 100))
+
+    net_rounded = round(net, 1)
+    if net_rounded != row._prev_net:
+        row._prev_net = net_rounded
+        row.net = net
+        row.net_label.configure(text=format_rate(net), bg=get_usage_color(net, 10))
+
+
 # Cached fonts for performance (avoid repeated Theme.get_font calls)
 _FONT_SMALL = None
 _FONT_BODY = None
@@ -99,23 +151,34 @@ def _init_fonts():
 class SubProcessRow(tk.Frame):
     """Individual process row shown when parent is expanded"""
 
-    def __init__(self, parent, pid, name, cpu, mem, on_select=None, on_context=None, **kwargs):
+    # Fixed height: ProcessesView lays rows out from these, not from Tk geometry
+    ROW_HEIGHT = 34
+
+    def __init__(self, parent, on_select=None, on_context=None, **kwargs):
         super().__init__(parent, bg=COLORS['bg_primary'], cursor='hand2', **kwargs)
         _init_fonts()
 
-        self.pid = pid
-        self.pids = [pid]  # For compatibility with kill functions
-        self.name = name
-        self.cpu = cpu
-        self.mem = mem
+        # Rows are pooled: assign() points this widget at another process
+        self.line = None  # ('sub', group_key, pid)
+        self.pid = 0
+        self.pids = []  # For compatibility with kill functions
+        self.cpu = 0.0
+        self.mem = 0.0
+        self.disk = 0.0
+        self.net = 0.0
+        self.threads = 0
         self.selected = False
         self.on_select = on_select
         self.on_context = on_context
-        self.is_app = False  # Sub-processes shown as individual
+        self.canvas_item = None  # set by ProcessesView
+        self.offset = -1
 
         # Cache previous values to skip unnecessary updates
         self._prev_cpu = None
         self._prev_mem = None
+        self._prev_disk = None
+        self._prev_net = None
+        self._prev_threads = None
 
         # Inner frame with indentation
         self.inner = tk.Frame(self, bg=COLORS['bg_tertiary'], cursor='hand2')
@@ -136,7 +199,7 @@ class SubProcessRow(tk.Frame):
 
         # PID as name for sub-process
         self.name_label = tk.Label(
-            self.inner, text=f"PID {self.pid}",
+            self.inner, text="",
             font=_FONT_SMALL,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
             anchor='w'
@@ -145,41 +208,62 @@ class SubProcessRow(tk.Frame):
 
         # PID
         self.pid_label = tk.Label(
-            self.inner, text=str(self.pid),
+            self.inner, text="",
             font=_FONT_SMALL,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_tertiary'],
             width=8, anchor='e'
         )
         self.pid_label.pack(side=tk.RIGHT, padx=(8, 16), pady=8)
 
+        # Threads
+        self.threads_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_SMALL,
+            bg=COLORS['bg_tertiary'], fg=COLORS['text_tertiary'],
+            width=9, anchor='e'
+        )
+        self.threads_label.pack(side=tk.RIGHT, padx=(0, 8), pady=8)
+
+        # Network
+        self.net_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_SMALL,
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
+            width=10, anchor='e', padx=6, pady=8
+        )
+        self.net_label.pack(side=tk.RIGHT, padx=(0, 8))
+
+        # Disk
+        self.disk_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_SMALL,
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
+            width=10, anchor='e', padx=6, pady=8
+        )
+        self.disk_label.pack(side=tk.RIGHT, padx=(0, 8))
+
         # Memory
-        mem_mb = self.mem
-        if mem_mb >= 1024:
-            mem_text = f"{mem_mb/1024:.2f}GiB"
-        else:
-            mem_text = f"{mem_mb:.2f}MiB"
-        mem_color = get_usage_color(mem_mb, 4096)
         self.mem_label = tk.Label(
-            self.inner, text=mem_text,
+            self.inner, text="",
             font=_FONT_SMALL,
-            bg=mem_color, fg=COLORS['text_primary'],
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
             width=10, anchor='e', padx=6, pady=8
         )
         self.mem_label.pack(side=tk.RIGHT, padx=(0, 8))
 
         # CPU
-        cpu_color = get_usage_color(self.cpu, 10)
         self.cpu_label = tk.Label(
-            self.inner, text=f"{self.cpu:.2f}%",
+            self.inner, text="",
             font=_FONT_SMALL,
-            bg=cpu_color, fg=COLORS['text_primary'],
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
             width=8, anchor='e', padx=6, pady=8
         )
         self.cpu_label.pack(side=tk.RIGHT, padx=(0, 8))
 
     def _bind_events(self):
         """Bind mouse events"""
-        widgets = [self, self.inner, self.name_label, self.cpu_label, self.mem_label, self.pid_label]
+        widgets = [self, self.inner, self.name_label, self.cpu_label, self.mem_label,
+                   self.disk_label, self.net_label, self.threads_label, self.pid_label]
         for w in widgets:
             w.bind('<Enter>', self._on_enter)
             w.bind('<Leave>', self._on_leave)
@@ -207,6 +291,7 @@ class SubProcessRow(tk.Frame):
     def _set_bg(self, color):
         self.inner.configure(bg=color)
         self.name_label.configure(bg=color)
+        self.threads_label.configure(bg=color)
         self.pid_label.configure(bg=color)
 
     def set_selected(self, selected):
@@ -216,12 +301,35 @@ class SubProcessRow(tk.Frame):
         else:
             self._set_bg(COLORS['bg_tertiary'])
 
-    def update_data(self, cpu, mem):
+    def assign(self, line, details, selected):
+        """Show another process in this (recycled) row"""
+        self.line = line
+        self.pid = line[2]
+        self.pids = [self.pid]
+        self.name_label.configure(text=f"PID {self.pid}")
+        self.pid_label.configure(text=str(self.pid))
+
+        self._prev_cpu = None
+        self._prev_mem = None
+        self._prev_disk = None
+        self._prev_net = None
+        self._prev_threads = None
+        self.update_data(details['cpu'], details['mem'], details['disk'], details['net'], details['threads'])
+        self.set_selected(selected)
+
+    def update_data(self, cpu, mem, disk, net, threads):
         """Update process data (skip if unchanged)"""
         # Round to avoid unnecessary updates from tiny changes
         cpu_rounded = round(cpu, 1)
         mem_rounded = round(mem, 1)
 
+        if threads != self._prev_threads:
+            self._prev_threads = threads
+            self.threads = threads
+            self.threads_label.configure(text=str(threads))
+
+        update_rate_cells(self, disk, net)
+
         # Skip update if values haven't changed significantly
         if cpu_rounded == self._prev_cpu and mem_rounded == self._prev_mem:
             return
@@ -248,46 +356,50 @@ class ProcessRow(tk.Frame):
     # Row height to show ~10 processes in view
     ROW_HEIGHT = 48
 
-    def __init__(self, parent, name, pids, cpu, mem, state, is_app=False,
-                 on_select=None, on_context=None, process_details=None, icon=None, **kwargs):
+    def __init__(self, parent, on_select=None, on_context=None, on_toggle=None, **kwargs):
         super().__init__(parent, bg=COLORS['bg_primary'], cursor='hand2', **kwargs)
         _init_fonts()
 
-        self.name = name
-        self.pids = pids
-        self.cpu = cpu
-        self.mem = mem
-        self.state = state
-        self.is_app = is_app
+        # Rows are pooled: assign() points this widget at another group
+        self.line = None  # ('group', group key)
+        self.name = ''
+        self.pids = []
+        self.cpu = 0.0
+        self.mem = 0.0
+        self.disk = 0.0
+        self.net = 0.0
+        self.threads = 0
+        self.state = ''
+        self.is_app = False
         self.selected = False
         self.on_select = on_select
         self.on_context = on_context
+        self.on_toggle = on_toggle
         self.expanded = False
-        self.process_details = process_details or {}  # {pid: {'cpu': x, 'mem': y}}
-        self.sub_rows = {}
-        self.icon = icon  # PhotoImage for app icon
+        self.icon = None  # PhotoImage for app icon
+        self.canvas_item = None  # set by ProcessesView
+        self.offset = -1
 
         # Cache previous values to skip unnecessary updates
         self._prev_cpu = None
         self._prev_mem = None
+        self._prev_disk = None
+        self._prev_net = None
+        self._prev_threads = None
         self._prev_pids_count = None
 
         # Inner frame for actual content with padding
         self.inner = tk.Frame(self, bg=COLORS['surface'], cursor='hand2')
         self.inner.pack(fill=tk.X, pady=(0, 2))  # Small gap between rows
 
-        # Container for sub-process rows (initially hidden)
-        self.sub_container = tk.Frame(self, bg=COLORS['bg_primary'])
-
         self._create_widgets()
         self._bind_events()
 
     def _create_widgets(self):
         """Create row widgets"""
         # Expand arrow (for processes with children)
-        arrow = "▶" if len(self.pids) > 1 else " "
         self.arrow_label = tk.Label(
-            self.inner, text=arrow,
+            self.inner, text=" ",
             font=_FONT_SMALL,
             bg=COLORS['surface'], fg=COLORS['text_tertiary'],
             width=2
@@ -295,26 +407,19 @@ class ProcessRow(tk.Frame):
         self.arrow_label.pack(side=tk.LEFT, padx=(8, 0), pady=12)
 
         # Process count badge (shows number of processes if > 1)
-        count_text = f"({len(self.pids)})" if len(self.pids) > 1 else ""
         self.count_label = tk.Label(
-            self.inner, text=count_text,
+            self.inner, text="",
             font=_FONT_TINY,
             bg=COLORS['surface'], fg=COLORS['text_tertiary']
         )
         self.count_label.pack(side=tk.LEFT, padx=(0, 4), pady=12)
 
-        # Icon for apps
-        self.icon_label = None
-        if self.icon and self.is_app:
-            self.icon_label = tk.Label(
-                self.inner, image=self.icon,
-                bg=COLORS['surface']
-            )
-            self.icon_label.pack(side=tk.LEFT, padx=(0, 6), pady=8)
+        # Icon for apps (packed by assign() only when there is one)
+        self.icon_label = tk.Label(self.inner, bg=COLORS['surface'])
 
         # Name - expands to fill available space
         self.name_label = tk.Label(
-            self.inner, text=self.name,
+            self.inner, text="",
             font=_FONT_BODY,
             bg=COLORS['surface'], fg=COLORS['text_primary'],
             anchor='w'
@@ -322,36 +427,55 @@ class ProcessRow(tk.Frame):
         self.name_label.pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(0, 8), pady=12)
 
         # PID (on the right)
-        pid_text = str(self.pids[0]) if len(self.pids) == 1 else f"{len(self.pids)} PIDs"
         self.pid_label = tk.Label(
-            self.inner, text=pid_text,
+            self.inner, text="",
             font=_FONT_BODY,
             bg=COLORS['surface'], fg=COLORS['text_secondary'],
             width=8, anchor='e'
         )
         self.pid_label.pack(side=tk.RIGHT, padx=(8, 16), pady=12)
 
+        # Threads (summed over the group)
+        self.threads_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_BODY,
+            bg=COLORS['surface'], fg=COLORS['text_secondary'],
+            width=9, anchor='e'
+        )
+        self.threads_label.pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+
+        # Network cell with colored background (pack from right)
+        self.net_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_BODY,
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
+            width=10, anchor='e', padx=8, pady=12
+        )
+        self.net_label.pack(side=tk.RIGHT, padx=(0, 8))
+
+        # Disk cell with colored background (pack from right)
+        self.disk_label = tk.Label(
+            self.inner, text="",
+            font=_FONT_BODY,
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
+            width=10, anchor='e', padx=8, pady=12
+        )
+        self.disk_label.pack(side=tk.RIGHT, padx=(0, 8))
+
         # Memory cell with colored background (pack from right)
-        mem_mb = self.mem
-        if mem_mb >= 1024:
-            mem_text = f"{mem_mb/1024:.2f}GiB"
-        else:
-            mem_text = f"{mem_mb:.2f}MiB"
-        mem_color = get_usage_color(mem_mb, 4096)  # 4GB is high
         self.mem_label = tk.Label(
-            self.inner, text=mem_text,
+            self.inner, text="",
             font=_FONT_BODY,
-            bg=mem_color, fg=COLORS['text_primary'],
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
             width=10, anchor='e', padx=8, pady=12
         )
         self.mem_label.pack(side=tk.RIGHT, padx=(0, 8))
 
         # CPU cell with colored background (pack from right)
-        cpu_color = get_usage_color(self.cpu, 10)  # 10% is high for single process
         self.cpu_label = tk.Label(
-            self.inner, text=f"{self.cpu:.2f}%",
+            self.inner, text="",
             font=_FONT_BODY,
-            bg=cpu_color, fg=COLORS['text_primary'],
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
             width=8, anchor='e', padx=8, pady=12
         )
         self.cpu_label.pack(side=tk.RIGHT, padx=(0, 8))
@@ -363,10 +487,8 @@ class ProcessRow(tk.Frame):
         self.arrow_label.configure(cursor='hand2')
 
         # Other widgets for selection
-        widgets = [self.inner, self.name_label, self.count_label,
-                   self.cpu_label, self.mem_label, self.pid_label]
-        if self.icon_label:
-            widgets.append(self.icon_label)
+        widgets = [self.inner, self.name_label, self.count_label, self.cpu_label, self.mem_label,
+                   self.disk_label, self.net_label, self.threads_label, self.pid_label, self.icon_label]
         for w in widgets:
             w.bind('<Enter>', self._on_enter)
             w.bind('<Leave>', self._on_leave)
@@ -379,38 +501,20 @@ class ProcessRow(tk.Frame):
 
     def _on_arrow_click(self, event):
         """Handle arrow click for expand/collapse"""
-        if len(self.pids) > 1:
-            self._toggle_expand()
+        if len(self.pids) > 1 and self.on_toggle:
+            self.on_toggle(self)
         return "break"  # Prevent event propagation
 
-    def _toggle_expand(self):
-        """Toggle expanded state"""
-        self.expanded = not self.expanded
-        if self.expanded:
-            self.arrow_label.configure(text="▼")
-            self._show_sub_processes()
+    def set_expanded(self, expanded):
+        """Show the expand/collapse state; the sub-rows themselves belong to ProcessesView"""
+        self.expanded = expanded
+        self._update_arrow()
+
+    def _update_arrow(self):
+        if len(self.pids) > 1:
+            self.arrow_label.configure(text="▼" if self.expanded else "▶")
         else:
-            self.arrow_label.configure(text="▶")
-            self._hide_sub_processes()
-
-    def _show_sub_processes(self):
-        """Show individual process rows"""
-        self.sub_container.pack(fill=tk.X, after=self.inner)
-
-        for pid in self.pids:
-            if pid not in self.sub_rows:
-                details = self.process_details.get(pid, {'cpu': 0, 'mem': 0})
-                sub_row = SubProcessRow(
-                    self.sub_container, pid, self.name,
-                    details.get('cpu', 0), details.get('mem', 0),
-                    on_select=self.on_select, on_context=self.on_context
-                )
-                sub_row.pack(fill=tk.X)
-                self.sub_rows[pid] = sub_row
-
-    def _hide_sub_processes(self):
-        """Hide individual process rows"""
-        self.sub_container.pack_forget()
+            self.arrow_label.configure(text=" ")
 
     def _on_enter(self, event):
         if not self.selected:
@@ -436,9 +540,9 @@ class ProcessRow(tk.Frame):
         self.arrow_label.configure(bg=color)
         self.count_label.configure(bg=color)
         self.name_label.configure(bg=color)
+        self.threads_label.configure(bg=color)
         self.pid_label.configure(bg=color)
-        if self.icon_label:
-            self.icon_label.configure(bg=color)
+        self.icon_label.configure(bg=color)
 
     def set_selected(self, selected):
         self.selected = selected
@@ -447,8 +551,46 @@ class ProcessRow(tk.Frame):
         else:
             self._set_bg(COLORS['surface'])
 
-    def update_data(self, cpu, mem, state, pids, process_details=None):
-        """Update process data (skip unchanged values)"""
+    def assign(self, line, info, icon, expanded, selected):
+        """Show another process group in this (recycled) row"""
+        self.line = line
+        self._show(info['name'], line[1][0] == 'app', info, icon, expanded, selected)
+
+    def _show(self, name, is_app, info, icon, expanded, selected):
+        """Fill every cell afresh: the cached values belong to the row's previous line"""
+        self.name = name
+        self.is_app = is_app
+        self.name_label.configure(text=name)
+
+        self.set_icon(icon)
+
+        self.expanded = expanded
+        self._prev_cpu = None
+        self._prev_mem = None
+        self._prev_disk = None
+        self._prev_net = None
+        self._prev_threads = None
+        self._prev_pids_count = None
+        self.update_data(info)
+        self.set_selected(selected)
+
+    def set_icon(self, icon):
+        """Show icon (apps only), or hide the icon label for None"""
+        if not (icon and self.is_app):
+            icon = None
+        if icon is not self.icon:
+            self.icon = icon
+            if icon:
+                self.icon_label.configure(image=icon)
+                if not self.icon_label.winfo_manager():
+                    self.icon_label.pack(side=tk.LEFT, padx=(0, 6), pady=8, before=self.name_label)
+            else:
+                self.icon_label.pack_forget()
+                self.icon_label.configure(image='')
+
+    def update_data(self, info):
+        """Update process data from the group's totals (skip unchanged values)"""
+        cpu, mem, state, pids, threads = info['cpu'], info['mem'], info['state'], info['pids'], info['threads']
         # Round to avoid unnecessary updates from tiny changes
         cpu_rounded = round(cpu, 1)
         mem_rounded = round(mem, 1)
@@ -456,8 +598,6 @@ class ProcessRow(tk.Frame):
 
         self.state = state
         self.pids = pids
-        if process_details:
-            self.process_details = process_details
 
         # Only update CPU if changed
         if cpu_rounded != self._prev_cpu:
@@ -477,45 +617,63 @@ class ProcessRow(tk.Frame):
             mem_color = get_usage_color(mem, 4096)
             self.mem_label.configure(text=mem_text, bg=mem_color)
 
+        update_rate_cells(self, info['disk'], info['net'])
+
+        if threads != self._prev_threads:
+            self._prev_threads = threads
+            self.threads = threads
+            self.threads_label.configure(text=str(threads))
+
         # Only update PID count if changed
         if pids_count != self._prev_pids_count:
             self._prev_pids_count = pids_count
             if pids_count > 1:
-                arrow = "▼" if self.expanded else "▶"
                 self.count_label.configure(text=f"({pids_count})")
                 self.pid_label.configure(text=f"{pids_count} PIDs")
             else:
-                arrow = " "
                 self.count_label.configure(text="")
                 self.pid_label.configure(text=str(pids[0]))
-            self.arrow_label.configure(text=arrow)
-
-        # Update sub-rows if expanded
-        if self.expanded and process_details:
-            # Remove sub-rows for processes that no longer exist
-            for pid in list(self.sub_rows.keys()):
-                if pid not in pids:
-                    self.sub_rows[pid].destroy()
-                    del self.sub_rows[pid]
-
-            # Add/update sub-rows
-            for pid in pids:
-                details = process_details.get(pid, {'cpu': 0, 'mem': 0})
-                if pid in self.sub_rows:
-                    self.sub_rows[pid].update_data(details.get('cpu', 0), details.get('mem', 0))
-                else:
-                    sub_row = SubProcessRow(
-                        self.sub_container, pid, self.name,
-                        details.get('cpu', 0), details.get('mem', 0),
-                        on_select=self.on_select, on_context=self.on_context
-                    )
-                    sub_row.pack(fill=tk.X)
-                    self.sub_rows[pid] = sub_row
+            self._update_arrow()
+
+
+class TreeRow(ProcessRow):
+    """Process tree node: one PID with the totals of its whole subtree, indented under its parent"""
+
+    INDENT = 20
+
+    def __init__(self, parent, **kwargs):
+        super().__init__(parent, **kwargs)
+        self.line = None  # ('node', pid)
+        self.depth = 0
+        self.has_children = False
+
+    def _on_arrow_click(self, event):
+        if self.has_children and self.on_toggle:
+            self.on_toggle(self)
+        return "break"
+
+    def _update_arrow(self):
+        if self.has_children:
+            self.arrow_label.configure(text="▼" if self.expanded else "▶")
+        else:
+            self.arrow_label.configure(text=" ")
+
+    def assign_node(self, line, name, info, depth, has_children, expanded, selected):
+        """Show another tree node in this (recycled) row"""
+        self.line = line
+        if depth != self.depth:
+            self.depth = depth
+            self.arrow_label.pack_configure(padx=(8 + depth * self.INDENT, 0))
+        self.has_children = has_children
+        self._show(name, False, info, None, expanded, selected)
+        self._update_arrow()
 
 
 class SectionHeader(tk.Frame):
     """Section header (Apps, Background, etc.)"""
 
+    HEIGHT = 44
+
     def __init__(self, parent, title, count=0, expanded=True, on_toggle=None,
                  bg_color=None, **kwargs):
         super().__init__(parent, bg=bg_color or COLORS['accent'], **kwargs)
@@ -555,25 +713,71 @@ class SectionHeader(tk.Frame):
         self.count = count
 
 
+# What End task / Properties act on. Built from the model rather than read off
+# a row widget, since widgets are recycled as the list scrolls.
+SelectedProcess = namedtuple('SelectedProcess', 'is_sub name pids cpu mem rss uss disk net is_app')
+
+
 class ProcessesView(tk.Frame):
     """Clean process list view"""
 
     def __init__(self, parent, **kwargs):
         super().__init__(parent, bg=COLORS['bg_primary'], **kwargs)
 
-        self.process_data = []
-        self.process_groups = {}
+        # Persistent process state, updated incrementally by apply_delta()
+        self.processes = {}   # pid -> (pid, name, state, cpu, mem_kb, threads, uid, ppid, session, cgroup,
+                              #         disk_read, disk_written, net_received, net_sent, pss_kb, uss_kb,
+                              #         start_time_ms, subtree_mem_kb, subtree_cpu, subtree_disk, subtree_net)
+        # Group key: (section, cgroup) for an app unit, else (section, name)
+        self.groups = {}      # key -> {'name', 'pids', 'cpu', 'mem', 'disk', 'net', 'threads', 'state', 'details'}
+        self._proc_group = {}  # pid -> group key
+        self._section_counts = {'app': 0, 'bg': 0}
+        self.gpu_memory = {}  # pid -> GPU memory in MB (NVML only)
         self.window_pids = set()
-        self.classification_cache = {}
-        self.selected_row = None
-        self.rows = {}
+        self.window_tracking = False  # window_pids come from the backend's WINDOW_PIDS frames
+        self._classified_window_pids = self.window_pids
+        self._uid = os.getuid()
+        self._units = {}  # app unit cgroup -> pids in it; one group per unit
+        self._unit_names = {}  # app unit cgroup -> its group's name, see _unit_name()
+        self._app_units = {}  # cgroup -> is_app_unit(cgroup)
+        self.selected = None  # line of the selected row (see _rebuild_lines)
         self.apps_expanded = True
         self.bg_expanded = True
-        self._cache_cleanup_counter = 0
+
+        # Virtualized list: the model is flattened into lines with fixed heights
+        # and only lines inside the viewport get a (pooled) row widget
+        self._section_keys = {'app': [], 'bg': []}  # (sort value, name, key) entries, kept sorted
+        self._sort_entries = {}  # group key -> its entry in _section_keys
+        self._listed = {}  # group key -> pids when its lines were last built
+        self._expanded_groups = set()
+        self._lines = []  # ('header', section) | ('group', key) | ('sub', key, pid) | ('node', pid)
+        self._line_y = []  # top offset of each line, ascending
+        self._total_height = 0
+        self._visible = {}  # line -> row widget showing it
+        self._pool = {'group': [], 'sub': [], 'node': []}  # hidden widgets ready for reuse
+        self._all_rows = []
+        self._width = 1
+        self._refresh_pending = False
+
+        # Tree mode: the ppid hierarchy in place of the sections. A parent is only
+        # believed if it is not younger than the child (else the PID was reused).
+        self.tree_mode = False
+        self._claimed = {}  # ppid -> pids whose record names it as their parent
+        self._tree_order = {}  # pid (0 = the roots) -> children in sort order, built on demand
+        self._tree_depth = {}  # pid -> indent level in the current lines
+        self._collapsed = set()  # tree nodes whose children are hidden
+
+        # Sort order: click-to-sort headers; numeric columns start descending
+        self.sort_column = 'cpu'
+        self.sort_reverse = True
+        self._sort_labels = {}  # column -> header label
         self._window_pid_thread_running = False  # Prevent thread accumulation
+        self.kill_backend = None  # MainWindow.send_kill, when the backend takes commands
+        self._kill_requests = {}  # request id -> (SelectedProcess, signal) awaiting kill_finished()
 
-        # Icon loader for app icons
+        # Icon loader for app icons; loads on a worker, rows show a placeholder meanwhile
         self.icon_loader = IconLoader(size=20)
+        self._icon_poll_pending = False
 
         self._create_ui()
 
@@ -590,54 +794,86 @@ class ProcessesView(tk.Frame):
                 bg=COLORS['bg_tertiary']).pack(side=tk.LEFT, padx=(8, 0))
 
         # Name header - expands to fill space
-        tk.Label(
+        self._sort_labels['name'] = tk.Label(
             header_frame, text="Name",
             font=_FONT_BODY_BOLD,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
             anchor='w'
-        ).pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(4, 8), pady=12)
+        )
+        self._sort_labels['name'].pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(4, 8), pady=12)
 
         # PID header (on right side) - matches data column padding
-        tk.Label(
+        self._sort_labels['pid'] = tk.Label(
             header_frame, text="PID", width=8,
             font=_FONT_BODY_BOLD,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
             anchor='e'
-        ).pack(side=tk.RIGHT, padx=(8, 16), pady=12)
+        )
+        self._sort_labels['pid'].pack(side=tk.RIGHT, padx=(8, 16), pady=12)
+
+        # Threads header (pack from right) - matches data column padding
+        self._sort_labels['threads'] = tk.Label(
+            header_frame, text="Threads", width=9,
+            font=_FONT_BODY_BOLD,
+            bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
+            anchor='e'
+        )
+        self._sort_labels['threads'].pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+
+        # Network and Disk headers (pack from right) - match data columns with internal padx
+        self._sort_labels['net'] = tk.Label(
+            header_frame, text="Network", width=10,
+            font=_FONT_BODY_BOLD,
+            bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
+            anchor='e', padx=8
+        )
+        self._sort_labels['net'].pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+
+        self._sort_labels['disk'] = tk.Label(
+            header_frame, text="Disk", width=10,
+            font=_FONT_BODY_BOLD,
+            bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
+            anchor='e', padx=8
+        )
+        self._sort_labels['disk'].pack(side=tk.RIGHT, padx=(0, 8), pady=12)
 
         # RAM header (pack from right) - matches data column with internal padx
-        tk.Label(
+        self._sort_labels['mem'] = tk.Label(
             header_frame, text="RAM", width=10,
             font=_FONT_BODY_BOLD,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
             anchor='e', padx=8
-        ).pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+        )
+        self._sort_labels['mem'].pack(side=tk.RIGHT, padx=(0, 8), pady=12)
 
         # CPU header (pack from right) - matches data column with internal padx
-        tk.Label(
+        self._sort_labels['cpu'] = tk.Label(
             header_frame, text="CPU", width=8,
             font=_FONT_BODY_BOLD,
             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'],
             anchor='e', padx=8
-        ).pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+        )
+        self._sort_labels['cpu'].pack(side=tk.RIGHT, padx=(0, 8), pady=12)
+
+        # Click a header to sort by it, again to reverse
+        for column, label in self._sort_labels.items():
+            label.configure(cursor='hand2')
+            label.bind('<Button-1>', lambda e, c=column: self.set_sort(c))
+        self._update_sort_labels()
 
         # Scrollable content area with right padding
         container = tk.Frame(self, bg=COLORS['bg_primary'])
         container.pack(fill=tk.BOTH, expand=True, padx=(0, Theme.PADDING_MEDIUM))
 
-        # Canvas for scrolling
+        # Canvas for scrolling; rows are canvas windows placed at their line offsets
         self.canvas = tk.Canvas(container, bg=COLORS['bg_primary'], highlightthickness=0)
-        scrollbar = ttk.Scrollbar(container, orient=tk.VERTICAL, command=self.canvas.yview)
-
-        self.scroll_frame = tk.Frame(self.canvas, bg=COLORS['bg_primary'])
-        self.canvas_window = self.canvas.create_window((0, 0), window=self.scroll_frame, anchor='nw')
+        self.scrollbar = ttk.Scrollbar(container, orient=tk.VERTICAL, command=self.canvas.yview)
 
-        self.scroll_frame.bind('<Configure>', lambda e: self.canvas.configure(scrollregion=self.canvas.bbox('all')))
-        self.canvas.bind('<Configure>', lambda e: self.canvas.itemconfig(self.canvas_window, width=e.width))
+        self.canvas.bind('<Configure>', self._on_canvas_configure)
 
-        self.canvas.configure(yscrollcommand=scrollbar.set)
+        self.canvas.configure(yscrollcommand=self._on_yscroll)
         self.canvas.pack(side=tk.LEFT, fill=tk.BOTH, expand=True)
-        scrollbar.pack(side=tk.RIGHT, fill=tk.Y)
+        self.scrollbar.pack(side=tk.RIGHT, fill=tk.Y)
 
         # Mouse wheel scrolling - scroll by 3 units for smoother feel with bigger rows
         self.canvas.bind_all('<Button-4>', lambda e: self.canvas.yview_scroll(-3, 'units'))
@@ -645,25 +881,23 @@ class ProcessesView(tk.Frame):
 
         # Apps section
         self.apps_header = SectionHeader(
-            self.scroll_frame, "Apps", 0, True,
-            on_toggle=lambda exp: self._toggle_section('apps', exp),
+            self.canvas, "Apps", 0, True,
+            on_toggle=lambda exp: self._toggle_section('app', exp),
             bg_color='#2a6a6a'
         )
-        self.apps_header.pack(fill=tk.X)
-
-        self.apps_container = tk.Frame(self.scroll_frame, bg=COLORS['bg_primary'])
-        self.apps_container.pack(fill=tk.X)
 
         # Background processes section (same color as Apps)
         self.bg_header = SectionHeader(
-            self.scroll_frame, "Background", 0, True,
+            self.canvas, "Background", 0, True,
             on_toggle=lambda exp: self._toggle_section('bg', exp),
             bg_color='#2a6a6a'
         )
-        self.bg_header.pack(fill=tk.X)
 
-        self.bg_container = tk.Frame(self.scroll_frame, bg=COLORS['bg_primary'])
-        self.bg_container.pack(fill=tk.X)
+        self._header_items = {
+            section: self.canvas.create_window(0, 0, window=header, anchor='nw',
+                                               height=SectionHeader.HEIGHT)
+            for section, header in (('app', self.apps_header), ('bg', self.bg_header))
+        }
 
         # Bottom toolbar with End task button
         bottom_bar = tk.Frame(self, bg=COLORS['bg_secondary'])
@@ -688,25 +922,235 @@ class ProcessesView(tk.Frame):
         )
         self.end_btn.pack(side=tk.RIGHT, padx=16, pady=8)
 
+        # Switch between app/background groups and the process tree
+        self.tree_btn = tk.Button(
+            bottom_bar, text="Tree view",
+            font=_FONT_BODY,
+            bg=COLORS['surface'], fg=COLORS['text_primary'],
+            activebackground=COLORS['surface_hover'], activeforeground=COLORS['text_primary'],
+            relief=tk.FLAT, padx=16, pady=8, cursor='hand2',
+            command=self._toggle_tree_mode
+        )
+        self.tree_btn.pack(side=tk.RIGHT, pady=8)
+
+        self._rebuild_lines()
+
     def _toggle_section(self, section, expanded):
         """Toggle section visibility"""
-        if section == 'apps':
+        if section == 'app':
             self.apps_expanded = expanded
-            if expanded:
-                self.apps_container.pack(fill=tk.X, after=self.apps_header)
-            else:
-                self.apps_container.pack_forget()
         else:
             self.bg_expanded = expanded
-            if expanded:
-                self.bg_container.pack(fill=tk.X, after=self.bg_header)
-            else:
-                self.bg_container.pack_forget()
+        self._rebuild_lines()
+
+    def _toggle_group(self, row):
+        """Expand or collapse a group's per-process lines"""
+        key = row.line[1]
+        expanded = key not in self._expanded_groups
+        if expanded:
+            self._expanded_groups.add(key)
+        else:
+            self._expanded_groups.discard(key)
+        row.set_expanded(expanded)
+        self._rebuild_lines()
+
+    def _toggle_node(self, row):
+        """Expand or collapse a tree node's children"""
+        pid = row.line[1]
+        if pid in self._collapsed:
+            self._collapsed.discard(pid)
+        else:
+            self._collapsed.add(pid)
+        row.set_expanded(pid not in self._collapsed)
+        self._rebuild_lines()
+
+    def _toggle_tree_mode(self):
+        """Show the process tree instead of the sections, or back"""
+        self.tree_mode = not self.tree_mode
+        self.tree_btn.configure(text="Group view" if self.tree_mode else "Tree view")
+        for item in self._header_items.values():
+            self.canvas.itemconfigure(item, state='hidden' if self.tree_mode else 'normal')
+        self._clear_selection()
+        self._rebuild_lines()
+        self.canvas.yview_moveto(0)
+
+    def _rebuild_lines(self):
+        """Flatten sections, groups and expanded sub-processes into line offsets"""
+        if self.tree_mode:
+            self._rebuild_tree_lines()
+            return
+
+        lines = []
+        line_y = []
+        y = 0
+        for section, expanded in (('app', self.apps_expanded), ('bg', self.bg_expanded)):
+            self.canvas.coords(self._header_items[section], 0, y)
+            lines.append(('header', section))
+            line_y.append(y)
+            y += SectionHeader.HEIGHT
+            if not expanded:
+                continue
+            entries = self._section_keys[section]
+            for _value, _name, key in (reversed(entries) if self.sort_reverse else entries):
+                lines.append(('group', key))
+                line_y.append(y)
+                y += ProcessRow.ROW_HEIGHT
+                if key in self._expanded_groups:
+                    for pid in sorted(self.groups[key]['pids']):
+                        lines.append(('sub', key, pid))
+                        line_y.append(y)
+                        y += SubProcessRow.ROW_HEIGHT
+        self._set_lines(lines, line_y, y)
+
+    def _rebuild_tree_lines(self):
+        """Flatten the process tree depth first, skipping the children of collapsed nodes"""
+        lines = []
+        line_y = []
+        depths = {}
+        y = 0
+        stack = [(pid, 0) for pid in reversed(self._tree_children(0))]
+        while stack:
+            pid, depth = stack.pop()
+            lines.append(('node', pid))
+            line_y.append(y)
+            y += ProcessRow.ROW_HEIGHT
+            depths[pid] = depth
+            if pid not in self._collapsed:
+                stack.extend((child, depth + 1) for child in reversed(self._tree_children(pid)))
+        self._tree_depth = depths
+
+        # Nodes still on screen may have moved to another depth or lost their last child
+        for line, row in self._visible.items():
+            pid = line[1]
+            if line[0] == 'node' and pid in depths and (
+                    row.depth != depths[pid] or row.has_children != bool(self._tree_children(pid))):
+                self._assign_row(row, line)
+        self._set_lines(lines, line_y, y)
+
+    def _set_lines(self, lines, line_y, height):
+        self._lines = lines
+        self._line_y = line_y
+        self._total_height = height
+        self.canvas.configure(scrollregion=(0, 0, self._width, height))
+        self._refresh_viewport()
+
+    def _on_canvas_configure(self, event):
+        """Stretch rows to the new width and fill a taller viewport"""
+        self._width = event.width
+        for item in self._header_items.values():
+            self.canvas.itemconfigure(item, width=event.width)
+        for row in self._all_rows:
+            self.canvas.itemconfigure(row.canvas_item, width=event.width)
+        self.canvas.configure(scrollregion=(0, 0, self._width, self._total_height))
+        self._refresh_viewport()
+
+    def _on_yscroll(self, first, last):
+        """Scrollbar feedback from the canvas: the viewport moved"""
+        self.scrollbar.set(first, last)
+        if not self._refresh_pending:
+            self._refresh_pending = True
+            self.after_idle(self._refresh_viewport)
+
+    def _refresh_viewport(self):
+        """Give the lines inside the viewport a row widget and recycle the rest"""
+        self._refresh_pending = False
+        top = self.canvas.canvasy(0)
+        bottom = top + self.canvas.winfo_height()
+        first = max(0, bisect.bisect_right(self._line_y, top) - 1)
+        last = bisect.bisect_left(self._line_y, bottom)
+
+        wanted = {}
+        for i in range(first, last):
+            line = self._lines[i]
+            if line[0] != 'header':
+                wanted[line] = self._line_y[i]
+
+        for line in [line for line in self._visible if line not in wanted]:
+            row = self._visible.pop(line)
+            self.canvas.itemconfigure(row.canvas_item, state='hidden')
+            self._pool[line[0]].append(row)
+
+        for line, y in wanted.items():
+            row = self._visible.get(line)
+            if row is None:
+                row = self._acquire_row(line[0])
+                self._assign_row(row, line)
+                self._visible[line] = row
+                self.canvas.itemconfigure(row.canvas_item, state='normal')
+            if row.offset != y:
+                row.offset = y
+                self.canvas.coords(row.canvas_item, 0, y)
+
+    def _acquire_row(self, kind):
+        """Take a hidden row widget from the pool, creating one only when it is empty"""
+        pool = self._pool[kind]
+        if pool:
+            return pool.pop()
+
+        if kind == 'group':
+            row = ProcessRow(self.canvas, on_select=self._on_row_select,
+                             on_context=self._show_context_menu, on_toggle=self._toggle_group)
+            height = ProcessRow.ROW_HEIGHT
+        elif kind == 'node':
+            row = TreeRow(self.canvas, on_select=self._on_row_select,
+                          on_context=self._show_context_menu, on_toggle=self._toggle_node)
+            height = ProcessRow.ROW_HEIGHT
+        else:
+            row = SubProcessRow(self.canvas, on_select=self._on_row_select,
+                                on_context=self._show_context_menu)
+            height = SubProcessRow.ROW_HEIGHT
+        row.canvas_item = self.canvas.create_window(0, 0, window=row, anchor='nw',
+                                                    width=self._width, height=height)
+        self._all_rows.append(row)
+        return row
+
+    def _assign_row(self, row, line):
+        """Point a row widget at a line of the model"""
+        if line[0] == 'node':
+            pid = line[1]
+            row.assign_node(line, self.processes[pid][1], self._tree_info(self.processes[pid]),
+                            self._tree_depth.get(pid, 0), bool(self._tree_children(pid)),
+                            pid not in self._collapsed, line == self.selected)
+            return
+
+        key = line[1]
+        group = self.groups[key]
+        selected = line == self.selected
+        if line[0] == 'group':
+            icon = None
+            if key[0] == 'app':
+                icon = self.icon_loader.get_icon(group['name'])
+                if self.icon_loader.pending and not self._icon_poll_pending:
+                    self._icon_poll_pending = True
+                    self.after(ICON_POLL_MS, self._poll_icons)
+            row.assign(line, group, icon, key in self._expanded_groups, selected)
+        else:
+            row.assign(line, group['details'][line[2]], selected)
+
+    def _poll_icons(self):
+        """Swap placeholders for icons the loader finished; poll again while any are pending"""
+        ready = self.icon_loader.take_ready()
+        if ready:
+            for line, row in self._visible.items():
+                group = self.groups.get(line[1]) if line[0] == 'group' and line[1][0] == 'app' else None
+                if group is not None and group['name'].lower() in ready:
+                    row.set_icon(self.icon_loader.get_icon(group['name']))
+
+        if self.icon_loader.pending:
+            self.after(ICON_POLL_MS, self._poll_icons)
+        else:
+            self._icon_poll_pending = False
+
+    def set_window_pids(self, pids):
+        """Window PIDs pushed by the backend whenever the window list changes; reclassify right away"""
+        self.window_tracking = True
+        self.window_pids = set(pids)
+        self.apply_delta([], [])
 
     def update_window_pids(self):
-        """Update the set of PIDs that have windows (runs in background)"""
+        """Poll the set of PIDs that have windows (runs in background) when the backend cannot track them"""
         # Prevent spawning multiple threads if previous one is still running
-        if self._window_pid_thread_running:
+        if self._window_pid_thread_running or self.window_tracking:
             return
 
         def _fetch_pids():
@@ -728,7 +1172,8 @@ class ProcessesView(tk.Frame):
                                         pids.add(pid)
                                 except ValueError:
                                     continue
-                        self.window_pids = pids
+                        if not self.window_tracking:
+                            self.window_pids = pids
                         return
                 except FileNotFoundError:
                     pass  # wmctrl not installed, fall back to xprop
@@ -758,7 +1203,9 @@ class ProcessesView(tk.Frame):
                                 continue
                 except:
                     pass
-                self.window_pids = pids
+                # The backend may have started reporting while this ran
+                if not self.window_tracking:
+                    self.window_pids = pids
             finally:
                 self._window_pid_thread_running = False
 
@@ -766,174 +1213,458 @@ class ProcessesView(tk.Frame):
         self._window_pid_thread_running = True
         threading.Thread(target=_fetch_pids, daemon=True).start()
 
-    def _classify_process(self, pid, name):
-        """Classify process as app or background"""
-        # Check cache first (fast path)
-        if pid in self.classification_cache:
-            cached = self.classification_cache[pid]
-            # Re-check window_pids for previously non-app processes
-            if not cached and pid in self.window_pids:
-                self.classification_cache[pid] = True
-                return True
-            return cached
+    def _app_unit(self, cgroup):
+        """cgroup if it is an app unit, else None (memoized)"""
+        is_unit = self._app_units.get(cgroup)
+        if is_unit is None:
+            is_unit = self._app_units[cgroup] = is_app_unit(cgroup)
+        return cgroup if is_unit else None
+
+    def _unit_name(self, unit):
+        """Name of an app unit's group: its topmost process (the launched app),
+        the oldest one if the unit has several. Memoized until the unit changes."""
+        name = self._unit_names.get(unit)
+        if name is None:
+            processes = self.processes
+            roots = [processes[pid] for pid in self._units[unit]
+                     if processes.get(processes[pid][7], (None,) * 10)[9] != unit]
+            root = min(roots or [processes[pid] for pid in self._units[unit]], key=lambda rec: (rec[16], rec[0]))
+            name = self._unit_names[unit] = root[1]
+        return name
+
+    def _group_key(self, pid):
+        """(group key, name) of pid, from the backend's uid / ppid / cgroup fields alone"""
+        rec = self.processes[pid]
+        name = rec[1]
+        uid, cgroup = rec[6], rec[9]
+
+        # One group per app unit, keyed by the unit so two instances of an app
+        # stay apart: the launched app plus every helper and child it spawned
+        unit = self._app_unit(cgroup)
+        if unit and unit in self._units:
+            name = self._unit_name(unit)
+            return ('bg' if name.lower() in BLACKLIST else 'app', unit), name
 
         name_lower = name.lower()
-
-        # Quick blacklist check (no system calls needed) - case insensitive
-        if name_lower in BLACKLIST or name_lower in PARENT_BLACKLIST:
-            self.classification_cache[pid] = False
-            return False
-
-        # Also check for partial matches (e.g., crashpad in chrome_crashpad_handler)
-        if any(bl in name_lower for bl in ['crashpad', 'helper', 'zygote', 'nacl_helper']):
-            self.classification_cache[pid] = False
-            return False
-
-        # Check if it has a window (fast set lookup)
+        if uid != self._uid:
+            return ('bg', name), name
         if pid in self.window_pids:
-            self.classification_cache[pid] = True
-            return True
-
-        # Check app patterns (no system calls)
+            return ('app', name), name
+        if name_lower in BLACKLIST or name_lower in PARENT_BLACKLIST:
+            return ('bg', name), name
+        if any(pat in name_lower for pat in HELPER_PATTERNS):
+            return ('bg', name), name
+        # No unit and no window (no systemd user session or no X display): known app names
         if any(pat in name_lower for pat in APP_PATTERNS):
-            self.classification_cache[pid] = True
-            return True
-
-        # Only do expensive uid check if nothing else matched
-        try:
-            proc = psutil.Process(pid)
-            if proc.uids().real != os.getuid():
-                self.classification_cache[pid] = False
-                return False
-        except:
-            self.classification_cache[pid] = False
-            return False
-
-        self.classification_cache[pid] = False
-        return False
+            return ('app', name), name
+        return ('bg', name), name
 
     def update_data(self, data):
-        """Update process data from backend"""
-        self.process_data = data
-
-        # Periodic cache cleanup (every 30 updates)
-        self._cache_cleanup_counter += 1
-        if self._cache_cleanup_counter >= 30:
-            self._cache_cleanup_counter = 0
-            current_pids = {int(d[0]) for d in data}
-            # Remove stale entries
-            self.classification_cache = {
-                pid: val for pid, val in self.classification_cache.items()
-                if pid in current_pids
-            }
-
-        apps = {}
-        background = {}
-
-        for pid, name, state, cpu, mem, threads in data:
-            int_pid = int(pid)
-            cpu_val = float(cpu)
-            mem_mb = int(mem) / 1024
-
-            is_app = self._classify_process(int_pid, name)
-            target = apps if is_app else background
-
-            if name not in target:
-                target[name] = {'pids': [], 'cpu': 0.0, 'mem': 0.0, 'state': state, 'details': {}}
-
-            target[name]['pids'].append(int_pid)
-            target[name]['cpu'] += cpu_val
-            target[name]['mem'] += mem_mb
-            # Store individual process details for expansion
-            target[name]['details'][int_pid] = {'cpu': cpu_val, 'mem': mem_mb}
-
-        self._update_rows(apps, background)
-        self.count_label.configure(text=f"{len(data)} processes")
-        self.process_groups = {**apps, **background}
-
-    def _update_rows(self, apps, background):
-        """Update process rows"""
-        current_keys = set()
-
-        for name in apps:
-            current_keys.add(('app', name))
-        for name in background:
-            current_keys.add(('bg', name))
-
-        existing_keys = set(self.rows.keys())
-        to_add = current_keys - existing_keys
-        to_remove = existing_keys - current_keys
-        to_update = current_keys & existing_keys
-
-        # Remove dead processes
-        for key in to_remove:
-            self.rows[key].destroy()
-            del self.rows[key]
-
-        # Update existing
-        for key in to_update:
-            section, name = key
-            info = apps[name] if section == 'app' else background[name]
-            self.rows[key].update_data(
-                info['cpu'], info['mem'], info['state'], info['pids'],
-                process_details=info.get('details', {})
-            )
-
-        # Add new
-        for key in to_add:
-            section, name = key
-            if section == 'app':
-                info = apps[name]
-                # Get icon for app
-                icon = self.icon_loader.get_icon(name)
-                row = ProcessRow(
-                    self.apps_container, name, info['pids'],
-                    info['cpu'], info['mem'], info['state'], is_app=True,
-                    on_select=self._on_row_select, on_context=self._show_context_menu,
-                    process_details=info.get('details', {}), icon=icon
-                )
+        """Apply a full snapshot from backend: [(pid, name, state, cpu, mem_kb, threads, uid, ppid, session, cgroup,
+        disk_read, disk_written, net_received, net_sent, pss_kb, uss_kb,
+        start_time_ms, subtree_mem_kb, subtree_cpu, subtree_disk, subtree_net), ...]"""
+        seen = {rec[0] for rec in data}
+        exited = [pid for pid in self.processes if pid not in seen]
+        self.apply_delta(data, exited)
+
+    def apply_delta(self, changed, exited):
+        """Apply new/changed records and exited PIDs to the persistent process state"""
+        dirty = set()
+        dirty_units = set()  # units whose members may now group under another process
+        tree_dirty = set()  # tree nodes (0 = the roots) whose children or their order may have changed
+        tree_changed = []
+        reshaped = False
+
+        for pid in exited:
+            if pid not in self.processes:
+                continue
+            # Its children are roots now, until their records name their new parent
+            tree_dirty.update((self._tree_parent(pid), pid))
+            if pid in self._claimed:
+                tree_dirty.add(0)
+            reshaped = True
+            old = self.processes.pop(pid)
+            self._unclaim(pid, old[7])
+            self._collapsed.discard(pid)
+            self._leave_unit(pid, old[9], dirty_units)
+            key = self._proc_group.pop(pid)
+            del self.groups[key]['details'][pid]
+            dirty.add(key)
+
+        for rec in changed:
+            pid, name, state, cpu, mem, threads = rec[:6]
+            old = self.processes.get(pid)
+            if old == rec:
+                continue
+            old_parent = self._tree_parent(pid) if old is not None else None
+            self.processes[pid] = rec
+            if old is None or old[7] != rec[7] or old[16] != rec[16]:
+                # Moved in the tree; processes that named it as parent may only now be its children
+                if old is not None:
+                    self._unclaim(pid, old[7])
+                    tree_dirty.add(old_parent)
+                self._claimed.setdefault(rec[7], set()).add(pid)
+                tree_dirty.update((self._tree_parent(pid), pid))
+                if pid in self._claimed:
+                    tree_dirty.add(0)
+                reshaped = True
+            elif self._tree_sort_key(old) != self._tree_sort_key(rec):
+                tree_dirty.add(old_parent)
+            tree_changed.append(pid)
+            if old is not None and old[1] == name and old[6:10] == rec[6:10]:
+                # Only the usage changed: same group as before
+                key = self._proc_group[pid]
+            else:
+                if old is not None and old[9] != rec[9]:
+                    self._leave_unit(pid, old[9], dirty_units)
+                unit = self._app_unit(rec[9])
+                if unit:
+                    self._units.setdefault(unit, set()).add(pid)
+                    dirty_units.add(unit)
+                key = self._place_process(pid, dirty)
+            # RAM is PSS once the backend has measured it: shared pages then count once per group, not per process
+            pss, uss = rec[14], rec[15]
+            self.groups[key]['details'][pid] = {'cpu': cpu, 'mem': (pss or mem) / 1024, 'rss': mem / 1024,
+                                                'uss': uss / 1024, 'state': state, 'threads': threads,
+                                                'disk': (rec[10] + rec[11]) / MB, 'net': (rec[12] + rec[13]) / MB}
+            dirty.add(key)
+
+        # Units whose members changed may be named after another process now
+        for unit in dirty_units:
+            self._unit_names.pop(unit, None)
+
+        # New window list: processes may have become apps without changing
+        if self.window_pids != self._classified_window_pids:
+            self._classified_window_pids = self.window_pids
+            for pid in self.processes:
+                self._place_process(pid, dirty)
+        else:
+            for unit in dirty_units:
+                for pid in self._units.get(unit, ()):
+                    self._place_process(pid, dirty)
+
+        self._update_groups(dirty)
+        self._update_rows(dirty)
+        self._update_tree(tree_dirty, tree_changed, reshaped)
+        self.count_label.configure(text=f"{len(self.processes)} processes")
+
+    def _leave_unit(self, pid, cgroup, dirty_units):
+        """Drop pid from its app unit; the rest of the unit may need a new group name"""
+        members = self._units.get(cgroup)
+        if members is None:
+            return
+        members.discard(pid)
+        if members:
+            dirty_units.add(cgroup)
+        else:
+            del self._units[cgroup]
+            self._unit_names.pop(cgroup, None)
+
+    def _unclaim(self, pid, ppid):
+        claimed = self._claimed.get(ppid)
+        if claimed is not None:
+            claimed.discard(pid)
+            if not claimed:
+                del self._claimed[ppid]
+
+    def _tree_parent(self, pid):
+        """pid's parent in the tree, or 0 for a root"""
+        rec = self.processes[pid]
+        parent = self.processes.get(rec[7])
+        if parent is None or rec[7] == pid or parent[16] > rec[16]:
+            return 0
+        return rec[7]
+
+    def _tree_children(self, pid):
+        """Children of a tree node (0 = the roots) in sort order; cached until _update_tree drops them"""
+        order = self._tree_order.get(pid)
+        if order is None:
+            if pid == 0:
+                members = [p for p in self.processes if self._tree_parent(p) == 0]
             else:
-                info = background[name]
-                row = ProcessRow(
-                    self.bg_container, name, info['pids'],
-                    info['cpu'], info['mem'], info['state'], is_app=False,
-                    on_select=self._on_row_select, on_context=self._show_context_menu,
-                    process_details=info.get('details', {})
-                )
-            self.rows[key] = row
-            row.pack(fill=tk.X)
-
-        self.apps_header.set_count(len(apps))
-        self.bg_header.set_count(len(background))
+                members = [c for c in self._claimed.get(pid, ()) if self._tree_parent(c) == pid]
+            order = sorted(members, key=lambda p: self._tree_sort_key(self.processes[p]),
+                           reverse=self.sort_reverse)
+            self._tree_order[pid] = order
+        return order
+
+    @staticmethod
+    def _tree_info(rec):
+        """Row values of a tree node: the backend's totals over its subtree"""
+        return {'cpu': rec[18], 'mem': rec[17] / 1024, 'disk': rec[19] / MB, 'net': rec[20] / MB,
+                'state': rec[2], 'pids': [rec[0]], 'threads': rec[5]}
+
+    def _tree_sort_key(self, rec):
+        """Sort key of a tree node among its siblings, like _sort_entry for groups"""
+        column = self.sort_column
+        name = rec[1].lower()
+        if column == 'name':
+            value = name
+        elif column == 'pid':
+            value = rec[0]
+        elif column == 'threads':
+            value = rec[5]
+        else:
+            value = round(self._tree_info(rec)[column], 1)
+        return (value, name, rec[0])
+
+    def _update_tree(self, dirty, changed, reshaped):
+        """Re-sort only the child lists that changed, relayout if the tree's shape or order did,
+        and refresh the visible nodes among the changed processes"""
+        relayout = reshaped
+        for pid in dirty:
+            old = self._tree_order.pop(pid, None)
+            if self.tree_mode and not relayout and old is not None and self._tree_children(pid) != old:
+                relayout = True
+        if not self.tree_mode:
+            return
+
+        if relayout:
+            self._rebuild_lines()
+        for pid in changed:
+            row = self._visible.get(('node', pid))
+            if row is not None:
+                row.update_data(self._tree_info(self.processes[pid]))
+
+    def _place_process(self, pid, dirty):
+        """Move pid into the group matching its current classification; returns the group key"""
+        key, name = self._group_key(pid)
+        old_key = self._proc_group.get(pid)
+        if old_key == key:
+            group = self.groups[key]
+            if group['name'] != name:
+                # An app unit whose top process changed: same group, new name
+                group['name'] = name
+                dirty.add(key)
+            return key
+
+        details = None
+        if old_key is not None:
+            details = self.groups[old_key]['details'].pop(pid)
+            dirty.add(old_key)
+
+        group = self.groups.get(key)
+        if group is None:
+            group = {'name': name, 'pids': [], 'cpu': 0.0, 'mem': 0.0, 'disk': 0.0, 'net': 0.0, 'threads': 0,
+                     'state': '', 'details': {}}
+            self.groups[key] = group
+        if details is not None:
+            group['details'][pid] = details
+
+        self._proc_group[pid] = key
+        dirty.add(key)
+        return key
+
+    def update_gpu_processes(self, gpu_procs):
+        """Store per-process GPU memory from backend: [(gpu_index, pid, mem_mb), ...]"""
+        gpu_memory = {}
+        for _gpu_index, pid, mem_mb in gpu_procs:
+            gpu_memory[pid] = gpu_memory.get(pid, 0) + mem_mb
+        self.gpu_memory = gpu_memory
+
+    def _update_groups(self, dirty):
+        """Recompute totals for groups whose members changed, dropping empty ones"""
+        for key in dirty:
+            group = self.groups.get(key)
+            if group is None:
+                continue
+            details = group['details']
+            if not details:
+                del self.groups[key]
+                continue
+            group['pids'] = list(details)
+            group['cpu'] = sum(d['cpu'] for d in details.values())
+            group['mem'] = sum(d['mem'] for d in details.values())
+            group['disk'] = sum(d['disk'] for d in details.values())
+            group['net'] = sum(d['net'] for d in details.values())
+            group['threads'] = sum(d['threads'] for d in details.values())
+            group['state'] = next(iter(details.values()))['state']
+
+    def _update_rows(self, dirty):
+        """Relayout when groups come, go or change members; otherwise refresh visible rows only"""
+        relayout = False
+        for key in dirty:
+            info = self.groups.get(key)
+            section = key[0]
+
+            # Remove dead processes
+            if info is None:
+                if key in self._listed:
+                    del self._listed[key]
+                    self._remove_entry(section, self._sort_entries.pop(key))
+                    self._section_counts[section] -= 1
+                    self._expanded_groups.discard(key)
+                    relayout = True
+                continue
+
+            # Add new
+            if key not in self._listed:
+                self._listed[key] = info['pids']
+                entry = self._sort_entry(key, info)
+                self._sort_entries[key] = entry
+                bisect.insort(self._section_keys[section], entry)
+                self._section_counts[section] += 1
+                relayout = True
+                continue
+
+            # Update existing
+            expanded = key in self._expanded_groups
+            if expanded and info['pids'] != self._listed[key]:
+                relayout = True
+            self._listed[key] = info['pids']
+
+            # Re-insert only groups whose sort value changed; relayout only if they moved
+            entry = self._sort_entry(key, info)
+            old_entry = self._sort_entries[key]
+            if entry != old_entry:
+                old_index = self._remove_entry(section, old_entry)
+                entries = self._section_keys[section]
+                index = bisect.bisect_left(entries, entry)
+                entries.insert(index, entry)
+                self._sort_entries[key] = entry
+                if index != old_index:
+                    relayout = True
+
+            row = self._visible.get(('group', key))
+            if row is not None and row.name != info['name']:
+                self._assign_row(row, ('group', key))
+            elif row is not None:
+                row.update_data(info)
+            if expanded:
+                for pid, details in info['details'].items():
+                    sub_row = self._visible.get(('sub', key, pid))
+                    if sub_row is not None:
+                        sub_row.update_data(details['cpu'], details['mem'], details['disk'], details['net'],
+                                            details['threads'])
+
+        if relayout and not self.tree_mode:
+            self._rebuild_lines()
+        if self.selected is not None and self._selected_process() is None:
+            self._clear_selection()
+
+        self.apps_header.set_count(self._section_counts['app'])
+        self.bg_header.set_count(self._section_counts['bg'])
+
+    def _sort_entry(self, key, group):
+        """Sort key of a group for the current column; name breaks ties so the order is stable"""
+        column = self.sort_column
+        name = group['name'].lower()
+        if column == 'name':
+            value = name
+        elif column == 'pid':
+            value = min(group['pids'])
+        elif column == 'threads':
+            value = group['threads']
+        else:
+            # At display precision, so jitter the user cannot see does not reorder rows
+            value = round(group[column], 1)
+        return (value, name, key)
+
+    def _remove_entry(self, section, entry):
+        """Drop entry from a section's sorted list; returns where it was"""
+        entries = self._section_keys[section]
+        index = bisect.bisect_left(entries, entry)
+        del entries[index]
+        return index
+
+    def set_sort(self, column):
+        """Sort by column (a header click); the same column again reverses the order"""
+        if column == self.sort_column:
+            self.sort_reverse = not self.sort_reverse
+        else:
+            self.sort_column = column
+            self.sort_reverse = column not in ('name', 'pid')
+
+        for section in self._section_keys:
+            self._section_keys[section] = []
+        for key in self._listed:
+            entry = self._sort_entry(key, self.groups[key])
+            self._sort_entries[key] = entry
+            self._section_keys[key[0]].append(entry)
+        for entries in self._section_keys.values():
+            entries.sort()
+        self._tree_order.clear()
+
+        self._update_sort_labels()
+        self._rebuild_lines()
+
+    def _update_sort_labels(self):
+        """Mark the sorted column's header with the sort direction"""
+        titles = {'name': "Name", 'cpu': "CPU", 'mem': "RAM", 'disk': "Disk", 'net': "Network",
+                  'threads': "Threads", 'pid': "PID"}
+        for column, label in self._sort_labels.items():
+            title = titles[column]
+            if column == self.sort_column:
+                title += " ▼" if self.sort_reverse else " ▲"
+            label.configure(text=title)
 
     def _on_row_select(self, row):
         """Handle row selection"""
-        if self.selected_row:
-            self.selected_row.set_selected(False)
+        old = self._visible.get(self.selected) if self.selected is not None else None
+        if old is not None:
+            old.set_selected(False)
 
-        self.selected_row = row
+        self.selected = row.line
         row.set_selected(True)
         self.end_btn.configure(state=tk.NORMAL)
 
+    def _clear_selection(self):
+        old = self._visible.get(self.selected) if self.selected is not None else None
+        if old is not None:
+            old.set_selected(False)
+        self.selected = None
+        self.end_btn.configure(state=tk.DISABLED)
+
+    def _selected_process(self):
+        """The selected group or process as a SelectedProcess, or None if it has gone"""
+        line = self.selected
+        if line is None:
+            return None
+        if line[0] == 'node':
+            # A tree node stands for its own process: ending it leaves the children alone
+            key = self._proc_group.get(line[1])
+            pid = line[1]
+        else:
+            key = line[1]
+            pid = line[2] if line[0] == 'sub' else None
+        group = self.groups.get(key)
+        if group is None:
+            return None
+        if pid is not None:
+            details = group['details'].get(pid)
+            if details is None:
+                return None
+            name = self.processes[pid][1] if line[0] == 'node' else group['name']
+            return SelectedProcess(True, name, [pid], details['cpu'], details['mem'],
+                                   details['rss'], details['uss'], details['disk'], details['net'], False)
+        members = group['details'].values()
+        return SelectedProcess(False, group['name'], group['pids'], group['cpu'], group['mem'],
+                               sum(d['rss'] for d in members), sum(d['uss'] for d in members),
+                               group['disk'], group['net'], key[0] == 'app')
+
     def _show_context_menu(self, event, row):
         """Show right-click context menu"""
+        target = self._selected_process()
+        if target is None:
+            return
+
         menu = Menu(self, tearoff=0)
         menu.configure(bg=COLORS['surface'], fg=COLORS['text_primary'],
                       activebackground=COLORS['selection'], activeforeground=COLORS['text_primary'])
 
         # Different label for single process vs group
-        if isinstance(row, SubProcessRow):
-            menu.add_command(label=f"End Process (PID {row.pid})", command=self._kill_selected)
+        if target.is_sub:
+            menu.add_command(label=f"End Process (PID {target.pids[0]})", command=self._kill_selected)
             menu.add_command(label="Force Kill (SIGKILL)", command=self._force_kill_selected)
         else:
-            if len(row.pids) > 1:
-                menu.add_command(label=f"End All ({len(row.pids)} processes)", command=self._kill_selected)
+            if len(target.pids) > 1:
+                menu.add_command(label=f"End All ({len(target.pids)} processes)", command=self._kill_selected)
             else:
                 menu.add_command(label="End Task", command=self._kill_selected)
             menu.add_command(label="Force Kill (SIGKILL)", command=self._force_kill_selected)
 
         menu.add_separator()
-        menu.add_command(label="Properties", command=lambda: self._show_details(row))
+        menu.add_command(label="Properties", command=lambda: self._show_details(target))
 
         try:
             menu.tk_popup(event.x_root, event.y_root)
@@ -941,14 +1672,14 @@ class ProcessesView(tk.Frame):
             menu.grab_release()
 
     def _show_details(self, row):
-        """Show process details dialog"""
+        """Show process details dialog for a SelectedProcess"""
         dialog = tk.Toplevel(self)
 
-        # Handle both ProcessRow and SubProcessRow
-        is_sub = isinstance(row, SubProcessRow)
-        title = f"PID {row.pid}" if is_sub else row.name
+        # Handle both groups and single processes
+        is_sub = row.is_sub
+        title = f"PID {row.pids[0]}" if is_sub else row.name
         dialog.title(f"Properties - {title}")
-        dialog.geometry("420x320")
+        dialog.geometry("420x440")
         dialog.configure(bg=COLORS['bg_secondary'])
         dialog.transient(self)
 
@@ -967,9 +1698,11 @@ class ProcessesView(tk.Frame):
         if is_sub:
             details = [
                 ("Process Name", row.name),
-                ("PID", str(row.pid)),
+                ("PID", str(row.pids[0])),
                 ("CPU Usage", f"{row.cpu:.2f}%"),
-                ("Memory", f"{row.mem:.2f} MiB" if row.mem < 1024 else f"{row.mem/1024:.2f} GiB"),
+                ("Memory", format_memory(row.mem)),
+                ("Disk", format_rate(row.disk)),
+                ("Network", format_rate(row.net)),
             ]
         else:
             details = [
@@ -977,11 +1710,22 @@ class ProcessesView(tk.Frame):
                 ("PIDs", ", ".join(str(p) for p in row.pids[:5]) + ("..." if len(row.pids) > 5 else "")),
                 ("Process Count", str(len(row.pids))),
                 ("Total CPU", f"{row.cpu:.2f}%"),
-                ("Total Memory", f"{row.mem:.2f} MiB" if row.mem < 1024 else f"{row.mem/1024:.2f} GiB"),
+                ("Total Memory", format_memory(row.mem)),
+                ("Total Disk", format_rate(row.disk)),
+                ("Total Network", format_rate(row.net)),
             ]
 
+        # Memory above is PSS where measured; the RSS sum counts shared pages once per process
+        if row.uss:
+            details.append(("Resident (RSS)", format_memory(row.rss)))
+            details.append(("Private (USS)", format_memory(row.uss)))
+
+        gpu_mb = sum(self.gpu_memory.get(p, 0) for p in row.pids)
+        if gpu_mb:
+            details.append(("GPU Memory", f"{gpu_mb} MiB"))
+
         try:
-            pid = row.pid if is_sub else row.pids[0]
+            pid = row.pids[0]
             proc = psutil.Process(pid)
             details.append(("User", proc.username()))
             details.append(("Threads", str(proc.num_threads())))
@@ -1009,15 +1753,15 @@ class ProcessesView(tk.Frame):
 
     def _kill_selected(self):
         """Kill selected process"""
-        if not self.selected_row:
+        row = self._selected_process()
+        if row is None:
             return
 
-        row = self.selected_row
         pids = row.pids
-        is_sub = isinstance(row, SubProcessRow)
+        is_sub = row.is_sub
 
         if is_sub:
-            msg = f"End process PID {row.pid}?"
+            msg = f"End process PID {pids[0]}?"
         else:
             msg = f"End '{row.name}'?"
             if len(pids) > 1:
@@ -1026,47 +1770,63 @@ class ProcessesView(tk.Frame):
         if not messagebox.askyesno("End task", msg):
             return
 
-        killed = 0
-        for pid in pids:
-            try:
-                os.kill(pid, signal.SIGTERM)
-                killed += 1
-            except:
-                pass
-
-        time.sleep(0.3)
-
-        for pid in pids:
-            try:
-                if psutil.Process(pid).is_running():
-                    os.kill(pid, signal.SIGKILL)
-            except:
-                pass
-
-        if killed > 0:
-            if is_sub:
-                messagebox.showinfo("Success", f"Terminated process {row.pid}")
-            else:
-                messagebox.showinfo("Success", f"Terminated {killed} process(es)")
-
-        self.selected_row = None
-        self.end_btn.configure(state=tk.DISABLED)
+        self._signal_processes(row, signal.SIGTERM, END_TASK_TIMEOUT_MS)
+        self._clear_selection()
 
     def _force_kill_selected(self):
         """Force kill with SIGKILL"""
-        if not self.selected_row:
+        row = self._selected_process()
+        if row is None:
+            return
+        self._signal_processes(row, signal.SIGKILL, FORCE_KILL_TIMEOUT_MS)
+
+    def _signal_processes(self, row, sig, timeout_ms):
+        """
+        Hand all of row's processes to the backend in one batch and return at
+        once; it waits for the exits off the UI thread and kill_finished()
+        reports them. The start times let it skip PIDs reused since this snapshot.
+        """
+        targets = [(pid, self.processes[pid][16] if pid in self.processes else None) for pid in row.pids]
+        request = self.kill_backend(targets, sig, timeout_ms) if self.kill_backend else None
+        if request is not None:
+            self._kill_requests[request] = (row, sig)
             return
 
-        row = self.selected_row
-        is_sub = isinstance(row, SubProcessRow)
-
+        # No command channel: signal directly, without waiting or escalating
+        sent = 0
         for pid in row.pids:
             try:
-                os.kill(pid, signal.SIGKILL)
-            except:
+                os.kill(pid, sig)
+                sent += 1
+            except OSError:
                 pass
+        self._report_kill(row, sig, sent, [])
 
-        if is_sub:
-            messagebox.showinfo("Success", f"Sent SIGKILL to process {row.pid}")
+    def kill_finished(self, request, results):
+        """A batch from _signal_processes() is done: results are FRAME_KILL_RESULTS (pid, outcome, error)"""
+        pending = self._kill_requests.pop(request, None)
+        if pending is None:
+            return
+        row, sig = pending
+
+        ended = sum(1 for _pid, outcome, _error in results if outcome in (KILL_EXITED, KILL_KILLED))
+        problems = []
+        for pid, outcome, error in results:
+            if outcome == KILL_FAILED:
+                problems.append(f"PID {pid}: {os.strerror(error)}")
+            elif outcome == KILL_RUNNING:
+                problems.append(f"PID {pid}: still running")
+        self._report_kill(row, sig, ended, problems)
+
+    def _report_kill(self, row, sig, ended, problems):
+        """Tell the user how ending row went; processes already gone count as neither"""
+        verb = "Killed" if sig == signal.SIGKILL else "Terminated"
+        if problems:
+            shown = "\n".join(problems[:10]) + ("\n..." if len(problems) > 10 else "")
+            messagebox.showwarning("End task", f"{verb} {ended} process(es); {len(problems)} could not be ended:\n\n{shown}")
+        elif ended == 0:
+            return
+        elif row.is_sub:
+            messagebox.showinfo("Success", f"{verb} process {row.pids[0]}")
         else:
-            messagebox.showinfo("Success", f"Sent SIGKILL to {len(row.pids)} process(es)")
+            messagebox.showinfo("Success", f"{verb} {ended} process(es)")
@@ -0,0 +1,289 @@
+"""
+ServicesView - Services and containers from the backend's cgroup totals
+One row per cgroup v2 group that holds processes: systemd units, container scopes
+"""
+
+import re
+import tkinter as tk
+from tkinter import ttk
+from ..themes import COLORS, Theme
+from .processes_view import MB, get_usage_color, format_rate
+
+# Sortable columns after the name: key -> (title, width in characters)
+COLUMNS = {
+    'processes': ("Processes", 9),
+    'cpu': ("CPU", 8),
+    'mem': ("Memory", 10),
+    'disk': ("Disk", 10),
+    'cpu_pressure': ("CPU wait", 9),
+    'mem_pressure': ("Mem wait", 9),
+}
+
+# Container runtimes name their scopes after a 64-hex-digit container id
+CONTAINER_SCOPE = re.compile(r'^(?:cri-)?(containerd|docker|crio|libpod)-([0-9a-f]{12})[0-9a-f]{52}\.scope$')
+
+
+def cgroup_title(path):
+    """(name, location) shown for a cgroup path"""
+    if path == '/':
+        return "Host", "root cgroup: the whole system, groups below included"
+    parent, _, leaf = path.rpartition('/')
+    match = CONTAINER_SCOPE.match(leaf)
+    if match:
+        leaf = f"{match.group(1)} {match.group(2)}"
+    return leaf, parent or '/'
+
+
+class ServiceRow(tk.Frame):
+    """One cgroup: its name and where it sits, then the kernel's totals for it"""
+
+    ROW_HEIGHT = 56
+
+    def __init__(self, parent, fonts, **kwargs):
+        super().__init__(parent, bg=COLORS['bg_primary'], **kwargs)
+        # Rows are pooled: assign() points this widget at another cgroup
+        self.path = None
+        self.canvas_item = None  # set by ServicesView
+        self.offset = -1
+        self._prev = None  # cell values at display precision, to skip unchanged updates
+
+        inner = tk.Frame(self, bg=COLORS['surface'])
+        inner.pack(fill=tk.X, pady=(0, 2))
+
+        names = tk.Frame(inner, bg=COLORS['surface'])
+        names.pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(16, 8), pady=6)
+        self.name_label = tk.Label(names, text="", font=fonts['body'], anchor='w',
+                                   bg=COLORS['surface'], fg=COLORS['text_primary'])
+        self.name_label.pack(fill=tk.X)
+        self.path_label = tk.Label(names, text="", font=fonts['tiny'], anchor='w',
+                                   bg=COLORS['surface'], fg=COLORS['text_tertiary'])
+        self.path_label.pack(fill=tk.X)
+
+        # Packed from the right, so in reverse column order
+        self.cells = {}
+        for key, (_title, width) in reversed(COLUMNS.items()):
+            label = tk.Label(inner, text="", font=fonts['body'], width=width, anchor='e', padx=8, pady=12,
+                             bg=COLORS['surface'], fg=COLORS['text_primary'])
+            label.pack(side=tk.RIGHT, padx=(0, 16 if key == 'mem_pressure' else 8))
+            self.cells[key] = label
+
+    def assign(self, path, info):
+        """Show another cgroup in this (recycled) row"""
+        self.path = path
+        name, location = cgroup_title(path)
+        self.name_label.configure(text=name)
+        self.path_label.configure(text=location)
+        self._prev = None
+        self.update_data(info)
+
+    def update_data(self, info):
+        """Show a cgroup's totals (see ServicesView.update_data for the keys)"""
+        shown = (info['processes'], round(info['cpu'], 1), round(info['mem'], 1), round(info['disk'], 1),
+                 round(info['cpu_pressure'], 1), round(info['mem_pressure'], 1))
+        if shown == self._prev:
+            return
+        self._prev = shown
+
+        cells = self.cells
+        cells['processes'].configure(text=str(info['processes']))
+        cells['cpu'].configure(text=f"{info['cpu']:.2f}%", bg=get_usage_color(info['cpu'], 10))
+        mem = info['mem']
+        cells['mem'].configure(text=f"{mem/1024:.2f}GiB" if mem >= 1024 else f"{mem:.2f}MiB",
+                               bg=get_usage_color(mem, 4096))
+        cells['disk'].configure(text=format_rate(info['disk']), bg=get_usage_color(info['disk'], 100))
+        # Pressure is already a share of time: 10% of it spent waiting is a lot
+        cells['cpu_pressure'].configure(text=f"{info['cpu_pressure']:.1f}%",
+                                        bg=get_usage_color(info['cpu_pressure'], 20))
+        cells['mem_pressure'].configure(text=f"{info['mem_pressure']:.1f}%",
+                                        bg=get_usage_color(info['mem_pressure'], 20))
+
+
+class ServicesView(tk.Frame):
+    """
+    Services and containers, one row per cgroup. Every number is the
+    kernel's own total for the group (cpu.stat, memory.current, io.stat and
+    the PSI files, read by the backend's --cgroups), not a sum of the
+    processes inside it, so it stays exact with thousands of processes.
+    """
+
+    def __init__(self, parent, **kwargs):
+        super().__init__(parent, bg=COLORS['bg_primary'], **kwargs)
+        self.cgroups = {}  # path -> info dict, see update_data()
+        # Virtualized like the process list: line i of _order sits at
+        # i * ServiceRow.ROW_HEIGHT and only lines in the viewport have a row
+        self._order = []    # paths in display order
+        self._index = {}    # path -> its position in _order
+        self._visible = {}  # path -> ServiceRow showing it
+        self._pool = []     # hidden rows ready for reuse
+        self._all_rows = []
+        self._width = 1
+        self._refresh_pending = False
+        self.visible = False
+        self.sort_column = 'cpu'
+        self.sort_reverse = True
+        self._sort_labels = {}
+        self._fonts = {
+            'body': Theme.get_font(Theme.FONT_SIZE_BODY),
+            'bold': Theme.get_font(Theme.FONT_SIZE_BODY, bold=True),
+            'tiny': Theme.get_font(Theme.FONT_SIZE_TINY),
+        }
+        self._create_ui()
+
+    def _create_ui(self):
+        header = tk.Frame(self, bg=COLORS['bg_tertiary'])
+        header.pack(fill=tk.X, padx=(0, Theme.PADDING_MEDIUM))
+
+        self._sort_labels['name'] = tk.Label(header, text="Name", font=self._fonts['bold'], anchor='w',
+                                             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'])
+        self._sort_labels['name'].pack(side=tk.LEFT, fill=tk.X, expand=True, padx=(16, 8), pady=12)
+        for key, (title, width) in reversed(COLUMNS.items()):
+            label = tk.Label(header, text=title, font=self._fonts['bold'], width=width, anchor='e', padx=8,
+                             bg=COLORS['bg_tertiary'], fg=COLORS['text_secondary'])
+            label.pack(side=tk.RIGHT, padx=(0, 16 if key == 'mem_pressure' else 8), pady=12)
+            self._sort_labels[key] = label
+        for column, label in self._sort_labels.items():
+            label.configure(cursor='hand2')
+            label.bind('<Button-1>', lambda e, c=column: self.set_sort(c))
+        self._update_sort_labels()
+
+        container = tk.Frame(self, bg=COLORS['bg_primary'])
+        container.pack(fill=tk.BOTH, expand=True, padx=(0, Theme.PADDING_MEDIUM))
+        self.canvas = tk.Canvas(container, bg=COLORS['bg_primary'], highlightthickness=0)
+        self.scrollbar = ttk.Scrollbar(container, orient=tk.VERTICAL, command=self.canvas.yview)
+        self.canvas.configure(yscrollcommand=self._on_yscroll)
+        self.canvas.pack(side=tk.LEFT, fill=tk.BOTH, expand=True)
+        self.scrollbar.pack(side=tk.RIGHT, fill=tk.Y)
+        self.canvas.bind('<Configure>', self._on_canvas_configure)
+
+        # ProcessesView owns the global wheel binding; this one only acts while the tab is shown
+        self.canvas.bind_all('<Button-4>', lambda e: self._scroll(-3), add='+')
+        self.canvas.bind_all('<Button-5>', lambda e: self._scroll(3), add='+')
+
+        self.empty_label = tk.Label(
+            self.canvas,
+            text="No cgroup totals yet. The backend needs a cgroup v2 hierarchy (/sys/fs/cgroup).",
+            font=self._fonts['body'], bg=COLORS['bg_primary'], fg=COLORS['text_secondary']
+        )
+        self._empty_item = self.canvas.create_window(0, 40, window=self.empty_label, anchor='n')
+
+        bottom_bar = tk.Frame(self, bg=COLORS['bg_secondary'])
+        bottom_bar.pack(fill=tk.X, side=tk.BOTTOM)
+        self.count_label = tk.Label(bottom_bar, text="0 groups", font=self._fonts['body'],
+                                    bg=COLORS['bg_secondary'], fg=COLORS['text_secondary'])
+        self.count_label.pack(side=tk.LEFT, padx=16, pady=12)
+
+    def _scroll(self, units):
+        if self.visible:
+            self.canvas.yview_scroll(units, 'units')
+
+    def set_visible(self, visible):
+        """The main window switched tabs; a newly shown tab catches up on what it missed"""
+        self.visible = visible
+        if visible:
+            self._render()
+
+    def update_data(self, cgroups):
+        """Replace the groups with a FRAME_CGROUPS list: [(path, processes, cpu, memory_bytes,
+        disk_read, disk_written, cpu_pressure, memory_pressure), ...]"""
+        self.cgroups = {
+            path: {'processes': processes, 'cpu': cpu, 'mem': memory / MB, 'disk': (read + written) / MB,
+                   'cpu_pressure': cpu_pressure, 'mem_pressure': memory_pressure}
+            for path, processes, cpu, memory, read, written, cpu_pressure, memory_pressure in cgroups
+        }
+        if self.visible:
+            self._render()
+
+    def _render(self):
+        """Bring the rows up to date: lay the lines out again only if the order changed"""
+        order = sorted(self.cgroups, key=self._sort_key, reverse=self.sort_reverse)
+        if order != self._order:
+            self._order = order
+            self._index = {path: i for i, path in enumerate(order)}
+            self.canvas.configure(scrollregion=(0, 0, self._width, len(order) * ServiceRow.ROW_HEIGHT))
+            self.canvas.itemconfigure(self._empty_item, state='hidden' if order else 'normal')
+            self._refresh_viewport()
+
+        for path, row in self._visible.items():
+            row.update_data(self.cgroups[path])
+        self.count_label.configure(text=f"{len(self.cgroups)} groups")
+
+    def _on_canvas_configure(self, event):
+        """Stretch rows to the new width and fill a taller viewport"""
+        self._width = event.width
+        self.canvas.coords(self._empty_item, event.width // 2, 40)
+        for row in self._all_rows:
+            self.canvas.itemconfigure(row.canvas_item, width=event.width)
+        self.canvas.configure(scrollregion=(0, 0, self._width, len(self._order) * ServiceRow.ROW_HEIGHT))
+        self._refresh_viewport()
+
+    def _on_yscroll(self, first, last):
+        """Scrollbar feedback from the canvas: the viewport moved"""
+        self.scrollbar.set(first, last)
+        if not self._refresh_pending:
+            self._refresh_pending = True
+            self.after_idle(self._refresh_viewport)
+
+    def _refresh_viewport(self):
+        """Give the lines inside the viewport a row, recycle the rest and move
+        only the rows whose line changed position"""
+        self._refresh_pending = False
+        top = self.canvas.canvasy(0)
+        bottom = top + self.canvas.winfo_height()
+        first = max(0, int(top // ServiceRow.ROW_HEIGHT))
+        last = min(len(self._order), int(bottom // ServiceRow.ROW_HEIGHT) + 1)
+        wanted = self._order[first:last]
+        wanted_set = set(wanted)
+
+        for path in [p for p in self._visible if p not in wanted_set]:
+            row = self._visible.pop(path)
+            self.canvas.itemconfigure(row.canvas_item, state='hidden')
+            self._pool.append(row)
+
+        for path in wanted:
+            row = self._visible.get(path)
+            if row is None:
+                row = self._acquire_row()
+                row.assign(path, self.cgroups[path])
+                self._visible[path] = row
+                self.canvas.itemconfigure(row.canvas_item, state='normal')
+            y = self._index[path] * ServiceRow.ROW_HEIGHT
+            if row.offset != y:
+                row.offset = y
+                self.canvas.coords(row.canvas_item, 0, y)
+
+    def _acquire_row(self):
+        """Take a hidden row from the pool, creating one only when it is empty"""
+        if self._pool:
+            return self._pool.pop()
+        row = ServiceRow(self.canvas, self._fonts)
+        row.canvas_item = self.canvas.create_window(0, 0, window=row, anchor='nw',
+                                                    width=self._width, height=ServiceRow.ROW_HEIGHT)
+        self._all_rows.append(row)
+        return row
+
+    def _sort_key(self, path):
+        """Sort key for the current column; the path breaks ties so the order is stable"""
+        if self.sort_column == 'name':
+            return (cgroup_title(path)[0].lower(), path)
+        value = self.cgroups[path][self.sort_column]
+        # At display precision, so jitter the user cannot see does not reorder rows
+        return (value if self.sort_column == 'processes' else round(value, 1), path)
+
+    def set_sort(self, column):
+        """Sort by column (a header click); the same column again reverses the order"""
+        if column == self.sort_column:
+            self.sort_reverse = not self.sort_reverse
+        else:
+            self.sort_column = column
+            self.sort_reverse = column != 'name'
+        self._update_sort_labels()
+        if self.visible:
+            self._render()
+
+    def _update_sort_labels(self):
+        """Mark the sorted column's header with the sort direction"""
+        for column, label in self._sort_labels.items():
+            title = "Name" if column == 'name' else COLUMNS[column][0]
+            if column == self.sort_column:
+                title += " ▼" if self.sort_reverse else " ▲"
+            label.configure(text=title)
@@ -1,5 +1,5 @@
 """Custom widgets package"""
-from .graph_widget import GraphWidget
+from .graph_widget import GraphWidget, MiniGraphWidget
 from .performance_button import PerformanceButton
 
-__all__ = ['GraphWidget', 'PerformanceButton']
+__all__ = ['GraphWidget', 'MiniGraphWidget', 'PerformanceButton']
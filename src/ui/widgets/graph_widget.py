@@ -6,12 +6,19 @@ Uses canvas item reuse instead of delete/recreate for better performance
 import tkinter as tk
 from collections import deque
 from ..themes import COLORS, Theme
+from .redraw_scheduler import RedrawScheduler
 
 
 class GraphWidget(tk.Canvas):
     """
     Optimized graph widget for displaying real-time performance data.
     Reuses canvas items instead of deleting and recreating each frame.
+
+    Data changes only mark the graph dirty; RedrawScheduler draws it at the
+    next idle point, and not at all while it is unmapped. Axes and grid are
+    laid out only when the size, scale or labels change, x positions are
+    cached per width, and a series with more points than pixel columns is
+    reduced to the min and max of each column.
     """
 
     def __init__(self, parent, width=400, height=140, line_color=None, fill_color=None, **kwargs):
@@ -24,8 +31,11 @@ class GraphWidget(tk.Canvas):
             **kwargs
         )
 
-        self.data_primary = deque(maxlen=Theme.GRAPH_HISTORY_SIZE)
-        self.data_secondary = deque(maxlen=Theme.GRAPH_HISTORY_SIZE)
+        # Points across the full width; set_range() changes it for longer time ranges
+        self.max_points = Theme.GRAPH_HISTORY_SIZE
+        self.range_label = "60s"
+        self.data_primary = deque(maxlen=self.max_points)
+        self.data_secondary = deque(maxlen=self.max_points)
 
         self.max_value = 100
         self.show_secondary = False
@@ -55,7 +65,12 @@ class GraphWidget(tk.Canvas):
         self._value_text = None
         self._label_items = []
         self._initialized = False
+        self._layout_dirty = True    # grid, axes and labels need placing
         self._dirty = True
+        self._shown = {}             # canvas item -> drawn as visible
+        self._xs = []                # x of each point index, for _xs_key
+        self._columns = None         # [(first, end, x), ...] per pixel column, None if no decimation needed
+        self._xs_key = None          # (left, width, max_points) _xs / _columns were computed for
 
         # Cache fonts (avoid repeated font tuple creation)
         self._font_small_bold = Theme.get_font(Theme.FONT_SIZE_SMALL, bold=True)
@@ -66,32 +81,55 @@ class GraphWidget(tk.Canvas):
         self._last_height = 0
 
         self.bind('<Configure>', self._on_resize)
+        self.bind('<Map>', lambda e: self._schedule())
+
+    def _schedule(self):
+        """Mark dirty and draw at the next idle point"""
+        self._dirty = True
+        RedrawScheduler.schedule(self, self._update_graph)
 
     def set_max_value(self, value):
         """Set maximum Y-axis value"""
-        self.max_value = max(1, value)
-        self._dirty = True
+        value = max(1, value)
+        if value != self.max_value:
+            self.max_value = value
+            self._layout_dirty = True
+            self._schedule()
 
     def set_labels(self, y_label="", x_label=""):
         """Set axis labels"""
         self.label_y = y_label
         self.label_x = x_label
-        self._dirty = True
+        self._layout_dirty = True
+        self._schedule()
+
+    def set_range(self, points, label):
+        """Span the width with `points` values instead; label is the X-axis extent, e.g. "24h" """
+        self.max_points = points
+        self.range_label = label
+        self.data_primary = deque(self.data_primary, maxlen=points)
+        self.data_secondary = deque(self.data_secondary, maxlen=points)
+        self._layout_dirty = True
+        self._schedule()
 
     def add_value(self, value, secondary=None):
         """Add a new data point"""
         self.data_primary.append(value)
         if secondary is not None:
             self.data_secondary.append(secondary)
-        self._dirty = True
-        self._update_graph()
+        self._schedule()
+
+    def set_values(self, values):
+        """Replace the history at once, e.g. when a panel that was not drawn is shown"""
+        self.data_primary.clear()
+        self.data_primary.extend(values)
+        self._schedule()
 
     def clear(self):
         """Clear all data"""
         self.data_primary.clear()
         self.data_secondary.clear()
-        self._dirty = True
-        self._update_graph()
+        self._schedule()
 
     def _on_resize(self, event=None):
         """Handle resize"""
@@ -101,8 +139,7 @@ class GraphWidget(tk.Canvas):
             self._last_width = w
             self._last_height = h
             self._initialized = False  # Force full redraw on resize
-            self._dirty = True
-            self._update_graph()
+            self._schedule()
 
     def _init_canvas_items(self, left, top, right, bottom):
         """Initialize all canvas items once"""
@@ -162,7 +199,9 @@ class GraphWidget(tk.Canvas):
                                            font=self._font_tiny, fill=COLORS['text_tertiary'])
                 self._label_items.append(label_id)
 
+        self._shown = {}
         self._initialized = True
+        self._layout_dirty = True
 
     def _update_graph(self):
         """Update graph using existing canvas items"""
@@ -190,6 +229,37 @@ class GraphWidget(tk.Canvas):
         # Initialize canvas items if needed
         if not self._initialized:
             self._init_canvas_items(graph_left, graph_top, graph_right, graph_bottom)
+        if self._layout_dirty:
+            self._layout(graph_left, graph_top, graph_right, graph_bottom)
+
+        # Update secondary data
+        shown = self.show_secondary and len(self.data_secondary) > 1
+        if shown:
+            self._update_data_series(self.data_secondary, graph_left, graph_bottom, graph_width, graph_height,
+                                     self._fill_polygon_secondary, self._data_line_secondary)
+        self._set_shown(self._fill_polygon_secondary, shown)
+        self._set_shown(self._data_line_secondary, shown)
+
+        # Update primary data
+        shown = len(self.data_primary) > 1
+        if shown:
+            self._update_data_series(self.data_primary, graph_left, graph_bottom, graph_width, graph_height,
+                                     self._fill_polygon, self._data_line)
+        self._set_shown(self._fill_polygon, shown)
+        self._set_shown(self._data_line, shown)
+
+        # Update value text
+        if len(self.data_primary) > 0:
+            self.itemconfigure(self._value_text, text=f"{self.data_primary[-1]:.1f}{self.label_y}")
+        else:
+            self.itemconfigure(self._value_text, text="")
+
+        self._dirty = False
+
+    def _layout(self, graph_left, graph_top, graph_right, graph_bottom):
+        """Place the parts that only move with the size, scale or labels"""
+        graph_width = graph_right - graph_left
+        graph_height = graph_bottom - graph_top
 
         # Update background rectangle
         self.coords(self._bg_rect, graph_left, graph_top, graph_right, graph_bottom)
@@ -213,36 +283,11 @@ class GraphWidget(tk.Canvas):
             while idx < len(self._grid_lines):
                 self.itemconfigure(self._grid_lines[idx], state='hidden')
                 idx += 1
-
-        # Update secondary data
-        if self.show_secondary and len(self.data_secondary) > 1:
-            points = self._calculate_points(self.data_secondary, graph_left, graph_top, graph_width, graph_height)
-            self._update_data_series(points, graph_top + graph_height,
-                                    self._fill_polygon_secondary, self._data_line_secondary)
-            self.itemconfigure(self._fill_polygon_secondary, state='normal')
-            self.itemconfigure(self._data_line_secondary, state='normal')
         else:
-            self.itemconfigure(self._fill_polygon_secondary, state='hidden')
-            self.itemconfigure(self._data_line_secondary, state='hidden')
+            for line_id in self._grid_lines:
+                self.itemconfigure(line_id, state='hidden')
 
-        # Update primary data
-        if len(self.data_primary) > 1:
-            points = self._calculate_points(self.data_primary, graph_left, graph_top, graph_width, graph_height)
-            self._update_data_series(points, graph_top + graph_height,
-                                    self._fill_polygon, self._data_line)
-            self.itemconfigure(self._fill_polygon, state='normal')
-            self.itemconfigure(self._data_line, state='normal')
-        else:
-            self.itemconfigure(self._fill_polygon, state='hidden')
-            self.itemconfigure(self._data_line, state='hidden')
-
-        # Update value text
-        if len(self.data_primary) > 0:
-            current = self.data_primary[-1]
-            self.coords(self._value_text, graph_right - 5, graph_top + 5)
-            self.itemconfigure(self._value_text, text=f"{current:.1f}{self.label_y}")
-        else:
-            self.itemconfigure(self._value_text, text="")
+        self.coords(self._value_text, graph_right - 5, graph_top + 5)
 
         # Update labels
         if self.show_labels and self._label_items:
@@ -261,40 +306,71 @@ class GraphWidget(tk.Canvas):
             self.itemconfigure(self._label_items[3], text="0", anchor='nw')
 
             self.coords(self._label_items[4], graph_right, graph_bottom + 5)
-            self.itemconfigure(self._label_items[4], text="60s", anchor='ne')
-
-        self._dirty = False
-
-    def _calculate_points(self, data, left, top, width, height):
-        """Calculate graph points from data"""
-        points = []
-        max_points = Theme.GRAPH_HISTORY_SIZE
-
-        for i, value in enumerate(data):
-            x = left + (i / max_points) * width
-            clamped = max(0, min(self.max_value, value))
-            y = top + height - (clamped / self.max_value) * height
-            points.append((x, y))
-
-        return points
-
-    def _update_data_series(self, points, bottom_y, fill_item, line_item):
+            self.itemconfigure(self._label_items[4], text=self.range_label, anchor='ne')
+
+        self._layout_dirty = False
+
+    def _set_shown(self, item, shown):
+        """Show or hide a canvas item, skipping the Tk call if it is already so"""
+        if self._shown.get(item) != shown:
+            self._shown[item] = shown
+            self.itemconfigure(item, state='normal' if shown else 'hidden')
+
+    def _x_positions(self, left, width):
+        """x of every point index, and the pixel columns to decimate into (cached per width)"""
+        key = (left, width, self.max_points)
+        if key != self._xs_key:
+            self._xs_key = key
+            step = width / self.max_points
+            self._xs = [left + i * step for i in range(self.max_points)]
+            self._columns = None
+            if self.max_points > width:
+                # Group point indices by the pixel column they fall in
+                self._columns = []
+                first = 0
+                for i in range(1, self.max_points + 1):
+                    if i == self.max_points or int(self._xs[i]) != int(self._xs[first]):
+                        self._columns.append((first, i, self._xs[first]))
+                        first = i
+        return self._xs, self._columns
+
+    def _calculate_points(self, data, left, bottom, width, height):
+        """Flat [x0, y0, x1, y1, ...] for a series, at most two points per pixel column"""
+        top_value = self.max_value
+        scale = height / top_value
+        ys = [bottom - min(max(value, 0), top_value) * scale for value in data]
+        xs, columns = self._x_positions(left, width)
+
+        if columns is None:
+            flat = [0.0] * (2 * len(ys))
+            flat[0::2] = xs[:len(ys)]
+            flat[1::2] = ys
+            return flat
+
+        # More points than pixels: keep each column's extremes, in the order they occurred
+        flat = []
+        count = len(ys)
+        for first, end, x in columns:
+            if first >= count:
+                break
+            column = ys[first:end]
+            if len(column) == 1:
+                flat += (x, column[0])
+                continue
+            high, low = min(column), max(column)   # y grows downwards
+            if column.index(high) < column.index(low):
+                flat += (x, high, x, low)
+            else:
+                flat += (x, low, x, high)
+        return flat
+
+    def _update_data_series(self, data, left, bottom, width, height, fill_item, line_item):
         """Update a data series polygon and line"""
-        if len(points) < 2:
+        line = self._calculate_points(data, left, bottom, width, height)
+        if len(line) < 4:
             return
-
-        # Build fill polygon points
-        fill_points = [(points[0][0], bottom_y)]
-        fill_points.extend(points)
-        fill_points.append((points[-1][0], bottom_y))
-        flat_fill = [coord for point in fill_points for coord in point]
-
-        # Update polygon
-        self.coords(fill_item, *flat_fill)
-
-        # Update line
-        flat_line = [coord for point in points for coord in point]
-        self.coords(line_item, *flat_line)
+        self.coords(fill_item, [line[0], bottom] + line + [line[-2], bottom])
+        self.coords(line_item, line)
 
     # Legacy method for compatibility
     def redraw(self):
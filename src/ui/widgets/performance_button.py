@@ -6,6 +6,10 @@ Uses canvas item reuse for better performance
 import tkinter as tk
 from collections import deque
 from ..themes import COLORS, Theme
+from .redraw_scheduler import RedrawScheduler
+
+# Points across the mini graph
+SPARKLINE_POINTS = 30
 
 
 class PerformanceButton(tk.Frame):
@@ -33,7 +37,7 @@ class PerformanceButton(tk.Frame):
         self.fill_color = fill_color or COLORS['graph_fill']
 
         # Data for mini graph
-        self.data = deque(maxlen=30)
+        self.data = deque(maxlen=SPARKLINE_POINTS)
         self.max_value = 100
 
         # Cache widgets for fast bg updates (avoid winfo_children traversal)
@@ -44,6 +48,9 @@ class PerformanceButton(tk.Frame):
         self._graph_line = None
         self._graph_initialized = False
         self._graph_dirty = True
+        self._graph_shown = False
+        self._graph_xs = []          # x of each point index, for _graph_xs_width
+        self._graph_xs_width = None
 
         # Cache fonts
         self._font_subheader_bold = Theme.get_font(Theme.FONT_SIZE_SUBHEADER, bold=True)
@@ -114,6 +121,7 @@ class PerformanceButton(tk.Frame):
             highlightthickness=0
         )
         self.graph_canvas.pack(side=tk.RIGHT, padx=(8, 0))
+        self.graph_canvas.bind('<Map>', lambda e: self._schedule_graph())
 
         # Cache all widgets that need bg changes (flat list for fast iteration)
         self._bg_widgets = [
@@ -183,8 +191,12 @@ class PerformanceButton(tk.Frame):
     def add_data_point(self, value):
         """Add a data point to the graph"""
         self.data.append(value)
+        self._schedule_graph()
+
+    def _schedule_graph(self):
+        """Mark the mini graph dirty and draw it at the next idle point (RedrawScheduler)"""
         self._graph_dirty = True
-        self._update_graph()
+        RedrawScheduler.schedule(self.graph_canvas, self._update_graph)
 
     def _init_graph_items(self):
         """Initialize graph canvas items once"""
@@ -197,6 +209,7 @@ class PerformanceButton(tk.Frame):
         self._graph_line = self.graph_canvas.create_line(
             0, 0, 0, 0, fill=self.line_color, width=2, smooth=True
         )
+        self._graph_shown = True
         self._graph_initialized = True
 
     def _update_graph(self):
@@ -215,36 +228,35 @@ class PerformanceButton(tk.Frame):
 
         if len(self.data) < 2:
             # Hide items when not enough data
-            self.graph_canvas.itemconfigure(self._graph_fill, state='hidden')
-            self.graph_canvas.itemconfigure(self._graph_line, state='hidden')
+            self._set_graph_shown(False)
             self._graph_dirty = False
             return
 
         margin = 4
         graph_w = w - margin * 2
         graph_h = h - margin * 2
+        bottom = margin + graph_h
+
+        # x positions only change with the width
+        if self._graph_xs_width != graph_w:
+            self._graph_xs_width = graph_w
+            self._graph_xs = [margin + (i / SPARKLINE_POINTS) * graph_w for i in range(SPARKLINE_POINTS)]
 
-        # Build points
-        points = []
-        for i, value in enumerate(self.data):
-            x = margin + (i / 30) * graph_w
-            clamped = max(0, min(self.max_value, value))
-            y = margin + graph_h - (clamped / self.max_value) * graph_h
-            points.append((x, y))
-
-        # Build fill polygon
-        fill_points = [(points[0][0], margin + graph_h)]
-        fill_points.extend(points)
-        fill_points.append((points[-1][0], margin + graph_h))
-        flat_fill = [c for p in fill_points for c in p]
-
-        # Update polygon coords
-        self.graph_canvas.coords(self._graph_fill, *flat_fill)
-        self.graph_canvas.itemconfigure(self._graph_fill, state='normal')
-
-        # Update line coords
-        line_flat = [c for p in points for c in p]
-        self.graph_canvas.coords(self._graph_line, *line_flat)
-        self.graph_canvas.itemconfigure(self._graph_line, state='normal')
+        scale = graph_h / self.max_value
+        line = [0.0] * (2 * len(self.data))
+        line[0::2] = self._graph_xs[:len(self.data)]
+        line[1::2] = [bottom - min(max(value, 0), self.max_value) * scale for value in self.data]
+
+        self.graph_canvas.coords(self._graph_fill, [line[0], bottom] + line + [line[-2], bottom])
+        self.graph_canvas.coords(self._graph_line, line)
+        self._set_graph_shown(True)
 
         self._graph_dirty = False
+
+    def _set_graph_shown(self, shown):
+        """Show or hide the graph items, skipping the Tk calls if they already are"""
+        if shown != self._graph_shown:
+            self._graph_shown = shown
+            state = 'normal' if shown else 'hidden'
+            self.graph_canvas.itemconfigure(self._graph_fill, state=state)
+            self.graph_canvas.itemconfigure(self._graph_line, state=state)
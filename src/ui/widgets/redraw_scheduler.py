@@ -0,0 +1,40 @@
+"""
+RedrawScheduler - Batches graph redraws into one idle callback
+Widgets mark themselves dirty as data arrives; drawing happens once per Tk frame
+"""
+
+import tkinter as tk
+
+
+class RedrawScheduler:
+    """
+    Collects redraw callbacks and runs them together from a single
+    after_idle(), so a frame that updates fifty graphs costs one pass
+    instead of fifty interleaved ones.
+
+    Widgets that are not mapped (hidden panel, tab in the background) are
+    skipped and stay dirty; they call schedule() again from <Map>.
+    """
+
+    _pending = {}        # redraw callback -> widget it draws on
+    _scheduled = False
+
+    @classmethod
+    def schedule(cls, widget, redraw):
+        """Run redraw() at the next idle point if widget is on screen then"""
+        cls._pending[redraw] = widget
+        if not cls._scheduled:
+            cls._scheduled = True
+            widget.after_idle(cls._flush)
+
+    @classmethod
+    def _flush(cls):
+        pending = cls._pending
+        cls._pending = {}
+        cls._scheduled = False
+        for redraw, widget in pending.items():
+            try:
+                if widget.winfo_ismapped():
+                    redraw()
+            except tk.TclError:
+                pass  # destroyed since it was scheduled